@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <cmath>
+
+#include "benchmark/benchmark.h"
+
+#include "core.hpp"
+#include "math.hpp"
+
+namespace zlab::benchmarks{
+
+// BENCHMARK MATRIX
+// This function returns a deterministic, well-conditioned dense test matrix.
+inline ZMatrix benchmark_matrix(positiveIntegerType numberOfRows, positiveIntegerType numberOfColumns){
+    ZMatrix A(numberOfRows, numberOfColumns);
+    for(positiveIntegerType i=0; i < numberOfRows; ++i){
+        for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+            A(i,j) = std::cos(0.37 * i * i + 1.3 * i * j + j) + (i == j ? 2 : 0);
+        }
+    }
+    return A;
+}
+
+// BENCHMARK VECTOR
+// This function returns a deterministic test vector.
+inline ZVector benchmark_vector(positiveIntegerType size){
+    ZVector v(size);
+    for(positiveIntegerType i=0; i < size; ++i){
+        v[i] = std::sin(0.7 * i + 0.1);
+    }
+    return v;
+}
+
+// SIZES AND THREADS
+// This function registers every (size, threads) pair for a benchmark, with the
+// thread counts doubling up to the number of hardware cores.
+inline void sizes_and_threads(benchmark::internal::Benchmark* b, std::initializer_list<int64_t> sizes){
+    auto numberOfCores = std::max<int64_t>(std::thread::hardware_concurrency(), 1);
+    for(auto size : sizes){
+        for(int64_t threads=1; ; threads *= 2){
+            threads = std::min(threads, numberOfCores);
+            b->Args({size, threads});
+            if (threads == numberOfCores) break;
+        }
+    }
+    b->ArgNames({"n", "threads"});
+}
+
+// SET RATES
+// This function reports the floating point and memory throughput of a benchmark
+// given the work of a single iteration. Google Benchmark prints the FLOP/s
+// counter with SI prefixes (e.g. 12.3G/s) and stores it unscaled in the JSON output.
+inline void set_rates(benchmark::State& state, double flopsPerIteration, double bytesPerIteration){
+    auto iterations = static_cast<double>(state.iterations());
+    state.counters["FLOP/s"] = benchmark::Counter(flopsPerIteration * iterations, benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(bytesPerIteration * iterations));
+}
+
+} // end namespace zlab::benchmarks
@@ -0,0 +1,255 @@
+
+#include "benchmark_utilities.hpp"
+
+namespace {
+
+using namespace zlab;
+using namespace zlab::benchmarks;
+
+constexpr double bytesPerScalar = sizeof(scalarType);
+
+void BM_gemm(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    ThreadScope threads(state.range(1));
+    auto A = benchmark_matrix(n, n);
+    auto B = benchmark_matrix(n, n);
+    ZMatrix C(n, n);
+    for(auto _ : state){
+        gemm(A, B, C, 1, 0);
+        benchmark::DoNotOptimize(C(0,0));
+    }
+    set_rates(state, 2.0 * n * n * n, 4.0 * n * n * bytesPerScalar);
+}
+BENCHMARK(BM_gemm)->Apply([](auto* b){ sizes_and_threads(b, {64, 128, 256, 512}); })->UseRealTime();
+
+void BM_gemv(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto isTranspose = state.range(1) != 0;
+    auto A = benchmark_matrix(n, n);
+    auto x = benchmark_vector(n);
+    ZVector y(n);
+    for(auto _ : state){
+        gemv(A, x, y, 1, 0, isTranspose);
+        benchmark::DoNotOptimize(y[0]);
+    }
+    set_rates(state, 2.0 * n * n, (n * n + 2.0 * n) * bytesPerScalar);
+}
+BENCHMARK(BM_gemv)->ArgsProduct({{128, 512, 2048}, {0, 1}})->ArgNames({"n", "transpose"});
+
+void BM_trsm(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto numberOfColumns = static_cast<positiveIntegerType>(state.range(1));
+    ThreadScope threads(state.range(2));
+    auto A = benchmark_matrix(n, n);
+    for(positiveIntegerType i=0; i < n; ++i){
+        A(i,i) += n;
+    }
+    auto B = benchmark_matrix(n, numberOfColumns);
+    ZMatrix X(n, numberOfColumns);
+    for(auto _ : state){
+        forward_substitution(A, B, X);
+        benchmark::DoNotOptimize(X(0,0));
+    }
+    set_rates(state, 1.0 * n * n * numberOfColumns, (0.5 * n * n + 2.0 * n * numberOfColumns) * bytesPerScalar);
+}
+BENCHMARK(BM_trsm)->ArgsProduct({{256, 1024}, {1, 64, 512}, {1, 4}})->ArgNames({"n", "rhs", "threads"})->UseRealTime();
+
+void BM_axpy(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto x = benchmark_vector(n);
+    auto y = benchmark_vector(n);
+    for(auto _ : state){
+        axpy(1e-3, x, y);
+        benchmark::DoNotOptimize(y[0]);
+    }
+    set_rates(state, 2.0 * n, 3.0 * n * bytesPerScalar);
+}
+BENCHMARK(BM_axpy)->RangeMultiplier(8)->Range(1 << 10, 1 << 22)->ArgName("n");
+
+void BM_dot(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto x = benchmark_vector(n);
+    auto y = benchmark_vector(n);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(dot(x, y));
+    }
+    set_rates(state, 2.0 * n, 2.0 * n * bytesPerScalar);
+}
+BENCHMARK(BM_dot)->RangeMultiplier(8)->Range(1 << 10, 1 << 22)->ArgName("n");
+
+void BM_scale(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto x = benchmark_vector(n);
+    for(auto _ : state){
+        scale(x, 1.0000001);
+        benchmark::DoNotOptimize(x[0]);
+    }
+    set_rates(state, 1.0 * n, 2.0 * n * bytesPerScalar);
+}
+BENCHMARK(BM_scale)->RangeMultiplier(8)->Range(1 << 10, 1 << 22)->ArgName("n");
+
+void BM_norm2(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto x = benchmark_vector(n);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(norm(x));
+    }
+    set_rates(state, 2.0 * n, 1.0 * n * bytesPerScalar);
+}
+BENCHMARK(BM_norm2)->RangeMultiplier(8)->Range(1 << 10, 1 << 22)->ArgName("n");
+
+void BM_norm(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    // A half-integer order exercises the std::pow path.
+    auto p = state.range(1) / scalarType{2};
+    auto x = benchmark_vector(n);
+    for(auto _ : state){
+        benchmark::DoNotOptimize(norm(x, p));
+    }
+    set_rates(state, 2.0 * n, 1.0 * n * bytesPerScalar);
+}
+BENCHMARK(BM_norm)->ArgsProduct({{1 << 16, 1 << 20}, {2, 6, 7}})->ArgNames({"n", "twice_p"});
+
+void BM_modified_gram_schmidt(benchmark::State& state){
+    auto m = static_cast<positiveIntegerType>(state.range(0));
+    auto n = m / 2;
+    auto A = benchmark_matrix(m, n);
+    for(auto _ : state){
+        auto [Q, R] = modified_gram_schmidt(A);
+        benchmark::DoNotOptimize(R(0,0));
+    }
+    set_rates(state, 2.0 * m * n * n, 3.0 * m * n * bytesPerScalar);
+}
+BENCHMARK(BM_modified_gram_schmidt)->RangeMultiplier(2)->Range(64, 512)->ArgName("m");
+
+void BM_block_gram_schmidt(benchmark::State& state){
+    auto m = static_cast<positiveIntegerType>(state.range(0));
+    auto n = m / 2;
+    ThreadScope threads(state.range(1));
+    auto A = benchmark_matrix(m, n);
+    for(auto _ : state){
+        auto [Q, R] = block_gram_schmidt(A);
+        benchmark::DoNotOptimize(R(0,0));
+    }
+    set_rates(state, 4.0 * m * n * n, 4.0 * m * n * bytesPerScalar);
+}
+BENCHMARK(BM_block_gram_schmidt)->Apply([](auto* b){ sizes_and_threads(b, {128, 256, 512}); })->UseRealTime();
+
+void BM_linear_least_squares(benchmark::State& state){
+    auto m = static_cast<positiveIntegerType>(state.range(0));
+    auto n = m / 2;
+    auto numberOfRightHandSides = n;
+    ThreadScope threads(state.range(1));
+    auto A = benchmark_matrix(m, n);
+    auto B = benchmark_matrix(m, numberOfRightHandSides);
+    ZMatrix X(n, numberOfRightHandSides);
+    for(auto _ : state){
+        linear_least_squares(A, B, X);
+        benchmark::DoNotOptimize(X(0,0));
+    }
+    // Householder QR of [A B] and one triangular solve per right-hand side.
+    auto flops = 2.0 * m * n * (n + numberOfRightHandSides) - 2.0 * n * n * n / 3 + 1.0 * n * n * numberOfRightHandSides;
+    set_rates(state, flops, (2.0 * m * (n + numberOfRightHandSides) + n * numberOfRightHandSides) * bytesPerScalar);
+}
+BENCHMARK(BM_linear_least_squares)->Apply([](auto* b){ sizes_and_threads(b, {64, 128, 256}); })->UseRealTime();
+
+void BM_qr_sliding_window(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto windowSize = 4 * n;
+    auto A = benchmark_matrix(windowSize, n);
+    auto b = benchmark_vector(windowSize);
+    QRFactorization qr(A, b);
+    ZVector row(n), x(n);
+    positiveIntegerType slot = 0;
+    for(auto _ : state){
+        // The oldest row is removed and re-entered, one window step per iteration.
+        for(positiveIntegerType j=0; j < n; ++j){
+            row[j] = A(slot,j);
+        }
+        qr.remove_row(row, b[slot]);
+        qr.insert_row(row, b[slot]);
+        qr.solve(x);
+        benchmark::DoNotOptimize(x[0]);
+        slot = (slot + 1) % windowSize;
+    }
+    set_rates(state, 7.0 * n * n, 3.0 * n * n * bytesPerScalar);
+}
+BENCHMARK(BM_qr_sliding_window)->RangeMultiplier(4)->Range(16, 256)->ArgName("n");
+
+void BM_ridge_regression(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto numberOfLambdas = static_cast<positiveIntegerType>(state.range(1));
+    auto m = 2 * n;
+    auto A = benchmark_matrix(m, n);
+    auto b = benchmark_vector(m);
+    ZVector lambdas(numberOfLambdas);
+    for(positiveIntegerType l=0; l < numberOfLambdas; ++l){
+        lambdas[l] = std::pow(10.0, -6.0 + 8.0 * l / numberOfLambdas);
+    }
+    for(auto _ : state){
+        auto path = ridge_regression(A, b, lambdas);
+        benchmark::DoNotOptimize(path.X(0,0));
+    }
+    // One thin SVD, then one n x n matrix-vector product per lambda.
+    set_rates(state, 14.0 * m * n * n + 8.0 * n * n * n + 2.0 * numberOfLambdas * n * n,
+        (2.0 * m * n + (2.0 + numberOfLambdas) * n * n) * bytesPerScalar);
+}
+BENCHMARK(BM_ridge_regression)->ArgsProduct({{64, 128, 256}, {1, 100}})->ArgNames({"n", "lambdas"});
+
+void BM_levenberg_marquardt(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto isFiniteDifference = state.range(1) != 0;
+    auto m = 2 * n;
+    auto A = benchmark_matrix(m, n);
+    auto b = benchmark_vector(m);
+    // Mildly nonlinear residual r(x) = A * x + x^3 / 10 - b (cubes on the first n rows).
+    auto residual = [&](const ZVector& x, ZVector& r){
+        gemv(A, x, r, 1, 0, false);
+        for(positiveIntegerType i=0; i < m; ++i){
+            r[i] -= b[i];
+        }
+        for(positiveIntegerType j=0; j < n; ++j){
+            r[j] += x[j] * x[j] * x[j] / 10;
+        }
+    };
+    auto jacobian = [&](const ZVector& x, ZMatrix& J){
+        J = A;
+        for(positiveIntegerType j=0; j < n; ++j){
+            J(j,j) += 3 * x[j] * x[j] / 10;
+        }
+    };
+    FiniteDifferenceJacobian finiteDifferenceJacobian(residual);
+    ZVector x(n);
+    positiveIntegerType numberOfIterations = 0;
+    for(auto _ : state){
+        x.fill(0);
+        auto result = isFiniteDifference ? levenberg_marquardt(residual, finiteDifferenceJacobian, m, x)
+                                         : levenberg_marquardt(residual, jacobian, m, x);
+        numberOfIterations = result.numberOfIterations;
+        benchmark::DoNotOptimize(x[0]);
+    }
+    // Per iteration: the QR of [J r] and one damped re-triangularization, plus n
+    // residual evaluations for a finite-difference Jacobian.
+    auto flopsPerIteration = 2.0 * m * n * n + 4.0 * n * n * n / 3 + (isFiniteDifference ? 2.0 * m * n * n : 0.0);
+    set_rates(state, numberOfIterations * flopsPerIteration, numberOfIterations * 2.0 * m * n * bytesPerScalar);
+}
+BENCHMARK(BM_levenberg_marquardt)->ArgsProduct({{32, 64}, {0, 1}})->ArgNames({"n", "finite_difference"});
+
+void BM_linear_solver(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto method = state.range(1) != 0 ? LinearSolverMethod::MixedPrecisionLU : LinearSolverMethod::LU;
+    auto A = benchmark_matrix(n, n);
+    for(positiveIntegerType i=0; i < n; ++i){
+        A(i,i) += n;
+    }
+    auto b = benchmark_vector(n);
+    ZVector x(n);
+    for(auto _ : state){
+        linear_solver(A, b, x, std::nullopt, method);
+        benchmark::DoNotOptimize(x[0]);
+    }
+    set_rates(state, 2.0 * n * n * n / 3, 2.0 * n * n * bytesPerScalar);
+}
+BENCHMARK(BM_linear_solver)->ArgsProduct({{128, 256, 512}, {0, 1}})->ArgNames({"n", "mixed_precision"});
+
+} // end anonymous namespace
@@ -0,0 +1,232 @@
+
+#include "benchmark_utilities.hpp"
+
+namespace {
+
+using namespace zlab;
+using namespace zlab::benchmarks;
+
+constexpr double bytesPerScalar = sizeof(scalarType);
+constexpr integerType numberOfTimeSteps = 100;
+
+// Method of lines for the 1D heat equation with a three-point stencil.
+struct HeatEquation{
+    scalarType diffusivity;
+    void operator()(scalarType, const ZVector& y, ZVector& f) const {
+        auto n = y.size();
+        for(positiveIntegerType i=0; i < n; ++i){
+            auto left = i > 0 ? y[i-1] : 0;
+            auto right = i + 1 < n ? y[i+1] : 0;
+            f[i] = diffusivity * (left - 2 * y[i] + right);
+        }
+    }
+};
+
+template <const auto& butcherTableau>
+void BM_runge_kutta_solve(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    constexpr auto numberOfStages = std::remove_cvref_t<decltype(butcherTableau)>::numberOfStages;
+    auto y0 = benchmark_vector(n);
+    auto timeStep = 0.1 / numberOfTimeSteps;
+    HeatEquation rhs{1};
+    RKSolver<numberOfStages, HeatEquation> solver(rhs, y0, timeStep, numberOfTimeSteps, butcherTableau);
+    for(auto _ : state){
+        auto y = solver.solve();
+        benchmark::DoNotOptimize(y[0]);
+    }
+    // Per stage: the stage-state copy, one AXPY per coefficient the solver keeps,
+    // the right-hand side (5 flops per entry), the stage copy and the update AXPY.
+    auto safeZero = evaluate_safe_tolerance();
+    double flopsPerStep{0}, bytesPerStep{0};
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        for(positiveIntegerType j=0; j < numberOfStages; ++j){
+            if (std::abs(butcherTableau.A[s][j]) > safeZero) {
+                flopsPerStep += 2.0 * n;
+                bytesPerStep += 3.0 * n * bytesPerScalar;
+            }
+        }
+        flopsPerStep += 5.0 * n + 2.0 * n;
+        bytesPerStep += (2.0 + 2.0 + 2.0 + 3.0) * n * bytesPerScalar;
+    }
+    set_rates(state, flopsPerStep * numberOfTimeSteps, bytesPerStep * numberOfTimeSteps);
+}
+
+#define ZLAB_RUNGE_KUTTA_BENCHMARK(tableau) \
+    BENCHMARK(BM_runge_kutta_solve<tableau>)->Name("BM_runge_kutta_solve/" #tableau)->RangeMultiplier(8)->Range(1 << 6, 1 << 15)->ArgName("n")
+
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauExplicitEuler);
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauMidpointMethod);
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauHeunsMethod2);
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauRalstonsMethod2);
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauHeunsMethod3);
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauRalstonsMethod3);
+ZLAB_RUNGE_KUTTA_BENCHMARK(StrongStabilityPreservingRungeKutta3);
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauClassicalRungeKutta4);
+ZLAB_RUNGE_KUTTA_BENCHMARK(ButcherTableauKnothWolke3);
+
+template <const auto& lowStorageTableau>
+void BM_low_storage_runge_kutta_solve(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    using tableauType = std::remove_cvref_t<decltype(lowStorageTableau)>;
+    auto y0 = benchmark_vector(n);
+    ZVector y(n);
+    auto timeStep = 0.1 / numberOfTimeSteps;
+    HeatEquation rhs{1};
+    LSRKSolver<tableauType, HeatEquation> solver(rhs, timeStep, numberOfTimeSteps, lowStorageTableau);
+    for(auto _ : state){
+        y = y0;
+        solver.solve(y);
+        benchmark::DoNotOptimize(y[0]);
+    }
+    // Per stage: the right-hand side (5 flops per entry) and one fused pass, which
+    // reads and writes both registers and reads F (2N), or reads three and writes
+    // one (2S), plus the 2S copy of y_n once per step.
+    constexpr auto numberOfStages = tableauType::numberOfStages;
+    constexpr bool isWilliamsonForm = std::is_same_v<tableauType, LowStorageTableau2N<numberOfStages>>;
+    double flopsPerStep = numberOfStages * (5.0 + (isWilliamsonForm ? 4.0 : 5.0)) * n;
+    double bytesPerStep = (numberOfStages * (2.0 + (isWilliamsonForm ? 5.0 : 4.0)) + (isWilliamsonForm ? 0.0 : 2.0)) * n * bytesPerScalar;
+    set_rates(state, flopsPerStep * numberOfTimeSteps, bytesPerStep * numberOfTimeSteps);
+}
+
+#define ZLAB_LOW_STORAGE_RUNGE_KUTTA_BENCHMARK(tableau) \
+    BENCHMARK(BM_low_storage_runge_kutta_solve<tableau>)->Name("BM_low_storage_runge_kutta_solve/" #tableau)->RangeMultiplier(8)->Range(1 << 6, 1 << 15)->ArgName("n")
+
+ZLAB_LOW_STORAGE_RUNGE_KUTTA_BENCHMARK(LowStorageTableauWilliamson3);
+ZLAB_LOW_STORAGE_RUNGE_KUTTA_BENCHMARK(LowStorageTableauCarpenterKennedy4);
+ZLAB_LOW_STORAGE_RUNGE_KUTTA_BENCHMARK(LowStorageTableauSSPRK3);
+ZLAB_LOW_STORAGE_RUNGE_KUTTA_BENCHMARK(LowStorageTableauSSPRK52);
+
+// Reaction-diffusion with the stiff diffusion implicit and a logistic reaction
+// explicit. The step is 1e4 times the explicit stability limit of the diffusion.
+template <const auto& additiveTableau>
+void BM_additive_runge_kutta_solve(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    constexpr auto numberOfStages = std::remove_cvref_t<decltype(additiveTableau)>::numberOfStages;
+    auto y0 = benchmark_vector(n);
+    HeatEquation diffusion{1e4};
+    auto reaction = [](scalarType, const ZVector& y, ZVector& f){
+        for(positiveIntegerType i=0; i < y.size(); ++i){
+            f[i] = y[i] * (1 - y[i]);
+        }
+    };
+    auto jacobian = [&diffusion](scalarType, const ZVector&, ZMatrix& J){
+        auto size = J.get_number_of_rows();
+        J.fill(0);
+        for(positiveIntegerType i=0; i < size; ++i){
+            J(i,i) = -2 * diffusion.diffusivity;
+            if (i > 0) J(i,i-1) = diffusion.diffusivity;
+            if (i + 1 < size) J(i,i+1) = diffusion.diffusivity;
+        }
+    };
+    ARKSolver<numberOfStages, decltype(reaction), HeatEquation, decltype(jacobian)> solver(
+        reaction, diffusion, jacobian, y0, 0.1 / numberOfTimeSteps, numberOfTimeSteps, additiveTableau);
+    for(auto _ : state){
+        auto y = solver.solve();
+        benchmark::DoNotOptimize(y[0]);
+    }
+    // One LU per solve, then per implicit stage about two Newton iterations of an
+    // LU solve (2 n^2) and an implicit evaluation (5 n).
+    set_rates(state, 2.0 * n * n * n / 3 + numberOfTimeSteps * numberOfStages * 2.0 * (2.0 * n * n + 5.0 * n),
+        numberOfTimeSteps * numberOfStages * 2.0 * n * n * bytesPerScalar);
+}
+BENCHMARK(BM_additive_runge_kutta_solve<ARK324L2SA>)->Name("BM_additive_runge_kutta_solve/ARK324L2SA")->RangeMultiplier(4)->Range(16, 64)->ArgName("n");
+BENCHMARK(BM_additive_runge_kutta_solve<ARK436L2SA>)->Name("BM_additive_runge_kutta_solve/ARK436L2SA")->RangeMultiplier(4)->Range(16, 64)->ArgName("n");
+
+// A slow heat equation on the first n - 2 entries forcing a fast oscillator on the
+// last two, integrated either with 16 fast substeps per slow step (multirate:1,
+// with the one slow entry the oscillator reads as coupled component) or single
+// rate at the fast step (multirate:0).
+void BM_multirate_runge_kutta_solve(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto isMultirate = state.range(1) != 0;
+    constexpr positiveIntegerType numberOfSubsteps = 16;
+    auto y0 = benchmark_vector(n);
+    auto slowPart = [n](scalarType, const ZVector& y, ZVector& f){
+        for(positiveIntegerType i=0; i + 2 < n; ++i){
+            auto left = i > 0 ? y[i-1] : 0;
+            auto right = i + 3 < n ? y[i+1] : y[n-2];
+            f[i] = left - 2 * y[i] + right;
+        }
+    };
+    auto fastPart = [n](scalarType, const ZVector& y, ZVector& f){
+        f[n-2] = 100 * y[n-1];
+        f[n-1] = -100 * y[n-2] + y[n-3];
+    };
+    auto wholePart = [&](scalarType t, const ZVector& y, ZVector& f){
+        slowPart(t, y, f);
+        fastPart(t, y, f);
+    };
+    auto timeStep = 0.1 / numberOfTimeSteps;
+    MRKSolver<ClassicalRK4.numberOfStages, ClassicalRK4.numberOfStages, decltype(slowPart), decltype(fastPart)> multirate(
+        slowPart, fastPart, {n - 2, n - 1}, y0, timeStep, numberOfTimeSteps, numberOfSubsteps, ClassicalRK4, ClassicalRK4, 0,
+        std::vector<positiveIntegerType>{n - 3});
+    RKSolver<ClassicalRK4.numberOfStages, decltype(wholePart)> singleRate(
+        wholePart, y0, timeStep / numberOfSubsteps, numberOfTimeSteps * numberOfSubsteps, ClassicalRK4);
+    for(auto _ : state){
+        auto y = isMultirate ? multirate.solve() : singleRate.solve();
+        benchmark::DoNotOptimize(y[0]);
+    }
+}
+BENCHMARK(BM_multirate_runge_kutta_solve)->ArgsProduct({{1 << 8, 1 << 10}, {0, 1}})->ArgNames({"n", "multirate"});
+
+// Gradient of the heat equation's final energy with respect to the initial state
+// and the diffusivity, with the checkpoint budget as second argument. A budget of
+// numberOfTimeSteps stores the whole trajectory; smaller budgets trade memory for
+// the recomputed steps reported in the forward_steps counter.
+void BM_adjoint_runge_kutta_gradient(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto numberOfCheckpoints = static_cast<integerType>(state.range(1));
+    auto y0 = benchmark_vector(n);
+    HeatEquation rhs{1};
+    auto vectorJacobianProduct = [&rhs](scalarType, const ZVector& y, const ZVector& w, ZVector& wy, ZVector& wp){
+        rhs(0, w, wy);
+        wp[0] = 0;
+        for(positiveIntegerType i=0; i < y.size(); ++i){
+            wp[0] += w[i] * wy[i];
+        }
+        wp[0] /= rhs.diffusivity;
+    };
+    AdjointRKSolver<ClassicalRK4.numberOfStages, HeatEquation, decltype(vectorJacobianProduct)> solver(
+        rhs, vectorJacobianProduct, y0, 0.1 / numberOfTimeSteps, numberOfTimeSteps, ClassicalRK4, 1, numberOfCheckpoints);
+    positiveIntegerType numberOfForwardSteps = 0;
+    for(auto _ : state){
+        auto result = solver.gradient([](const ZVector& y, ZVector& lambda){ lambda = y; });
+        numberOfForwardSteps = result.numberOfForwardSteps;
+        benchmark::DoNotOptimize(result.stateGradient[0]);
+    }
+    state.counters["forward_steps"] = numberOfForwardSteps;
+}
+BENCHMARK(BM_adjoint_runge_kutta_gradient)->ArgsProduct({{1 << 8, 1 << 10}, {4, 8, numberOfTimeSteps}})->ArgNames({"n", "checkpoints"});
+
+// Parareal on a slowly diffusing heat equation: one explicit Euler step per slice
+// as the coarse propagator and ClassicalRK4 as the fine one, against the same fine
+// integration run sequentially (threads:0).
+void BM_parareal(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    auto numberOfThreads = state.range(1);
+    ThreadScope threads(std::max<int64_t>(numberOfThreads, 1));
+    constexpr positiveIntegerType numberOfSlices = 32, fineStepsPerSlice = 50;
+    scalarType finalTime = 10;
+    auto y0 = benchmark_vector(n);
+    HeatEquation rhs{1e-3};
+    positiveIntegerType numberOfIterations = 0;
+    for(auto _ : state){
+        if (numberOfThreads == 0) {
+            RKSolver<ClassicalRK4.numberOfStages, HeatEquation> solver(rhs, y0,
+                finalTime / (numberOfSlices * fineStepsPerSlice), numberOfSlices * fineStepsPerSlice, ClassicalRK4);
+            auto y = solver.solve();
+            benchmark::DoNotOptimize(y[0]);
+        } else {
+            auto solution = parareal(rhs, y0, finalTime, numberOfSlices, ExplicitEuler, 1, ClassicalRK4, fineStepsPerSlice);
+            numberOfIterations = solution.numberOfIterations;
+            benchmark::DoNotOptimize(solution.states[numberOfSlices][0]);
+        }
+    }
+    state.counters["iterations"] = numberOfIterations;
+}
+BENCHMARK(BM_parareal)->Apply([](auto* b){
+    sizes_and_threads(b, {16, 256});
+    b->Args({16, 0})->Args({256, 0});
+})->UseRealTime();
+
+} // end anonymous namespace
@@ -0,0 +1,36 @@
+
+#include "benchmark_utilities.hpp"
+
+namespace {
+
+using namespace zlab;
+using namespace zlab::benchmarks;
+
+constexpr double bytesPerScalar = sizeof(scalarType);
+
+// Evaluates the basis function at n distances spread over [0, 1.2 R], so that
+// both the compact support and the zero branch are exercised.
+template <typename rbfType>
+void BM_rbf_evaluate(benchmark::State& state){
+    auto n = static_cast<positiveIntegerType>(state.range(0));
+    scalarType radius{1};
+    rbfType rbf(radius);
+    const AbstractRBF& basis = rbf;
+    ZVector distances(n), values(n);
+    for(positiveIntegerType i=0; i < n; ++i){
+        distances[i] = 1.2 * radius * i / n;
+    }
+    for(auto _ : state){
+        for(positiveIntegerType i=0; i < n; ++i){
+            values[i] = basis.evaluate(distances[i]);
+        }
+        benchmark::DoNotOptimize(values[0]);
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 2.0 * n * bytesPerScalar));
+}
+BENCHMARK(BM_rbf_evaluate<Bump>)->RangeMultiplier(8)->Range(1 << 10, 1 << 19)->ArgName("n");
+BENCHMARK(BM_rbf_evaluate<WendlandC0>)->RangeMultiplier(8)->Range(1 << 10, 1 << 19)->ArgName("n");
+BENCHMARK(BM_rbf_evaluate<WendlandC2>)->RangeMultiplier(8)->Range(1 << 10, 1 << 19)->ArgName("n");
+
+} // end anonymous namespace
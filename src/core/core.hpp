@@ -2,3 +2,7 @@
 #pragma once
 
 #include "numeric_types.hpp"
+#include "thread_pool.hpp"
+#include "reduction.hpp"
+#include "memory_resource.hpp"
+#include "instrumentation.hpp"
@@ -0,0 +1,157 @@
+
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <memory>
+#include <vector>
+#include <mutex>
+
+#include "instrumentation.hpp"
+
+namespace zlab::instrumentation{
+
+namespace {
+    struct TraceEvent{
+        const char* name;
+        clockType::time_point start;
+        clockType::time_point end;
+    };
+
+    // Every thread owns one aggregate. The mutex is only contended while
+    // collect, reset or write_chrome_trace read it from another thread.
+    struct ThreadAggregate{
+        std::uint64_t threadIdentifier;
+        std::mutex mutex;
+        std::map<const char*, RegionStatistics> regions;
+        std::vector<TraceEvent> events;
+    };
+
+    // Trace buffers stop growing past this many events per thread.
+    constexpr std::size_t maximumNumberOfEventsPerThread = 1 << 20;
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<ThreadAggregate>> registry;
+    std::atomic<bool> isTracing{false};
+    const auto processStart = clockType::now();
+
+    ThreadAggregate& thread_aggregate(){
+        thread_local std::shared_ptr<ThreadAggregate> aggregate = []{
+            auto created = std::make_shared<ThreadAggregate>();
+            std::lock_guard<std::mutex> lock(registryMutex);
+            created->threadIdentifier = registry.size();
+            registry.push_back(created);
+            return created;
+        }();
+        return *aggregate;
+    }
+
+    std::vector<std::shared_ptr<ThreadAggregate>> registered_aggregates(){
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return registry;
+    }
+
+    void write_json_string(std::ostream& out, const std::string& text){
+        out << '"';
+        for(auto character : text){
+            if (character == '"' || character == '\\') out << '\\';
+            out << character;
+        }
+        out << '"';
+    }
+}
+
+void record_region(const char* name, double flops, double bytes, clockType::time_point start, clockType::time_point end){
+    auto& aggregate = thread_aggregate();
+    std::lock_guard<std::mutex> lock(aggregate.mutex);
+    auto& statistics = aggregate.regions[name];
+    statistics.calls += 1;
+    statistics.nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    statistics.flops += flops;
+    statistics.bytes += bytes;
+    if (isTracing.load(std::memory_order_relaxed) && aggregate.events.size() < maximumNumberOfEventsPerThread) {
+        aggregate.events.push_back({name, start, end});
+    }
+}
+
+std::map<std::string, RegionStatistics> collect(){
+    std::map<std::string, RegionStatistics> merged;
+    for(auto& aggregate : registered_aggregates()){
+        std::lock_guard<std::mutex> lock(aggregate->mutex);
+        for(auto& [name, statistics] : aggregate->regions){
+            auto& total = merged[name];
+            total.calls += statistics.calls;
+            total.nanoseconds += statistics.nanoseconds;
+            total.flops += statistics.flops;
+            total.bytes += statistics.bytes;
+        }
+    }
+    return merged;
+}
+
+void reset(){
+    for(auto& aggregate : registered_aggregates()){
+        std::lock_guard<std::mutex> lock(aggregate->mutex);
+        aggregate->regions.clear();
+        aggregate->events.clear();
+    }
+}
+
+void enable_tracing(bool isEnabled){
+    isTracing.store(isEnabled);
+}
+
+bool is_tracing_enabled(){
+    return isTracing.load();
+}
+
+void write_report(std::ostream& out){
+    auto regions = collect();
+    std::vector<std::pair<std::string, RegionStatistics>> rows(regions.begin(), regions.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b){
+        return a.second.nanoseconds > b.second.nanoseconds;
+    });
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::left << std::setw(36) << "region" << std::right
+        << std::setw(12) << "calls"
+        << std::setw(14) << "time [ms]"
+        << std::setw(12) << "GFLOP/s"
+        << std::setw(12) << "GB/s" << '\n';
+    out << std::fixed << std::setprecision(3);
+    for(auto& [name, statistics] : rows){
+        // FLOP per nanosecond equals GFLOP per second.
+        auto nanoseconds = std::max<double>(statistics.nanoseconds, 1);
+        out << std::left << std::setw(36) << name << std::right
+            << std::setw(12) << statistics.calls
+            << std::setw(14) << statistics.nanoseconds * 1e-6
+            << std::setw(12) << statistics.flops / nanoseconds
+            << std::setw(12) << statistics.bytes / nanoseconds << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void write_chrome_trace(std::ostream& out){
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool isFirstEvent = true;
+    for(auto& aggregate : registered_aggregates()){
+        std::lock_guard<std::mutex> lock(aggregate->mutex);
+        for(auto& event : aggregate->events){
+            using microseconds = std::chrono::duration<double, std::micro>;
+            out << (isFirstEvent ? "\n" : ",\n") << "{\"name\":";
+            write_json_string(out, event.name);
+            out << ",\"cat\":\"zlab\",\"ph\":\"X\",\"pid\":0,\"tid\":" << aggregate->threadIdentifier
+                << ",\"ts\":" << microseconds(event.start - processStart).count()
+                << ",\"dur\":" << microseconds(event.end - event.start).count() << "}";
+            isFirstEvent = false;
+        }
+    }
+    out << "\n]}\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+} // end namespace zlab::instrumentation
@@ -0,0 +1,78 @@
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <chrono>
+#include <map>
+
+namespace zlab::instrumentation{
+
+// REGION STATISTICS
+// Aggregated calls, inclusive wall time and analytic work of one named region.
+struct RegionStatistics{
+    std::uint64_t calls{0};
+    std::uint64_t nanoseconds{0};
+    double flops{0};
+    double bytes{0};
+};
+
+using clockType = std::chrono::steady_clock;
+
+// RECORD REGION
+// This function adds one completed region to the aggregate of the calling thread
+// and, when tracing is on, appends it to the thread's trace buffer.
+void record_region(const char*, double, double, clockType::time_point, clockType::time_point);
+
+// COLLECT / RESET
+// collect merges the aggregates of every thread that has recorded a region;
+// reset clears them together with the trace buffers.
+std::map<std::string, RegionStatistics> collect();
+void reset();
+
+// TRACING
+// Trace events are only buffered while tracing is enabled (off by default).
+void enable_tracing(bool);
+bool is_tracing_enabled();
+
+// REPORT / CHROME TRACE
+// write_report prints one line per region with calls, time, FLOP/s and bytes/s.
+// Times are inclusive, so nested regions (e.g. gemm inside a solver) appear in
+// both lines. write_chrome_trace writes the buffered events in the Trace Event
+// format read by chrome://tracing and Perfetto.
+void write_report(std::ostream&);
+void write_chrome_trace(std::ostream&);
+
+// SCOPED REGION
+// Times the enclosing scope and records it under name with the given work.
+class ScopedRegion{
+    private:
+        const char* name;
+        double flops;
+        double bytes;
+        clockType::time_point start;
+    public:
+        ScopedRegion(const char* name, double flops=0, double bytes=0) :
+            name(name), flops(flops), bytes(bytes), start(clockType::now()) {}
+        ScopedRegion(const ScopedRegion&) = delete;
+        ScopedRegion& operator=(const ScopedRegion&) = delete;
+        ~ScopedRegion() { record_region(name, flops, bytes, start, clockType::now()); }
+};
+
+} // end namespace zlab::instrumentation
+
+// ZLAB_INSTRUMENT(name, flops, bytes)
+// Opens a scoped region when the library is built with ZLAB_ENABLE_INSTRUMENTATION
+// and expands to nothing otherwise, so the work expressions are never evaluated.
+// Drivers that only dispatch to instrumented kernels (e.g. linear_solver) pass
+// zero work so that FLOPs and bytes are not counted twice.
+#define ZLAB_INSTRUMENT_CONCATENATE_(a, b) a##b
+#define ZLAB_INSTRUMENT_CONCATENATE(a, b) ZLAB_INSTRUMENT_CONCATENATE_(a, b)
+#if defined(ZLAB_ENABLE_INSTRUMENTATION)
+#define ZLAB_INSTRUMENT(name, flops, bytes) \
+    ::zlab::instrumentation::ScopedRegion ZLAB_INSTRUMENT_CONCATENATE(zlabInstrumentedRegion, __LINE__)( \
+        name, static_cast<double>(flops), static_cast<double>(bytes))
+#else
+#define ZLAB_INSTRUMENT(name, flops, bytes) static_cast<void>(0)
+#endif
@@ -0,0 +1,120 @@
+
+#include <algorithm>
+#include <new>
+
+#include "memory_resource.hpp"
+
+namespace zlab{
+
+namespace {
+    thread_local std::pmr::memory_resource* matrixMemoryResource = nullptr;
+
+    std::size_t align_up(std::size_t value, std::size_t alignment){
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+void* AlignedMemoryResource::do_allocate(std::size_t bytes, std::size_t alignment){
+    return ::operator new(bytes, std::align_val_t(std::max(alignment, memoryAlignment)));
+}
+
+void AlignedMemoryResource::do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment){
+    ::operator delete(pointer, bytes, std::align_val_t(std::max(alignment, memoryAlignment)));
+}
+
+bool AlignedMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return dynamic_cast<const AlignedMemoryResource*>(&other) != nullptr;
+}
+
+std::pmr::memory_resource* aligned_memory_resource(){
+    static AlignedMemoryResource resource;
+    return &resource;
+}
+
+WorkspaceArena::WorkspaceArena(std::size_t minimumChunkSize) : minimumChunkSize(minimumChunkSize) {}
+
+WorkspaceArena::~WorkspaceArena(){
+    release();
+}
+
+void* WorkspaceArena::do_allocate(std::size_t bytes, std::size_t alignment){
+    alignment = std::max(alignment, memoryAlignment);
+    bytes = std::max<std::size_t>(bytes, 1);
+    while (chunkIndex < chunks.size()) {
+        auto start = align_up(offset, alignment);
+        if (start + bytes <= chunks[chunkIndex].size) {
+            offset = start + bytes;
+            return chunks[chunkIndex].memory + start;
+        }
+        ++chunkIndex;
+        offset = 0;
+        // Chunks past the current one are free; replace one that is too small.
+        if (chunkIndex < chunks.size() && chunks[chunkIndex].size < bytes) {
+            ::operator delete(chunks[chunkIndex].memory, std::align_val_t(memoryAlignment));
+            chunks.erase(chunks.begin() + chunkIndex);
+            break;
+        }
+    }
+    auto size = std::max(minimumChunkSize, align_up(bytes, memoryAlignment));
+    auto memory = static_cast<std::byte*>(::operator new(size, std::align_val_t(memoryAlignment)));
+    chunks.insert(chunks.begin() + chunkIndex, Chunk{memory, size});
+    offset = bytes;
+    return memory;
+}
+
+void WorkspaceArena::rewind(Mark position){
+    chunkIndex = position.chunkIndex;
+    offset = position.offset;
+}
+
+void WorkspaceArena::release(){
+    for(auto& chunk : chunks){
+        ::operator delete(chunk.memory, std::align_val_t(memoryAlignment));
+    }
+    chunks.clear();
+    chunkIndex = 0;
+    offset = 0;
+}
+
+std::size_t WorkspaceArena::get_capacity() const {
+    std::size_t capacity{0};
+    for(auto& chunk : chunks){
+        capacity += chunk.size;
+    }
+    return capacity;
+}
+
+std::pmr::memory_resource* get_matrix_memory_resource(){
+    return matrixMemoryResource ? matrixMemoryResource : aligned_memory_resource();
+}
+
+void set_matrix_memory_resource(std::pmr::memory_resource* resource){
+    matrixMemoryResource = resource;
+}
+
+WorkspaceArena& workspace_arena(){
+    thread_local WorkspaceArena arena;
+    return arena;
+}
+
+ScopedWorkspace::ScopedWorkspace() :
+    arena(workspace_arena()),
+    arenaMark(arena.mark()),
+    previousResource(get_matrix_memory_resource()) {
+    set_matrix_memory_resource(&arena);
+}
+
+ScopedWorkspace::~ScopedWorkspace(){
+    set_matrix_memory_resource(previousResource);
+    arena.rewind(arenaMark);
+}
+
+ScopedArena::ScopedArena() :
+    arena(workspace_arena()),
+    arenaMark(arena.mark()) {}
+
+ScopedArena::~ScopedArena(){
+    arena.rewind(arenaMark);
+}
+
+} // end namespace zlab
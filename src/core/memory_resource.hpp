@@ -0,0 +1,112 @@
+
+#pragma once
+
+#include <memory_resource>
+#include <cstddef>
+#include <vector>
+
+#include "numeric_types.hpp"
+
+namespace zlab{
+
+// Every ZMatrix/ZVector buffer is aligned to a cache line, which also covers the
+// widest SIMD registers.
+static constexpr std::size_t memoryAlignment = 64;
+
+// ALIGNED MEMORY RESOURCE
+// A heap resource that hands out memoryAlignment-aligned blocks. It is the
+// default resource of every thread.
+class AlignedMemoryResource : public std::pmr::memory_resource{
+    private:
+        void* do_allocate(std::size_t, std::size_t) override;
+        void do_deallocate(void*, std::size_t, std::size_t) override;
+        bool do_is_equal(const std::pmr::memory_resource&) const noexcept override;
+};
+
+std::pmr::memory_resource* aligned_memory_resource();
+
+// WORKSPACE ARENA
+// A bump allocator for scratch matrices. Memory is never returned block by
+// block: mark records the position and rewind releases everything allocated
+// after it, keeping the chunks for the next allocations. Chunks grow to fit
+// the largest request, so a repeated workload stops calling the heap after the
+// first pass. An arena must only be used by one thread at a time.
+class WorkspaceArena : public std::pmr::memory_resource{
+    public:
+        struct Mark{
+            positiveIntegerType chunkIndex;
+            std::size_t offset;
+        };
+    private:
+        struct Chunk{
+            std::byte* memory;
+            std::size_t size;
+        };
+        std::vector<Chunk> chunks;
+        positiveIntegerType chunkIndex{0};
+        std::size_t offset{0};
+        std::size_t minimumChunkSize;
+
+        void* do_allocate(std::size_t, std::size_t) override;
+        void do_deallocate(void*, std::size_t, std::size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+    public:
+        explicit WorkspaceArena(std::size_t minimumChunkSize = 1 << 20);
+        WorkspaceArena(const WorkspaceArena&) = delete;
+        WorkspaceArena& operator=(const WorkspaceArena&) = delete;
+        ~WorkspaceArena();
+
+        Mark mark() const { return {chunkIndex, offset}; }
+        void rewind(Mark);
+        void release();
+        std::size_t get_capacity() const;
+};
+
+// MATRIX MEMORY RESOURCE
+// The resource that ZMatrix and ZVector use when none is passed explicitly. It is
+// set per thread and defaults to aligned_memory_resource().
+std::pmr::memory_resource* get_matrix_memory_resource();
+void set_matrix_memory_resource(std::pmr::memory_resource*);
+
+// WORKSPACE ARENA OF THE CALLING THREAD
+WorkspaceArena& workspace_arena();
+
+// SCOPED WORKSPACE
+// While alive, matrices and vectors created on this thread without an explicit
+// resource are placed in the thread's workspace arena; on destruction the arena
+// is rewound and the previous resource restored. Scopes nest. Nothing created
+// inside the scope may outlive it: results must live in objects constructed
+// before the scope (copy or move-assign into them, which copies across
+// resources).
+class ScopedWorkspace{
+    private:
+        WorkspaceArena& arena;
+        WorkspaceArena::Mark arenaMark;
+        std::pmr::memory_resource* previousResource;
+    public:
+        ScopedWorkspace();
+        ScopedWorkspace(const ScopedWorkspace&) = delete;
+        ScopedWorkspace& operator=(const ScopedWorkspace&) = delete;
+        ~ScopedWorkspace();
+};
+
+// SCOPED ARENA
+// Marks the thread's workspace arena and rewinds it on destruction like
+// ScopedWorkspace, but leaves the default resource alone: only buffers created
+// with get_resource() come from the arena. Routines that call user code (a
+// right-hand side, a callback) use it, so that what the user allocates there
+// outlives the routine.
+class ScopedArena{
+    private:
+        WorkspaceArena& arena;
+        WorkspaceArena::Mark arenaMark;
+    public:
+        ScopedArena();
+        ScopedArena(const ScopedArena&) = delete;
+        ScopedArena& operator=(const ScopedArena&) = delete;
+        ~ScopedArena();
+
+        std::pmr::memory_resource* get_resource() const { return &arena; }
+};
+
+} // end namespace zlab
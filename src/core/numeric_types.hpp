@@ -1,7 +1,11 @@
 
 #pragma once
 
+#include <type_traits>
+#include <concepts>
 #include <optional>
+#include <complex>
+#include <limits>
 
 namespace zlab{
 
@@ -9,6 +13,58 @@ using scalarType = double;
 using integerType = int;
 using positiveIntegerType = std::size_t;
 
-scalarType evaluate_safe_tolerance(std::optional<scalarType> marginOfErrorOption = std::nullopt);
+// SCALAR CONCEPT
+// The element types the matrix, decomposition, solver, ODE and RBF templates
+// accept: real floating-point types and std::complex of them. scalarType stays
+// the default everywhere a type is not deduced from the arguments.
+template <typename T>
+struct is_complex : std::false_type {};
+
+template <typename T>
+struct is_complex<std::complex<T>> : std::true_type {};
+
+template <typename T>
+concept RealScalarConcept = std::floating_point<T>;
+
+template <typename T>
+concept ComplexScalarConcept = is_complex<T>::value && std::floating_point<typename T::value_type>;
+
+template <typename T>
+concept ScalarConcept = RealScalarConcept<T> || ComplexScalarConcept<T>;
+
+// REAL TYPE
+// The type of magnitudes, norms and tolerances for a scalar type: T itself for
+// a real type and the component type for std::complex.
+template <typename T>
+struct real_type { using type = T; };
+
+template <typename T>
+struct real_type<std::complex<T>> { using type = T; };
+
+template <typename T>
+using RealType = typename real_type<T>::type;
+
+// LOW PRECISION TYPE
+// The storage type of the low precision factorization in mixed precision
+// iterative refinement: float, or std::complex<float> for complex types.
+template <typename T>
+struct low_precision_type { using type = float; };
+
+template <typename T>
+struct low_precision_type<std::complex<T>> { using type = std::complex<float>; };
+
+template <typename T>
+using LowPrecisionType = typename low_precision_type<T>::type;
+
+// EVALUATE SAFE TOLERANCE
+// This function returns marginOfError (1e2 by default) times the machine epsilon
+// of valueType, so a float computation gets a float-sized tolerance.
+template <ScalarConcept valueType = scalarType>
+RealType<valueType> evaluate_safe_tolerance(std::optional<scalarType> marginOfErrorOption = std::nullopt){
+    auto eps = std::numeric_limits<RealType<valueType>>::epsilon();
+    auto defaultMarginOfError = 1e2;
+    auto marginOfError = marginOfErrorOption.value_or(defaultMarginOfError);
+    return eps * static_cast<RealType<valueType>>(marginOfError);
+}
 
 } // end namespce zlab
@@ -0,0 +1,24 @@
+
+#include <atomic>
+
+#include "reduction.hpp"
+
+namespace zlab{
+
+namespace {
+#ifdef ZLAB_REPRODUCIBLE_REDUCTIONS
+    std::atomic<SummationMode> summationMode{SummationMode::Reproducible};
+#else
+    std::atomic<SummationMode> summationMode{SummationMode::Fast};
+#endif
+}
+
+SummationMode get_summation_mode(){
+    return summationMode.load(std::memory_order_relaxed);
+}
+
+void set_summation_mode(SummationMode mode){
+    summationMode.store(mode, std::memory_order_relaxed);
+}
+
+} // end namespace zlab
@@ -0,0 +1,138 @@
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <array>
+
+#include "numeric_types.hpp"
+#include "thread_pool.hpp"
+
+namespace zlab{
+
+// SUMMATION MODE
+// Fast splits a reduction into one block per thread, so the rounding of the
+// result depends on the number of threads. Reproducible splits it into blocks of
+// reproducibleBlockSize indices, sums every block with Kahan-compensated lanes
+// and combines the block results in a fixed pairwise order, so results are
+// bitwise identical for any number of threads. The default is Fast unless the
+// library is built with ZLAB_REPRODUCIBLE_REDUCTIONS. set_summation_mode must not
+// be called while parallel work is running.
+enum class SummationMode { Fast, Reproducible };
+
+SummationMode get_summation_mode();
+void set_summation_mode(SummationMode);
+
+// SCOPED SUMMATION MODE
+// Sets the summation mode for the lifetime of the object and restores the
+// previous mode afterwards.
+class ScopedSummationMode{
+        SummationMode previousMode;
+    public:
+        ScopedSummationMode() = delete;
+        ScopedSummationMode(const ScopedSummationMode&) = delete;
+        explicit ScopedSummationMode(SummationMode mode) : previousMode(get_summation_mode()) { set_summation_mode(mode); }
+        ~ScopedSummationMode() { set_summation_mode(previousMode); }
+        ScopedSummationMode& operator=(const ScopedSummationMode&) = delete;
+};
+
+inline constexpr positiveIntegerType reproducibleBlockSize = 4096;
+inline constexpr positiveIntegerType reductionLanes = 8;
+
+// PAIRWISE COMBINE
+// This function folds partials into partials[0] along a fixed binary tree.
+template <typename valueType, typename combineFunctionType>
+valueType pairwise_combine(std::vector<valueType>& partials, combineFunctionType&& combine){
+    for(positiveIntegerType stride=1; stride < partials.size(); stride *= 2){
+        for(positiveIntegerType i=0; i + stride < partials.size(); i += 2 * stride){
+            partials[i] = combine(partials[i], partials[i + stride]);
+        }
+    }
+    return partials[0];
+}
+
+// PARALLEL REDUCE
+// This function reduces [begin, end) by calling reduce_block(first, last) on
+// blocks of the range on the library thread pool and folding the block results
+// with pairwise_combine. In Fast mode a range of at most grainSize indices is one
+// block and larger ranges get one block per thread; in Reproducible mode the
+// blocks have reproducibleBlockSize indices whatever the number of threads.
+template <typename valueType, typename blockFunctionType, typename combineFunctionType>
+valueType parallel_reduce(
+    positiveIntegerType begin,
+    positiveIntegerType end,
+    valueType identity,
+    blockFunctionType&& reduce_block,
+    combineFunctionType&& combine,
+    positiveIntegerType grainSize=1)
+{
+    if (end <= begin) return identity;
+    auto numberOfIndices = end - begin;
+    auto blockSize = reproducibleBlockSize;
+    if (get_summation_mode() == SummationMode::Fast) {
+        if (numberOfIndices <= grainSize) return reduce_block(begin, end);
+        auto numberOfThreads = get_number_of_threads();
+        blockSize = std::max(grainSize, (numberOfIndices + numberOfThreads - 1) / numberOfThreads);
+    }
+    auto numberOfBlocks = (numberOfIndices + blockSize - 1) / blockSize;
+    if (numberOfBlocks == 1) return reduce_block(begin, end);
+    std::vector<valueType> partials(numberOfBlocks, identity);
+    parallel_for(0, numberOfBlocks, [&](positiveIntegerType first, positiveIntegerType last){
+        for(auto block=first; block < last; ++block){
+            auto blockBegin = begin + block * blockSize;
+            partials[block] = reduce_block(blockBegin, std::min(end, blockBegin + blockSize));
+        }
+    }, grain_size(blockSize));
+    return pairwise_combine(partials, combine);
+}
+
+// SUM BLOCK
+// This function sums term(i) over [first, last) with reductionLanes independent
+// accumulators, which the compiler keeps in SIMD registers, and adds the lanes
+// pairwise. With isCompensated every lane carries a Kahan correction.
+template <bool isCompensated, typename valueType, typename termFunctionType>
+valueType sum_block(positiveIntegerType first, positiveIntegerType last, termFunctionType& term){
+    std::array<valueType, reductionLanes> sums{}, corrections{};
+    auto accumulate = [&](positiveIntegerType lane, valueType value){
+        if constexpr (isCompensated) {
+            auto corrected = value - corrections[lane];
+            auto sum = sums[lane] + corrected;
+            corrections[lane] = (sum - sums[lane]) - corrected;
+            sums[lane] = sum;
+        } else {
+            sums[lane] += value;
+        }
+    };
+    auto i = first;
+    for(; i + reductionLanes <= last; i += reductionLanes){
+        for(positiveIntegerType lane=0; lane < reductionLanes; ++lane){
+            accumulate(lane, term(i + lane));
+        }
+    }
+    for(positiveIntegerType lane=0; i < last; ++i, ++lane){
+        accumulate(lane, term(i));
+    }
+    for(positiveIntegerType stride=1; stride < reductionLanes; stride *= 2){
+        for(positiveIntegerType lane=0; lane + stride < reductionLanes; lane += 2 * stride){
+            sums[lane] += sums[lane + stride] - corrections[lane + stride];
+        }
+    }
+    return sums[0] - corrections[0];
+}
+
+// PARALLEL SUM
+// This function returns the sum of term(i) for i in [0, size) with
+// parallel_reduce. Reproducible mode compensates the block sums.
+template <typename valueType, typename termFunctionType>
+valueType parallel_sum(positiveIntegerType size, termFunctionType&& term){
+    if (get_summation_mode() == SummationMode::Reproducible) {
+        return parallel_reduce(0, size, valueType{0}, [&](positiveIntegerType first, positiveIntegerType last){
+            return sum_block<true, valueType>(first, last, term);
+        }, [](valueType a, valueType b){ return a + b; });
+    }
+    return parallel_reduce(0, size, valueType{0}, [&](positiveIntegerType first, positiveIntegerType last){
+        return sum_block<false, valueType>(first, last, term);
+    }, [](valueType a, valueType b){ return a + b; }, grain_size(1));
+}
+
+} // end namespace zlab
@@ -0,0 +1,137 @@
+
+#include <algorithm>
+#include <exception>
+#include <cassert>
+#include <memory>
+
+#include "thread_pool.hpp"
+
+namespace zlab{
+
+namespace {
+    thread_local bool isPoolWorker = false;
+    std::unique_ptr<ThreadPool> libraryThreadPool;
+    std::mutex libraryThreadPoolMutex;
+
+    positiveIntegerType default_number_of_threads(){
+        auto numberOfCores = std::thread::hardware_concurrency();
+        return numberOfCores > 0 ? numberOfCores : 1;
+    }
+}
+
+ThreadPool::ThreadPool(positiveIntegerType numberOfThreads){
+    assert(numberOfThreads > 0);
+    workers.reserve(numberOfThreads - 1);
+    for(positiveIntegerType i=1; i < numberOfThreads; ++i){
+        workers.emplace_back([this]{ worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool(){
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        isStopping = true;
+    }
+    tasksCondition.notify_all();
+    for(auto& worker : workers){
+        worker.join();
+    }
+}
+
+void ThreadPool::worker_loop(){
+    isPoolWorker = true;
+    while(true){
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasksMutex);
+            tasksCondition.wait(lock, [this]{ return isStopping || !tasks.empty(); });
+            if (isStopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallel_for(
+    positiveIntegerType begin,
+    positiveIntegerType end,
+    const std::function<void(positiveIntegerType, positiveIntegerType)>& body,
+    positiveIntegerType grainSize)
+{
+    if (end <= begin) return;
+    auto numberOfIndices = end - begin;
+    grainSize = std::max<positiveIntegerType>(grainSize, 1);
+    // A few chunks per thread let idle threads pick up the remaining work when
+    // the chunks are uneven (e.g. triangular loops).
+    auto maximumNumberOfChunks = chunksPerThread * get_number_of_threads();
+    auto numberOfChunks = std::min(maximumNumberOfChunks, (numberOfIndices + grainSize - 1) / grainSize);
+    if (numberOfChunks < 2 || workers.empty() || isPoolWorker) {
+        body(begin, end);
+        return;
+    }
+    auto chunkSize = (numberOfIndices + numberOfChunks - 1) / numberOfChunks;
+    numberOfChunks = (numberOfIndices + chunkSize - 1) / chunkSize;
+
+    std::mutex doneMutex;
+    std::condition_variable doneCondition;
+    positiveIntegerType numberOfPendingChunks = numberOfChunks;
+    std::exception_ptr firstException;
+
+    {
+        std::lock_guard<std::mutex> lock(tasksMutex);
+        for(positiveIntegerType chunk=0; chunk < numberOfChunks; ++chunk){
+            auto first = begin + chunk * chunkSize;
+            auto last = std::min(end, first + chunkSize);
+            tasks.emplace([&, first, last]{
+                try {
+                    body(first, last);
+                } catch (...) {
+                    std::lock_guard<std::mutex> doneLock(doneMutex);
+                    if (!firstException) firstException = std::current_exception();
+                }
+                std::lock_guard<std::mutex> doneLock(doneMutex);
+                if (--numberOfPendingChunks == 0) doneCondition.notify_all();
+            });
+        }
+    }
+    tasksCondition.notify_all();
+
+    // The calling thread runs queued chunks until none are left, then waits
+    // for the chunks still in flight on the workers.
+    while(true){
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(tasksMutex);
+            if (tasks.empty()) break;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+
+    std::unique_lock<std::mutex> lock(doneMutex);
+    doneCondition.wait(lock, [&]{ return numberOfPendingChunks == 0; });
+    if (firstException) std::rethrow_exception(firstException);
+}
+
+ThreadPool& thread_pool(){
+    std::lock_guard<std::mutex> lock(libraryThreadPoolMutex);
+    if (!libraryThreadPool) {
+        libraryThreadPool = std::make_unique<ThreadPool>(default_number_of_threads());
+    }
+    return *libraryThreadPool;
+}
+
+void set_number_of_threads(positiveIntegerType numberOfThreads){
+    assert(numberOfThreads > 0);
+    std::lock_guard<std::mutex> lock(libraryThreadPoolMutex);
+    libraryThreadPool.reset();
+    libraryThreadPool = std::make_unique<ThreadPool>(numberOfThreads);
+}
+
+positiveIntegerType get_number_of_threads(){
+    return thread_pool().get_number_of_threads();
+}
+
+} // end namespace zlab
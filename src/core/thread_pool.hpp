@@ -0,0 +1,89 @@
+
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <queue>
+
+#include "numeric_types.hpp"
+
+namespace zlab{
+
+// THREAD POOL
+// A fixed set of worker threads shared by every parallel routine of the library.
+// Work is submitted as index ranges through parallel_for; the calling thread
+// takes part in the work and returns only when the whole range is done.
+class ThreadPool{
+    private:
+        std::vector<std::thread> workers;
+        std::queue<std::function<void()>> tasks;
+        std::mutex tasksMutex;
+        std::condition_variable tasksCondition;
+        bool isStopping{false};
+        static constexpr positiveIntegerType chunksPerThread = 4;
+
+        void worker_loop();
+    public:
+        ThreadPool() = delete;
+        ThreadPool(const ThreadPool&) = delete;
+        explicit ThreadPool(positiveIntegerType);
+        ~ThreadPool();
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        positiveIntegerType get_number_of_threads() const { return workers.size() + 1; }
+
+        void parallel_for(
+            positiveIntegerType,
+            positiveIntegerType,
+            const std::function<void(positiveIntegerType, positiveIntegerType)>&,
+            positiveIntegerType=1);
+};
+
+// LIBRARY THREAD POOL
+// The pool is created on first use with one thread per hardware core.
+// set_number_of_threads must not be called while parallel work is running.
+ThreadPool& thread_pool();
+void set_number_of_threads(positiveIntegerType);
+positiveIntegerType get_number_of_threads();
+
+// THREAD SCOPE
+// Sets the library thread count for the lifetime of the scope and restores the
+// previous count on exit, also when an exception leaves the scope.
+class ThreadScope{
+    private:
+        positiveIntegerType previousNumberOfThreads;
+    public:
+        explicit ThreadScope(positiveIntegerType numberOfThreads) : previousNumberOfThreads(get_number_of_threads()) {
+            set_number_of_threads(numberOfThreads);
+        }
+        ThreadScope(const ThreadScope&) = delete;
+        ThreadScope& operator=(const ThreadScope&) = delete;
+        ~ThreadScope() { set_number_of_threads(previousNumberOfThreads); }
+};
+
+// PARALLEL FOR
+// This function splits [begin, end) into contiguous chunks of at least grainSize
+// indices and calls body(first, last) for each chunk on the library thread pool.
+// Calls made from inside a worker run serially to avoid oversubscription.
+template <typename functionType>
+void parallel_for(
+    positiveIntegerType begin,
+    positiveIntegerType end,
+    functionType&& body,
+    positiveIntegerType grainSize=1)
+{
+    thread_pool().parallel_for(begin, end, body, grainSize);
+}
+
+// GRAIN SIZE
+// This function returns the number of loop indices a chunk needs so that each
+// chunk carries at least minimumParallelWork units of work.
+inline positiveIntegerType grain_size(positiveIntegerType workPerIndex){
+    constexpr positiveIntegerType minimumParallelWork = 1 << 15;
+    return minimumParallelWork / (workPerIndex > 0 ? workPerIndex : 1) + 1;
+}
+
+} // end namespace zlab
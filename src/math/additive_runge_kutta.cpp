@@ -0,0 +1,2 @@
+
+#include "additive_runge_kutta.hpp"
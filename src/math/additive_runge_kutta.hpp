@@ -0,0 +1,267 @@
+
+#pragma once
+
+#include <functional>
+#include <stdexcept>
+#include <optional>
+#include <cassert>
+#include <vector>
+
+#include "core.hpp"
+#include "matrix.hpp"
+#include "ode.hpp"
+#include "solvers.hpp"
+
+namespace zlab{
+
+// ADDITIVE BUTCHER TABLEAU
+// A pair of tableaus sharing the stages of an additive (IMEX) Runge-Kutta method:
+// an explicit one for the non-stiff part and a diagonally implicit one for the
+// stiff part.
+template <positiveIntegerType numberOfStages_>
+struct AdditiveButcherTableau {
+    static constexpr auto numberOfStages = numberOfStages_;
+    ButcherTableau<numberOfStages_> explicitTableau;
+    ButcherTableau<numberOfStages_> implicitTableau;
+};
+
+// Forward Euler on the non-stiff part and backward Euler on the stiff part.
+static constexpr AdditiveButcherTableau<2> AdditiveButcherTableauIMEXEuler = {
+    {{{{0.0, 0.0}, {1.0, 0.0}}}, {1.0, 0.0}, {0.0, 1.0}},
+    {{{{0.0, 0.0}, {0.0, 1.0}}}, {0.0, 1.0}, {0.0, 1.0}}
+};
+static constexpr auto& IMEXEuler = AdditiveButcherTableauIMEXEuler;
+
+// Kennedy and Carpenter's third-order ARK3(2)4L[2]SA.
+static constexpr AdditiveButcherTableau<4> AdditiveButcherTableauARK324L2SA = {
+    {
+        {{
+        {0.0, 0.0, 0.0, 0.0},
+        {1767732205903.0/2027836641118.0, 0.0, 0.0, 0.0},
+        {5535828885825.0/10492691773637.0, 788022342437.0/10882634858940.0, 0.0, 0.0},
+        {6485989280629.0/16251701735622.0, -4246266847089.0/9704473918619.0, 10755448449292.0/10357097424841.0, 0.0}
+        }},
+        {1471266399579.0/7840856788654.0, -4482444167858.0/7529755066697.0, 11266239266428.0/11593286722821.0, 1767732205903.0/4055673282236.0},
+        {0.0, 1767732205903.0/2027836641118.0, 3.0/5.0, 1.0}
+    },
+    {
+        {{
+        {0.0, 0.0, 0.0, 0.0},
+        {1767732205903.0/4055673282236.0, 1767732205903.0/4055673282236.0, 0.0, 0.0},
+        {2746238789719.0/10658868560708.0, -640167445237.0/6845629431997.0, 1767732205903.0/4055673282236.0, 0.0},
+        {1471266399579.0/7840856788654.0, -4482444167858.0/7529755066697.0, 11266239266428.0/11593286722821.0, 1767732205903.0/4055673282236.0}
+        }},
+        {1471266399579.0/7840856788654.0, -4482444167858.0/7529755066697.0, 11266239266428.0/11593286722821.0, 1767732205903.0/4055673282236.0},
+        {0.0, 1767732205903.0/2027836641118.0, 3.0/5.0, 1.0}
+    }
+};
+static constexpr auto& ARK324L2SA = AdditiveButcherTableauARK324L2SA;
+
+// Kennedy and Carpenter's fourth-order ARK4(3)6L[2]SA.
+static constexpr AdditiveButcherTableau<6> AdditiveButcherTableauARK436L2SA = {
+    {
+        {{
+        {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {1.0/2.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {13861.0/62500.0, 6889.0/62500.0, 0.0, 0.0, 0.0, 0.0},
+        {-116923316275.0/2393684061468.0, -2731218467317.0/15368042101831.0, 9408046702089.0/11113171139209.0, 0.0, 0.0, 0.0},
+        {-451086348788.0/2902428689909.0, -2682348792572.0/7519795681897.0, 12662868775082.0/11960479115383.0, 3355817975965.0/11060851509271.0, 0.0, 0.0},
+        {647845179188.0/3216320057751.0, 73281519250.0/8382639484533.0, 552539513391.0/3454668386233.0, 3354512671639.0/8306763924573.0, 4040.0/17871.0, 0.0}
+        }},
+        {82889.0/524892.0, 0.0, 15625.0/83664.0, 69875.0/102672.0, -2260.0/8211.0, 1.0/4.0},
+        {0.0, 1.0/2.0, 83.0/250.0, 31.0/50.0, 17.0/20.0, 1.0}
+    },
+    {
+        {{
+        {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+        {1.0/4.0, 1.0/4.0, 0.0, 0.0, 0.0, 0.0},
+        {8611.0/62500.0, -1743.0/31250.0, 1.0/4.0, 0.0, 0.0, 0.0},
+        {5012029.0/34652500.0, -654441.0/2922500.0, 174375.0/388108.0, 1.0/4.0, 0.0, 0.0},
+        {15267082809.0/155376265600.0, -71443401.0/120774400.0, 730878875.0/902184768.0, 2285395.0/8070912.0, 1.0/4.0, 0.0},
+        {82889.0/524892.0, 0.0, 15625.0/83664.0, 69875.0/102672.0, -2260.0/8211.0, 1.0/4.0}
+        }},
+        {82889.0/524892.0, 0.0, 15625.0/83664.0, 69875.0/102672.0, -2260.0/8211.0, 1.0/4.0},
+        {0.0, 1.0/2.0, 83.0/250.0, 31.0/50.0, 17.0/20.0, 1.0}
+    }
+};
+static constexpr auto& ARK436L2SA = AdditiveButcherTableauARK436L2SA;
+
+// ADDITIVE RUNGE KUTTA SOLVER
+// IMEX time stepping of y' = FE(t, y) + FI(t, y), with FE non-stiff and treated
+// explicitly and FI stiff and treated implicitly; jacobian(t, y, J) must set
+// J = dFI/dy. The implicit tableau must be diagonally implicit with one nonzero
+// diagonal coefficient gamma (explicit stages have a zero diagonal), so every
+// implicit stage solves Y = Z + h * gamma * FI(t, Y) by simplified Newton with the
+// same matrix I - h * gamma * J. Its LU factorization is computed once and reused
+// across stages and time steps; it is recomputed only when the Newton iteration
+// stalls, so a linear FI is factored once per solve. The step size then follows
+// the non-stiff dynamics only.
+template <positiveIntegerType numberOfStages, typename explicitFunctionType, typename implicitFunctionType,
+          typename jacobianType, ScalarConcept valueType = scalarType>
+class AdditiveRungeKuttaSolver{
+        explicitFunctionType FE;
+        implicitFunctionType FI;
+        jacobianType jacobian;
+        RealType<valueType> timeStep;
+        positiveIntegerType numberTimeSteps;
+        BasicZVector<valueType> initialState;
+        const AdditiveButcherTableau<numberOfStages>& tableau;
+        RealType<valueType> initialTime;
+        std::optional<scalarType> marginOfError;
+        scalarType gamma;
+        positiveIntegerType numberOfFactorizations;
+    public:
+        AdditiveRungeKuttaSolver() = delete;
+        AdditiveRungeKuttaSolver(const explicitFunctionType&,
+                                 const implicitFunctionType&,
+                                 const jacobianType&,
+                                 const BasicZVector<valueType>&,
+                                 const RealType<valueType>,
+                                 const integerType,
+                                 const AdditiveButcherTableau<numberOfStages>&,
+                                 const RealType<valueType> = 0,
+                                 std::optional<scalarType> = std::nullopt);
+
+        auto solve(std::function<void(integerType, const BasicZVector<valueType>&)> = [](integerType, const BasicZVector<valueType>&){});
+
+        positiveIntegerType get_number_of_factorizations() const { return numberOfFactorizations; }
+};
+
+template <positiveIntegerType numberOfStages, typename explicitFunctionType, typename implicitFunctionType,
+          typename jacobianType, ScalarConcept valueType>
+AdditiveRungeKuttaSolver<numberOfStages, explicitFunctionType, implicitFunctionType, jacobianType, valueType>::AdditiveRungeKuttaSolver(
+    const explicitFunctionType& FE,
+    const implicitFunctionType& FI,
+    const jacobianType& jacobian,
+    const BasicZVector<valueType>& initialState,
+    const RealType<valueType> timeStep,
+    const integerType numberTimeSteps,
+    const AdditiveButcherTableau<numberOfStages>& tableau,
+    const RealType<valueType> initialTime,
+    std::optional<scalarType> marginOfError) :
+    FE(FE),
+    FI(FI),
+    jacobian(jacobian),
+    timeStep(timeStep),
+    numberTimeSteps(numberTimeSteps),
+    initialState(initialState.copy()),
+    tableau(tableau),
+    initialTime(initialTime),
+    marginOfError(marginOfError),
+    gamma(0),
+    numberOfFactorizations(0) {
+    assert(timeStep > 0);
+    assert(numberTimeSteps > 0);
+    const auto& explicitA = tableau.explicitTableau.A;
+    const auto& implicitA = tableau.implicitTableau.A;
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        for(auto j=s; j < numberOfStages; ++j){
+            if (explicitA[s][j] != 0 || (j > s && implicitA[s][j] != 0)) {
+                throw std::invalid_argument("IMEX: The tableaus must be explicit and diagonally implicit.");
+            }
+        }
+        if (implicitA[s][s] == 0) continue;
+        if (gamma != 0 && implicitA[s][s] != gamma) {
+            throw std::invalid_argument("IMEX: The implicit stages must share one diagonal coefficient.");
+        }
+        gamma = implicitA[s][s];
+    }
+}
+
+template <positiveIntegerType numberOfStages, typename explicitFunctionType, typename implicitFunctionType,
+          typename jacobianType, ScalarConcept valueType>
+auto AdditiveRungeKuttaSolver<numberOfStages, explicitFunctionType, implicitFunctionType, jacobianType, valueType>::solve(
+    std::function<void(integerType, const BasicZVector<valueType>&)> callback)
+{
+    auto n = initialState.size();
+    // The factorizations and solves report themselves; the functors are user code.
+    ZLAB_INSTRUMENT("additive_runge_kutta_solve", 0, 0);
+    constexpr positiveIntegerType maximumNewtonIterations = 10;
+    auto tolerance = evaluate_safe_tolerance(marginOfError);
+    const auto& explicitTableau = tableau.explicitTableau;
+    const auto& implicitTableau = tableau.implicitTableau;
+
+    // A refactorization replaces the factor, so nothing here lives in the
+    // workspace arena, which would only be rewound at the end of the solve.
+    auto presentState = initialState.copy();
+    BasicZVector<valueType> baseState(n), stageState(n), residual(n), correction(n);
+    std::vector<BasicZVector<valueType>> KE, KI;
+    KE.reserve(numberOfStages);
+    KI.reserve(numberOfStages);
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        KE.emplace_back(n);
+        KI.emplace_back(n);
+    }
+    BasicZMatrix<valueType> J(n, n), M(n, n);
+    std::optional<Factorization<BasicZMatrix<valueType>>> factorization;
+    auto refactor = [&](RealType<valueType> t, const BasicZVector<valueType>& y){
+        jacobian(t, y, J);
+        for(positiveIntegerType i=0; i < n; ++i){
+            for(positiveIntegerType j=0; j < n; ++j){
+                M(i,j) = (i == j ? valueType{1} : valueType{0}) - timeStep * gamma * J(i,j);
+            }
+        }
+        factorization.emplace(M, FactorizationMethod::LU, marginOfError);
+        numberOfFactorizations++;
+    };
+    // Simplified Newton on Y = Z + h * gamma * FI(t, Y), starting from Y = Z.
+    auto newton = [&](RealType<valueType> t){
+        stageState = baseState;
+        RealType<valueType> previousCorrectionNorm{0};
+        for(positiveIntegerType iteration=0; iteration < maximumNewtonIterations; ++iteration){
+            FI(t, stageState, residual);
+            axpby(1, baseState, timeStep * gamma, residual);
+            axpy(-1, stageState, residual);
+            factorization->solve(residual, correction);
+            axpy(1, correction, stageState);
+            auto correctionNorm = norm_infinity(correction);
+            if (correctionNorm <= tolerance * (norm_infinity(stageState) + 1)) return true;
+            if (iteration > 0 && correctionNorm > previousCorrectionNorm / 2) return false;
+            previousCorrectionNorm = correctionNorm;
+        }
+        return false;
+    };
+
+    auto presentTime = initialTime;
+    for(auto it=0; it < numberTimeSteps; it++){
+        for(positiveIntegerType s=0; s < numberOfStages; ++s){
+            auto stageTime = presentTime + implicitTableau.c[s] * timeStep;
+            baseState = presentState;
+            for(positiveIntegerType j=0; j < s; ++j){
+                if (explicitTableau.A[s][j] != 0) axpy(timeStep * explicitTableau.A[s][j], KE[j], baseState);
+                if (implicitTableau.A[s][j] != 0) axpy(timeStep * implicitTableau.A[s][j], KI[j], baseState);
+            }
+            if (implicitTableau.A[s][s] == 0) {
+                stageState = baseState;
+                FI(stageTime, stageState, KI[s]);
+            } else {
+                if (!factorization) refactor(stageTime, baseState);
+                if (!newton(stageTime)) {
+                    // The factor is stale: refresh it at the stage and try once more.
+                    refactor(stageTime, baseState);
+                    if (!newton(stageTime)) {
+                        throw std::runtime_error("IMEX: The Newton iteration does not converge; reduce the time step.");
+                    }
+                }
+                // FI(Y) = (Y - Z) / (h * gamma) without another evaluation.
+                KI[s] = stageState;
+                axpy(-1, baseState, KI[s]);
+                scale(KI[s], 1 / (timeStep * gamma));
+            }
+            FE(stageTime, stageState, KE[s]);
+        }
+        for(positiveIntegerType s=0; s < numberOfStages; ++s){
+            if (explicitTableau.b[s] != 0) axpy(timeStep * explicitTableau.b[s], KE[s], presentState);
+            if (implicitTableau.b[s] != 0) axpy(timeStep * implicitTableau.b[s], KI[s], presentState);
+        }
+        presentTime += timeStep;
+        callback(it, presentState);
+    }
+    return presentState;
+}
+
+template <positiveIntegerType numberOfStages, typename explicitFunctionType, typename implicitFunctionType,
+          typename jacobianType, ScalarConcept valueType = scalarType>
+using ARKSolver = AdditiveRungeKuttaSolver<numberOfStages, explicitFunctionType, implicitFunctionType, jacobianType, valueType>;
+
+} // end namespace zlab
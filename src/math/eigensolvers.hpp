@@ -0,0 +1,382 @@
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <optional>
+#include <numeric>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cmath>
+
+#include "matrix.hpp"
+#include "matrix_decomposition.hpp"
+#include "core.hpp"
+
+namespace zlab{
+
+template <typename matrixType>
+struct SymmetricEigendecomposition {
+    BasicZVector<MatrixValueType<matrixType>> eigenvalues;
+    matrixType eigenvectors;
+};
+
+// SYMMETRIC TRIDIAGONAL QL (Implicitly Shifted QL Iteration)
+// This function overwrites diagonal with the eigenvalues of the symmetric
+// tridiagonal matrix whose off-diagonal entry subdiagonal[i] couples rows i and
+// i + 1 (the last entry is ignored and destroyed). Every plane rotation is also
+// applied to rows i and i + 1 of Zt, so starting from Zt = Q^T the rows of Zt end
+// up as the eigenvectors of Q * T * Q^T. Eigenvalues are not sorted.
+template <RealMatrixConcept matrixType>
+void symmetric_tridiagonal_ql(
+    BasicZVector<MatrixValueType<matrixType>>& diagonal,
+    BasicZVector<MatrixValueType<matrixType>>& subdiagonal,
+    matrixType& Zt,
+    positiveIntegerType maximumIterations = 30)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto& d = diagonal;
+    auto& e = subdiagonal;
+    integerType n = d.size();
+    assert(e.size() == d.size() && Zt.get_number_of_rows() == d.size());
+    e[n - 1] = 0;
+    auto epsilon = std::numeric_limits<valueType>::epsilon();
+    auto rotate_rows = [&Zt](integerType i, valueType c, valueType s){
+        for(positiveIntegerType k=0; k < Zt.get_number_of_columns(); ++k){
+            auto f = Zt(i + 1, k);
+            Zt(i + 1, k) = s * Zt(i, k) + c * f;
+            Zt(i, k) = c * Zt(i, k) - s * f;
+        }
+    };
+    for(integerType l=0; l < n; ++l){
+        positiveIntegerType iteration = 0;
+        integerType m;
+        do {
+            for(m=l; m < n - 1; ++m){
+                auto scale = std::abs(d[m]) + std::abs(d[m + 1]);
+                if (std::abs(e[m]) <= epsilon * scale) break;
+            }
+            if (m == l) break;
+            if (iteration++ == maximumIterations) {
+                throw std::runtime_error("Eigensolver: No convergence in the tridiagonal QL iteration.");
+            }
+            auto g = (d[l + 1] - d[l]) / (2 * e[l]);
+            auto r = std::hypot(g, valueType{1});
+            g = d[m] - d[l] + e[l] / (g + std::copysign(r, g));
+            valueType s{1}, c{1}, p{0};
+            integerType i = m - 1;
+            for(; i >= l; --i){
+                auto f = s * e[i];
+                auto b = c * e[i];
+                r = std::hypot(f, g);
+                e[i + 1] = r;
+                if (r == 0) {
+                    // Underflow: deflate and restart the sweep.
+                    d[i + 1] -= p;
+                    e[m] = 0;
+                    break;
+                }
+                s = f / r;
+                c = g / r;
+                g = d[i + 1] - p;
+                r = (d[i] - g) * s + 2 * c * b;
+                p = s * r;
+                d[i + 1] = g + p;
+                g = c * r - b;
+                rotate_rows(i, c, s);
+            }
+            if (r == 0 && i >= l) continue;
+            d[l] -= p;
+            e[l] = g;
+            e[m] = 0;
+        } while (m != l);
+    }
+}
+
+// SYMMETRIC EIGENDECOMPOSITION
+// This function computes A = V * diag(eigenvalues) * V^T for a symmetric A, with
+// the eigenvalues in ascending order and the eigenvectors as columns of V. Only
+// the lower triangle of A is read. A is reduced to tridiagonal form with blocked
+// Householder transformations: each panel builds the matrix W of the LATRD
+// scheme so that the trailing matrix is updated with two GEMMs,
+// A22 -= V * W^T + W * V^T. The tridiagonal matrix is diagonalized by implicitly
+// shifted QL sweeps.
+template <RealMatrixConcept matrixType>
+SymmetricEigendecomposition<OwnedMatrix<matrixType>> symmetric_eigendecomposition(
+    const matrixType& data,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto n = data.get_number_of_rows();
+    ZLAB_INSTRUMENT("symmetric_eigendecomposition", 9.0 * n * n * n, sizeof(valueType) * 4.0 * n * n);
+    assert(n == data.get_number_of_columns());
+    assert(blockSize > 0);
+    // The reduction keeps the whole trailing matrix symmetric so that the
+    // symmetric matrix-vector products can run over contiguous rows.
+    auto A = copy_matrix(data);
+    for(positiveIntegerType i=0; i < n; ++i){
+        for(auto j=i+1; j < n; ++j){
+            A(i,j) = A(j,i);
+        }
+    }
+    BasicZVector<valueType> d(n), e(n), tau(n);
+
+    for(positiveIntegerType k0=0; k0 + 1 < n; k0 += blockSize){
+        auto trailingOrder = n - k0;
+        auto panelWidth = std::min(blockSize, trailingOrder - 1);
+        // W(r, i) belongs to global row k0 + r; a(r, c) is A(k0 + r, k0 + c).
+        BasicZMatrix<valueType> W(trailingOrder, panelWidth);
+        auto a = [&A, k0](positiveIntegerType r, positiveIntegerType c) -> valueType& { return A(k0 + r, k0 + c); };
+        std::vector<valueType> correction(panelWidth);
+        for(positiveIntegerType i=0; i < panelWidth; ++i){
+            // Bring column i up to date with the reflectors already in the panel.
+            for(auto r=i; r < trailingOrder; ++r){
+                valueType sum{0};
+                for(positiveIntegerType p=0; p < i; ++p){
+                    sum += a(r,p) * W(i,p) + W(r,p) * a(i,p);
+                }
+                a(r,i) -= sum;
+            }
+            tau[k0 + i] = householder_reflector(A, k0 + i + 1, k0 + i);
+            e[k0 + i] = a(i + 1, i);
+            a(i + 1, i) = 1;
+            auto tauI = tau[k0 + i];
+            parallel_for(i + 1, trailingOrder, [&](positiveIntegerType first, positiveIntegerType last){
+                for(auto r=first; r < last; ++r){
+                    valueType sum{0};
+                    for(auto c=i+1; c < trailingOrder; ++c){
+                        sum += a(r,c) * a(c,i);
+                    }
+                    W(r,i) = sum;
+                }
+            }, grain_size(trailingOrder - i));
+            if (i > 0) {
+                for(positiveIntegerType p=0; p < i; ++p){
+                    valueType sum{0};
+                    for(auto r=i+1; r < trailingOrder; ++r){
+                        sum += W(r,p) * a(r,i);
+                    }
+                    correction[p] = sum;
+                }
+                for(auto r=i+1; r < trailingOrder; ++r){
+                    valueType sum{0};
+                    for(positiveIntegerType p=0; p < i; ++p){
+                        sum += a(r,p) * correction[p];
+                    }
+                    W(r,i) -= sum;
+                }
+                for(positiveIntegerType p=0; p < i; ++p){
+                    valueType sum{0};
+                    for(auto r=i+1; r < trailingOrder; ++r){
+                        sum += a(r,p) * a(r,i);
+                    }
+                    correction[p] = sum;
+                }
+                for(auto r=i+1; r < trailingOrder; ++r){
+                    valueType sum{0};
+                    for(positiveIntegerType p=0; p < i; ++p){
+                        sum += W(r,p) * correction[p];
+                    }
+                    W(r,i) -= sum;
+                }
+            }
+            valueType projection{0};
+            for(auto r=i+1; r < trailingOrder; ++r){
+                W(r,i) *= tauI;
+                projection += W(r,i) * a(r,i);
+            }
+            auto alpha = -valueType{0.5} * tauI * projection;
+            for(auto r=i+1; r < trailingOrder; ++r){
+                W(r,i) += alpha * a(r,i);
+            }
+        }
+        auto trailingStart = k0 + panelWidth;
+        auto numberOfTrailingRows = n - trailingStart;
+        if (numberOfTrailingRows > 0) {
+            auto V = A.block_view(trailingStart, k0, numberOfTrailingRows, panelWidth);
+            auto trailingW = W.block_view(panelWidth, 0, numberOfTrailingRows, panelWidth);
+            auto trailing = A.block_view(trailingStart, trailingStart, numberOfTrailingRows, numberOfTrailingRows);
+            gemm(V, trailingW, trailing, -1, 1, false, true);
+            gemm(trailingW, V, trailing, -1, 1, false, true);
+        }
+        for(positiveIntegerType i=0; i < panelWidth; ++i){
+            d[k0 + i] = a(i,i);
+            a(i + 1, i) = e[k0 + i];
+        }
+    }
+    d[n - 1] = A(n - 1, n - 1);
+
+    // Zt = Q^T = H(n-2) * ... * H(0), built by applying the reflectors to rows.
+    OwnedMatrix<matrixType> Zt(n, n);
+    for(positiveIntegerType i=0; i < n; ++i){
+        Zt(i,i) = 1;
+    }
+    auto reflector = n > 1 ? n - 1 : 0;
+    while (reflector > 0) {
+        --reflector;
+        auto tauK = tau[reflector];
+        if (tauK == 0) continue;
+        auto first = reflector + 1;
+        parallel_for(0, n, [&](positiveIntegerType firstRow, positiveIntegerType lastRow){
+            for(auto r=firstRow; r < lastRow; ++r){
+                auto sum = Zt(r, first);
+                for(auto c=first+1; c < n; ++c){
+                    sum += Zt(r,c) * A(c, reflector);
+                }
+                sum *= tauK;
+                Zt(r, first) -= sum;
+                for(auto c=first+1; c < n; ++c){
+                    Zt(r,c) -= sum * A(c, reflector);
+                }
+            }
+        }, grain_size(n - first));
+    }
+
+    symmetric_tridiagonal_ql(d, e, Zt);
+
+    std::vector<positiveIntegerType> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&d](auto i, auto j){ return d[i] < d[j]; });
+    BasicZVector<valueType> eigenvalues(n);
+    OwnedMatrix<matrixType> eigenvectors(n, n);
+    for(positiveIntegerType j=0; j < n; ++j){
+        eigenvalues[j] = d[order[j]];
+        for(positiveIntegerType i=0; i < n; ++i){
+            eigenvectors(i,j) = Zt(order[j], i);
+        }
+    }
+    return {std::move(eigenvalues), std::move(eigenvectors)};
+}
+
+enum class SpectrumEnd { Largest, Smallest };
+
+// LANCZOS (Extremal Eigenpairs of a Symmetric Operator)
+// This function computes the numberOfEigenpairs largest or smallest eigenpairs of
+// a symmetric operator given only through apply(x, y), which must set y = A * x.
+// Each new Krylov vector is fully reorthogonalized (two Gram-Schmidt passes with
+// dot/axpy) and the projection coefficients form H = Q^T * A * Q. When the basis
+// reaches maximumBasisSize the iteration is thick-restarted: the best Ritz vectors
+// are kept, H becomes diagonal plus the coupling to the residual, and the
+// expansion continues. A Ritz pair is accepted when its residual estimate
+// |beta * y_last| falls below tolerance * max(|theta|, 1).
+template <typename operatorType>
+SymmetricEigendecomposition<ZMatrix> lanczos(
+    const operatorType& apply,
+    positiveIntegerType order,
+    positiveIntegerType numberOfEigenpairs,
+    SpectrumEnd spectrumEnd = SpectrumEnd::Largest,
+    std::optional<positiveIntegerType> maximumBasisSizeOption = std::nullopt,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType maximumRestarts = 100,
+    std::uint64_t seed = 0)
+{
+    // The operator is opaque, so only the time and the calls are recorded.
+    ZLAB_INSTRUMENT("lanczos", 0, 0);
+    assert(numberOfEigenpairs > 0 && numberOfEigenpairs <= order);
+    auto defaultBasisSize = std::max<positiveIntegerType>(2 * numberOfEigenpairs + 20, 40);
+    auto maximumBasisSize = std::min(order, maximumBasisSizeOption.value_or(defaultBasisSize));
+    assert(maximumBasisSize > numberOfEigenpairs || maximumBasisSize == order);
+    auto tolerance = std::sqrt(evaluate_safe_tolerance(marginOfError));
+    auto numberOfKeptVectors = std::min(numberOfEigenpairs + (maximumBasisSize - numberOfEigenpairs) / 2, maximumBasisSize - 1);
+
+    std::vector<ZVector> basis;
+    basis.reserve(maximumBasisSize);
+    ZVector w(order);
+    std::mt19937_64 generator(seed);
+    std::normal_distribution<scalarType> gaussian;
+    for(positiveIntegerType i=0; i < order; ++i){
+        w[i] = gaussian(generator);
+    }
+    scale(w, 1 / norm(w));
+    basis.push_back(w.copy());
+    ZMatrix H(maximumBasisSize, maximumBasisSize);
+
+    positiveIntegerType restart = 0;
+    for(positiveIntegerType j=0; ; ++j){
+        apply(basis[j], w);
+        for(positiveIntegerType pass=0; pass < 2; ++pass){
+            for(positiveIntegerType i=0; i <= j; ++i){
+                auto projection = dot(basis[i], w);
+                H(i,j) += projection;
+                axpy(-projection, basis[i], w);
+            }
+        }
+        auto beta = norm(w);
+        auto basisSize = j + 1;
+
+        // Rayleigh-Ritz on the projected matrix, read from its upper triangle.
+        ZMatrix T(basisSize, basisSize);
+        for(positiveIntegerType r=0; r < basisSize; ++r){
+            for(positiveIntegerType c=0; c <= r; ++c){
+                T(r,c) = H(c,r);
+            }
+        }
+        auto [ritzValues, ritzVectors] = symmetric_eigendecomposition(T);
+        auto wanted = [&, basisSize](positiveIntegerType k){
+            return spectrumEnd == SpectrumEnd::Largest ? basisSize - 1 - k : k;
+        };
+        auto isInvariant = beta <= evaluate_safe_tolerance(marginOfError) * std::max(std::abs(ritzValues[wanted(0)]), scalarType{1});
+        bool isConverged = basisSize >= numberOfEigenpairs;
+        for(positiveIntegerType k=0; isConverged && k < numberOfEigenpairs; ++k){
+            auto residual = std::abs(beta * ritzVectors(basisSize - 1, wanted(k)));
+            isConverged = residual <= tolerance * std::max(std::abs(ritzValues[wanted(k)]), scalarType{1});
+        }
+        if (isInvariant && basisSize < numberOfEigenpairs) {
+            throw std::runtime_error("Lanczos: Krylov space is smaller than the number of requested eigenpairs.");
+        }
+        auto ritz_vector = [&](positiveIntegerType column){
+            ZVector x(order);
+            for(positiveIntegerType i=0; i < basisSize; ++i){
+                axpy(ritzVectors(i, column), basis[i], x);
+            }
+            return x;
+        };
+        if (isConverged || isInvariant) {
+            ZVector eigenvalues(numberOfEigenpairs);
+            ZMatrix eigenvectors(order, numberOfEigenpairs);
+            for(positiveIntegerType k=0; k < numberOfEigenpairs; ++k){
+                eigenvalues[k] = ritzValues[wanted(k)];
+                auto x = ritz_vector(wanted(k));
+                for(positiveIntegerType i=0; i < order; ++i){
+                    eigenvectors(i,k) = x[i];
+                }
+            }
+            return {std::move(eigenvalues), std::move(eigenvectors)};
+        }
+        if (basisSize == maximumBasisSize) {
+            if (restart++ == maximumRestarts) {
+                throw std::runtime_error("Lanczos: No convergence within the maximum number of restarts.");
+            }
+            std::vector<ZVector> keptVectors;
+            keptVectors.reserve(maximumBasisSize);
+            H.fill(0);
+            for(positiveIntegerType k=0; k < numberOfKeptVectors; ++k){
+                keptVectors.push_back(ritz_vector(wanted(k)));
+                H(k,k) = ritzValues[wanted(k)];
+            }
+            basis = std::move(keptVectors);
+            j = numberOfKeptVectors - 1;
+        }
+        scale(w, 1 / beta);
+        basis.push_back(w.copy());
+    }
+}
+
+// LANCZOS (Explicit Symmetric Matrix)
+// This function runs lanczos with y = A * x evaluated by gemv.
+template <MatrixConcept matrixType>
+SymmetricEigendecomposition<ZMatrix> lanczos(
+    const matrixType& A,
+    positiveIntegerType numberOfEigenpairs,
+    SpectrumEnd spectrumEnd = SpectrumEnd::Largest,
+    std::optional<positiveIntegerType> maximumBasisSize = std::nullopt,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    assert(A.get_number_of_rows() == A.get_number_of_columns());
+    auto apply = [&A](const ZVector& x, ZVector& y){ gemv(A, x, y, 1, 0, false); };
+    return lanczos(apply, A.get_number_of_rows(), numberOfEigenpairs, spectrumEnd, maximumBasisSize, marginOfError);
+}
+
+} // end namespace zlab
@@ -4,6 +4,15 @@
 #include "rbf.hpp"
 #include "utilities.hpp"
 #include "matrix.hpp"
+#include "triangular_solve.hpp"
 #include "ode.hpp"
+#include "ode_adjoint.hpp"
 #include "matrix_decomposition.hpp"
 #include "solvers.hpp"
+#include "additive_runge_kutta.hpp"
+#include "qr_update.hpp"
+#include "svd.hpp"
+#include "regularization.hpp"
+#include "nonlinear_least_squares.hpp"
+#include "eigensolvers.hpp"
+#include "matrix_io.hpp"
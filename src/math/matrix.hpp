@@ -1,10 +1,15 @@
 
 #pragma once
 
+#include <memory_resource>
 #include <stdexcept>
+#include <type_traits>
 #include <concepts>
 #include <cassert>
+#include <iostream>
 #include <limits>
+#include <algorithm>
+#include <utility>
 #include <vector>
 #include <span>
 
@@ -13,81 +18,393 @@
 
 namespace zlab{
 
-class ColumnView;
+// MATRIX VIEW
+// A non-owning view of a strided matrix: element (i, j) is stored at
+// data()[i * rowStride + j * columnStride]. elementType is a scalar type for a
+// mutable view and its const version for a read-only one, and a mutable view
+// converts to a read-only one. Views wrap external buffers (NumPy, Arrow, mmap)
+// without copying, are cheap to pass by value and never allocate; the viewed
+// storage must outlive them.
+template <typename elementType>
+class BasicVectorView;
 
-class ZMatrix{
+template <typename elementType>
+class BasicMatrixView{
     private:
-        std::vector<scalarType> data;
+        elementType* pointer;
+        positiveIntegerType numberOfRows;
+        positiveIntegerType numberOfColumns;
+        positiveIntegerType rowStride;
+        positiveIntegerType columnStride;
+    public:
+        BasicMatrixView() = delete;
+        BasicMatrixView(
+            elementType* pointer,
+            positiveIntegerType numberOfRows,
+            positiveIntegerType numberOfColumns,
+            positiveIntegerType rowStride,
+            positiveIntegerType columnStride=1) :
+            pointer(pointer),
+            numberOfRows(numberOfRows),
+            numberOfColumns(numberOfColumns),
+            rowStride(rowStride),
+            columnStride(columnStride) {
+            assert(pointer != nullptr);
+        }
+        BasicMatrixView(elementType* pointer, positiveIntegerType numberOfRows, positiveIntegerType numberOfColumns) :
+            BasicMatrixView(pointer, numberOfRows, numberOfColumns, numberOfColumns, 1) {}
+        template <typename otherElementType>
+            requires (std::is_same_v<const otherElementType, elementType> && !std::is_same_v<otherElementType, elementType>)
+        BasicMatrixView(const BasicMatrixView<otherElementType>& view) :
+            BasicMatrixView(view.data(), view.get_number_of_rows(), view.get_number_of_columns(),
+                            view.get_row_stride(), view.get_column_stride()) {}
+
+        elementType& operator()(integerType row, integerType column) const {
+            assert(row < numberOfRows && column < numberOfColumns);
+            return pointer[row * rowStride + column * columnStride];
+        }
+
+        BasicMatrixView block_view(integerType rowOffset, integerType columnOffset, integerType rows, integerType columns) const {
+            assert(rowOffset > -1 && columnOffset > -1);
+            assert(rowOffset + rows <= numberOfRows && columnOffset + columns <= numberOfColumns);
+            return {pointer + rowOffset * rowStride + columnOffset * columnStride, positiveIntegerType(rows), positiveIntegerType(columns), rowStride, columnStride};
+        }
+        BasicMatrixView transpose() const {
+            return {pointer, numberOfColumns, numberOfRows, columnStride, rowStride};
+        }
+        BasicVectorView<elementType> row_view(integerType row) const {
+            assert(row < numberOfRows);
+            return {pointer + row * rowStride, numberOfColumns, columnStride};
+        }
+        BasicVectorView<elementType> column_view(integerType column) const {
+            assert(column < numberOfColumns);
+            return {pointer + column * columnStride, numberOfRows, rowStride};
+        }
+
+        elementType* data() const { return pointer; }
+        positiveIntegerType get_number_of_rows() const { return numberOfRows; }
+        positiveIntegerType get_number_of_columns() const { return numberOfColumns; }
+        positiveIntegerType get_row_stride() const { return rowStride; }
+        positiveIntegerType get_column_stride() const { return columnStride; }
+};
+
+// VECTOR VIEW
+// A non-owning view of a strided vector: element i is stored at data()[i * stride].
+template <typename elementType>
+class BasicVectorView{
+    private:
+        elementType* pointer;
+        positiveIntegerType numberOfElements;
+        positiveIntegerType stride;
+    public:
+        BasicVectorView() = delete;
+        BasicVectorView(elementType* pointer, positiveIntegerType numberOfElements, positiveIntegerType stride=1) :
+            pointer(pointer),
+            numberOfElements(numberOfElements),
+            stride(stride) {
+            assert(pointer != nullptr);
+        }
+        template <typename otherElementType>
+            requires (std::is_same_v<const otherElementType, elementType> && !std::is_same_v<otherElementType, elementType>)
+        BasicVectorView(const BasicVectorView<otherElementType>& view) :
+            BasicVectorView(view.data(), view.size(), view.get_stride()) {}
+
+        elementType& operator[](integerType i) const {
+            assert(i < numberOfElements);
+            return pointer[i * stride];
+        }
+
+        BasicVectorView subvector_view(integerType offset, integerType size) const {
+            assert(offset > -1 && offset + size <= numberOfElements);
+            return {pointer + offset * stride, positiveIntegerType(size), stride};
+        }
+
+        elementType* data() const { return pointer; }
+        positiveIntegerType size() const { return numberOfElements; }
+        positiveIntegerType get_stride() const { return stride; }
+};
+
+using ZMatrixView = BasicMatrixView<scalarType>;
+using ConstZMatrixView = BasicMatrixView<const scalarType>;
+using ZVectorView = BasicVectorView<scalarType>;
+using ConstZVectorView = BasicVectorView<const scalarType>;
+
+// MATRIX
+// A dense row-major matrix that owns its elements. valueType is any ScalarConcept
+// type; ZMatrix is the scalarType instantiation used throughout the library.
+template <ScalarConcept valueType_>
+class BasicZMatrix{
+    private:
+        std::pmr::vector<valueType_> elements;
         positiveIntegerType numberOfRows;
         positiveIntegerType numberOfColumns;
         
         positiveIntegerType compute_vector_index(integerType, integerType) const;
     public:
-        ZMatrix() = delete;
-        ZMatrix(const ZMatrix&) = delete;
-        ZMatrix(ZMatrix&&) noexcept;
-        ZMatrix(integerType, integerType, scalarType=0);
-        virtual ~ZMatrix() = default;
-        ZMatrix& operator=(const ZMatrix&);
-        ZMatrix& operator=(ZMatrix&&) noexcept;
+        using valueType = valueType_;
+
+        BasicZMatrix() = delete;
+        BasicZMatrix(const BasicZMatrix&) = delete;
+        BasicZMatrix(BasicZMatrix&&) noexcept;
+        BasicZMatrix(integerType, integerType, valueType=0, std::pmr::memory_resource* = nullptr);
+        virtual ~BasicZMatrix() = default;
+        BasicZMatrix& operator=(const BasicZMatrix&);
+        BasicZMatrix& operator=(BasicZMatrix&&) noexcept;
         
-        ZMatrix copy() const;
+        BasicZMatrix copy() const;
         
-        void fill(scalarType);
+        void fill(valueType);
         
-        scalarType& operator()(integerType, integerType);
-        const scalarType& operator()(integerType, integerType) const;
+        valueType& operator()(integerType, integerType);
+        const valueType& operator()(integerType, integerType) const;
         
-        std::span<scalarType> row_view(integerType);
-        ColumnView column_view(integerType);
+        std::span<valueType> row_view(integerType);
+        BasicVectorView<valueType> column_view(integerType);
+        BasicVectorView<const valueType> column_view(integerType) const;
+        BasicMatrixView<valueType> block_view(integerType, integerType, integerType, integerType);
+        BasicMatrixView<const valueType> block_view(integerType, integerType, integerType, integerType) const;
+        BasicMatrixView<valueType> view();
+        BasicMatrixView<const valueType> view() const;
 
+        valueType* data() { return elements.data(); }
+        const valueType* data() const { return elements.data(); }
         positiveIntegerType get_number_of_rows() const { return numberOfRows; }
         positiveIntegerType get_number_of_columns() const { return numberOfColumns; }
         positiveIntegerType get_number_of_elements() const;
+        std::pmr::memory_resource* get_memory_resource() const { return elements.get_allocator().resource(); }
         
         void print() const;
 };
 
-ZMatrix identity_matrix(integerType);
-
-class ColumnView {
+template <ScalarConcept valueType_>
+class BasicZVector {
     private:
-        ZMatrix& matrix;
-        positiveIntegerType columnIndex;
+        BasicZMatrix<valueType_> matrix;
     public:
-        ColumnView(ZMatrix&, integerType);
-        scalarType& operator[](integerType);
-        const scalarType& operator[](integerType) const;
-        positiveIntegerType size() const { return matrix.get_number_of_rows(); }
-};
+        using valueType = valueType_;
 
-class ZVector {
-    private:
-        ZMatrix matrix;
-    public:
-        ZVector() = delete;
-        ZVector(const ZVector&) = delete;
-        ZVector(ZVector&&);
-        ZVector(integerType, scalarType=0);
-        virtual ~ZVector() = default;
-        ZVector& operator=(const ZVector&);
-        ZVector& operator=(ZVector&&);
+        BasicZVector() = delete;
+        BasicZVector(const BasicZVector&) = delete;
+        BasicZVector(BasicZVector&&);
+        BasicZVector(integerType, valueType=0, std::pmr::memory_resource* = nullptr);
+        virtual ~BasicZVector() = default;
+        BasicZVector& operator=(const BasicZVector&);
+        BasicZVector& operator=(BasicZVector&&);
         
-        ZVector copy() const;
+        BasicZVector copy() const;
         
-        void fill(scalarType);
+        void fill(valueType);
+
+        BasicZVector& operator=(const std::span<valueType>);
+        BasicZVector& operator=(const BasicVectorView<const valueType>&);
 
-        ZVector& operator=(const std::span<scalarType>);
-        ZVector& operator=(const ColumnView&);
+        valueType& operator[](integerType i) { return matrix(i,0); }
+        const valueType& operator[](integerType i) const { return matrix(i, 0); }
 
-        scalarType& operator[](integerType i) { return matrix(i,0); }
-        const scalarType& operator[](integerType i) const { return matrix(i, 0); }
+        BasicVectorView<valueType> view() { return {matrix.data(), size()}; }
+        BasicVectorView<const valueType> view() const { return {matrix.data(), size()}; }
 
+        valueType* data() { return matrix.data(); }
+        const valueType* data() const { return matrix.data(); }
         positiveIntegerType size() const{ return matrix.get_number_of_rows(); }
         
         void print() const { matrix.print(); };
 };
 
+using ZMatrix = BasicZMatrix<scalarType>;
+using ZVector = BasicZVector<scalarType>;
+
+template <ScalarConcept valueType>
+BasicZMatrix<valueType>::BasicZMatrix(BasicZMatrix&& matrix) noexcept :
+    elements(std::move(matrix.elements)), numberOfRows(matrix.numberOfRows), numberOfColumns(matrix.numberOfColumns) {
+    matrix.numberOfRows = 0;
+    matrix.numberOfColumns = 0;
+}
+
+template <ScalarConcept valueType>
+BasicZMatrix<valueType>::BasicZMatrix(
+    integerType numberOfRows, 
+    integerType numberOfColumns,
+    valueType fillValue,
+    std::pmr::memory_resource* resource) : 
+    elements(numberOfRows * numberOfColumns, fillValue, resource ? resource : get_matrix_memory_resource()),
+    numberOfRows(numberOfRows), 
+    numberOfColumns(numberOfColumns) {
+    assert(numberOfRows > 0 && numberOfColumns > 0);
+}
+
+template <ScalarConcept valueType>
+BasicZMatrix<valueType>& BasicZMatrix<valueType>::operator=(const BasicZMatrix& matrix){
+    if (this == &matrix) return *this;
+    assert(matrix.numberOfColumns == numberOfColumns && matrix.numberOfRows == numberOfRows);
+    elements = matrix.elements;
+    return *this;
+}
+
+template <ScalarConcept valueType>
+BasicZMatrix<valueType>& BasicZMatrix<valueType>::operator=(BasicZMatrix&& matrix) noexcept {
+    assert(matrix.numberOfColumns == numberOfColumns && matrix.numberOfRows == numberOfRows);
+    elements = std::move(matrix.elements);
+    matrix.numberOfRows = 0;
+    matrix.numberOfColumns = 0;
+    return *this;
+}
+
+template <ScalarConcept valueType>
+BasicZMatrix<valueType> BasicZMatrix<valueType>::copy() const {
+    BasicZMatrix clone(numberOfRows, numberOfColumns);
+    clone.elements = elements;
+    return clone;
+}
+
+template <ScalarConcept valueType>
+positiveIntegerType BasicZMatrix<valueType>::compute_vector_index(integerType row, integerType column) const {
+    assert(row < numberOfRows && column < numberOfColumns);
+    return row * numberOfColumns + column;
+}
+
+template <ScalarConcept valueType>
+valueType& BasicZMatrix<valueType>::operator()(integerType row, integerType column) {
+    return elements[compute_vector_index(row,column)];
+}
+
+template <ScalarConcept valueType>
+const valueType& BasicZMatrix<valueType>::operator()(integerType row, integerType column) const {
+    return elements[compute_vector_index(row,column)];
+}
+
+template <ScalarConcept valueType>
+std::span<valueType> BasicZMatrix<valueType>::row_view(integerType rowIndex) {
+    assert(rowIndex < numberOfRows && rowIndex > -1);
+    valueType* rowStartPointer = elements.data() + (rowIndex * numberOfColumns);
+    return std::span<valueType>(rowStartPointer, numberOfColumns);
+}
+
+template <ScalarConcept valueType>
+BasicVectorView<valueType> BasicZMatrix<valueType>::column_view(integerType columnIndex) {
+    return view().column_view(columnIndex);
+}
+
+template <ScalarConcept valueType>
+BasicVectorView<const valueType> BasicZMatrix<valueType>::column_view(integerType columnIndex) const {
+    return view().column_view(columnIndex);
+}
+
+template <ScalarConcept valueType>
+BasicMatrixView<valueType> BasicZMatrix<valueType>::block_view(
+    integerType rowOffset,
+    integerType columnOffset,
+    integerType numberOfRows,
+    integerType numberOfColumns) {
+    return view().block_view(rowOffset, columnOffset, numberOfRows, numberOfColumns);
+}
+
+template <ScalarConcept valueType>
+BasicMatrixView<const valueType> BasicZMatrix<valueType>::block_view(
+    integerType rowOffset,
+    integerType columnOffset,
+    integerType numberOfRows,
+    integerType numberOfColumns) const {
+    return view().block_view(rowOffset, columnOffset, numberOfRows, numberOfColumns);
+}
+
+template <ScalarConcept valueType>
+BasicMatrixView<valueType> BasicZMatrix<valueType>::view() {
+    return {elements.data(), numberOfRows, numberOfColumns};
+}
+
+template <ScalarConcept valueType>
+BasicMatrixView<const valueType> BasicZMatrix<valueType>::view() const {
+    return {elements.data(), numberOfRows, numberOfColumns};
+}
+
+template <ScalarConcept valueType>
+positiveIntegerType BasicZMatrix<valueType>::get_number_of_elements() const{
+    return numberOfRows*numberOfColumns;
+}
+
+template <ScalarConcept valueType>
+void BasicZMatrix<valueType>::print() const {
+    using int_ = positiveIntegerType;
+    for(int_ row=0; row < numberOfRows; row++){
+        for(int_ column=0; column < numberOfColumns; column++){
+            std::cout << (*this)(row,column);
+            std::cout << (column < numberOfColumns - 1 ? " " : "\n");
+        }
+    }
+}
+
+template <ScalarConcept valueType>
+void BasicZMatrix<valueType>::fill(valueType fillValue) {
+    std::ranges::fill(elements, fillValue);
+}
+
+// IDENTITY MATRIX
+// This function returns the identity matrix of the given order.
+template <ScalarConcept valueType = scalarType>
+BasicZMatrix<valueType> identity_matrix(integerType numberOfRows){
+    assert(numberOfRows > 0);
+    auto numberOfColumns = numberOfRows;
+    BasicZMatrix<valueType> identity_matrix(numberOfRows, numberOfColumns);
+    for(auto i=0; i < numberOfRows; ++i){
+        identity_matrix(i,i) = 1;
+    }
+    return identity_matrix;
+}
+
+template <ScalarConcept valueType>
+BasicZVector<valueType>::BasicZVector(BasicZVector&& v) : matrix(std::move(v.matrix)) {}
+
+template <ScalarConcept valueType>
+BasicZVector<valueType>::BasicZVector(integerType size, valueType fillValue, std::pmr::memory_resource* resource) :
+    matrix(size, 1, fillValue, resource) {}
+
+template <ScalarConcept valueType>
+BasicZVector<valueType>& BasicZVector<valueType>::operator=(const BasicZVector& v) {
+    if (this == &v) return *this;
+    matrix = v.matrix;
+    return *this;
+}
+
+template <ScalarConcept valueType>
+BasicZVector<valueType>& BasicZVector<valueType>::operator=(BasicZVector&& v) {
+    matrix = std::move(v.matrix);
+    return *this;
+}
+
+template <ScalarConcept valueType>
+BasicZVector<valueType> BasicZVector<valueType>::copy() const {
+    BasicZVector clone(size());
+    clone.matrix = matrix;
+    return clone;
+}
+
+template <ScalarConcept valueType>
+void BasicZVector<valueType>::fill(valueType fillValue) {
+    matrix.fill(fillValue);
+}
+
+template <ScalarConcept valueType>
+BasicZVector<valueType>& BasicZVector<valueType>::operator=(const std::span<valueType> view){
+    assert(view.size() == size());
+    for(auto i=0; i < view.size(); ++i){
+        (*this)[i] = view[i];
+    }
+    return *this;
+}
+
+template <ScalarConcept valueType>
+BasicZVector<valueType>& BasicZVector<valueType>::operator=(const BasicVectorView<const valueType>& view){
+    assert(view.size() == size());
+    for(auto i=0; i < view.size(); ++i){
+        (*this)[i] = view[i];
+    }
+    return *this;
+}
+
+extern template class BasicZMatrix<scalarType>;
+extern template class BasicZVector<scalarType>;
+
 // VECTOR CONCEPT
 // This concept enforces that a type must behave like a standard vector,
 // requiring size access (v.size()) and indexed element access (v[i]).
@@ -97,10 +414,16 @@ concept VectorConcept = requires(const vectorType v, positiveIntegerType i) {
     v[i];
 };
 
+// VECTOR VALUE TYPE
+// The element type of a vector with references and const removed. Kernels use it
+// for their scalar arguments and accumulators.
+template <typename vectorType>
+using VectorValueType = std::remove_cvref_t<decltype(std::declval<const vectorType&>()[0])>;
+
 // AXPY (General Vector Scaling and Addition)
 // This function computes the operation y = y + a * x for two vectors and a scalar.
 template <VectorConcept vectorTypeX, VectorConcept vectorTypeY>
-void axpy(scalarType a, const vectorTypeX& x, vectorTypeY& y){
+void axpy(VectorValueType<vectorTypeY> a, const vectorTypeX& x, vectorTypeY& y){
     assert(x.size() == y.size());
     for(auto i=0; i < x.size(); i++){
         y[i] +=  a * x[i];
@@ -110,7 +433,7 @@ void axpy(scalarType a, const vectorTypeX& x, vectorTypeY& y){
 // AXPBY (General Vector Scaling and Addition)
 // This function computes the operation y = a * x + b * y for two vectors and two scalars.
 template <VectorConcept vectorTypeX, VectorConcept vectorTypeY>
-void axpby(scalarType a, const vectorTypeX& x, scalarType b, vectorTypeY& y){
+void axpby(VectorValueType<vectorTypeY> a, const vectorTypeX& x, VectorValueType<vectorTypeY> b, vectorTypeY& y){
     assert(x.size() == y.size());
     for(auto i=0; i < x.size(); i++){
         y[i] =  a * x[i] + b * y[i];
@@ -120,7 +443,7 @@ void axpby(scalarType a, const vectorTypeX& x, scalarType b, vectorTypeY& y){
 // AYPX (General Vector Scaling and Addition)
 // This function computes the operation y = a * y + x for two vectors and a scalar.
 template <VectorConcept vectorTypeX, VectorConcept vectorTypeY>
-void aypx(scalarType a, vectorTypeX& y, const vectorTypeY& x){
+void aypx(VectorValueType<vectorTypeX> a, vectorTypeX& y, const vectorTypeY& x){
     assert(x.size() == y.size());
     for(auto i=0; i < x.size(); i++){
         y[i] = a * y[i] + x[i];
@@ -130,43 +453,105 @@ void aypx(scalarType a, vectorTypeX& y, const vectorTypeY& x){
 // SCALE (General Vector Scaling)
 // This function computes the operation v = a * v for a vector and a scalar.
 template <VectorConcept vectorType>
-void scale(vectorType& v, scalarType a){
+void scale(vectorType& v, VectorValueType<vectorType> a){
     for(auto i=0; i < v.size(); i++){
         v[i] *=  a;
     }
 }
 
-// NORM (Vector Norm/Magnitude Calculation)
-// This function computes the Lp-norm (including L-infinity norm) of a vector.
+// NORM 1 (Sum of Magnitudes)
+// This function computes sum_i |v[i]| as a parallel_sum.
 template <VectorConcept vectorType>
-scalarType norm(vectorType&v, scalarType p=2) {
-    if (p == std::numeric_limits<scalarType>::infinity()) {
-        scalarType max_abs = 0.0;
-        for (auto i=0; i < v.size(); ++i){
-            max_abs = std::max(max_abs, std::abs(v[i]));
+RealType<VectorValueType<vectorType>> norm1(const vectorType& v) {
+    using realType = RealType<VectorValueType<vectorType>>;
+    return parallel_sum<realType>(v.size(), [&v](positiveIntegerType i) -> realType {
+        return std::abs(v[i]);
+    });
+}
+
+// NORM INFINITY (Largest Magnitude)
+// This function computes max_i |v[i]| with a parallel max reduction.
+template <VectorConcept vectorType>
+RealType<VectorValueType<vectorType>> norm_infinity(const vectorType& v) {
+    using realType = RealType<VectorValueType<vectorType>>;
+    return parallel_reduce(0, v.size(), realType{0}, [&v](positiveIntegerType first, positiveIntegerType last){
+        realType max_abs = 0.0;
+        for (auto i=first; i < last; ++i){
+            max_abs = std::max(max_abs, realType(std::abs(v[i])));
         }
         return max_abs;
-    } else if (p > 0){
-        scalarType sumOfPowers{0};
-        for (auto i=0; i < v.size(); ++i){
-            sumOfPowers += zlab::pow(std::abs(v[i]), p);
+    }, [](realType a, realType b){ return std::max(a, b); }, grain_size(1));
+}
+
+// NORM 2 (Euclidean Norm)
+// This function computes the Euclidean norm like nrm2 without its per-element
+// division: the squares are summed unscaled, and only when that sum overflows or
+// falls into the range where squares lose precision to underflow is the sum
+// recomputed with every entry scaled by the largest magnitude.
+template <VectorConcept vectorType>
+RealType<VectorValueType<vectorType>> norm2(const vectorType& v) {
+    using realType = RealType<VectorValueType<vectorType>>;
+    auto squared_magnitude = [](const auto& value) -> realType {
+        if constexpr (ComplexScalarConcept<VectorValueType<vectorType>>) {
+            return std::norm(value);
+        } else {
+            return value * value;
         }
-        return zlab::pow(sumOfPowers, 1.0 / p);
-    } else {
+    };
+    auto sumOfSquares = parallel_sum<realType>(v.size(), [&v, &squared_magnitude](positiveIntegerType i){
+        return squared_magnitude(v[i]);
+    });
+    auto smallestSafeSum = std::numeric_limits<realType>::min() / std::numeric_limits<realType>::epsilon();
+    if (std::isfinite(sumOfSquares) && sumOfSquares >= smallestSafeSum) return std::sqrt(sumOfSquares);
+    auto largestMagnitude = norm_infinity(v);
+    if (largestMagnitude == 0 || !std::isfinite(largestMagnitude)) return largestMagnitude;
+    auto scaledSumOfSquares = parallel_sum<realType>(v.size(), [&v, largestMagnitude](positiveIntegerType i){
+        auto scaled = realType(std::abs(v[i])) / largestMagnitude;
+        return scaled * scaled;
+    });
+    return largestMagnitude * std::sqrt(scaledSumOfSquares);
+}
+
+// NORM (Vector Norm/Magnitude Calculation)
+// This function computes the Lp-norm (including L-infinity norm) of a vector.
+// p = 1, 2 and infinity dispatch to norm1, norm2 and norm_infinity; other integer
+// p up to maximumIntegerNormOrder raise |v[i]| to p by repeated squaring, and only
+// fractional p call std::pow per element. The sums follow the summation mode.
+inline constexpr integerType maximumIntegerNormOrder = 64;
+
+template <VectorConcept vectorType>
+RealType<VectorValueType<vectorType>> norm(const vectorType& v, RealType<VectorValueType<vectorType>> p=2) {
+    using realType = RealType<VectorValueType<vectorType>>;
+    if (p == 2) return norm2(v);
+    if (p == 1) return norm1(v);
+    if (p == std::numeric_limits<realType>::infinity()) return norm_infinity(v);
+    if (!(p > 0)) {
         throw std::invalid_argument("p must be a positive integer (p > 0) or infinity (std::numeric_limits<double>::infinity()).");
     }
+    realType sumOfPowers;
+    if (p == std::round(p) && p <= maximumIntegerNormOrder) {
+        auto integerOrder = static_cast<integerType>(p);
+        sumOfPowers = parallel_sum<realType>(v.size(), [&v, integerOrder](positiveIntegerType i){
+            return realType(zlab::pow(realType(std::abs(v[i])), integerOrder));
+        });
+    } else {
+        sumOfPowers = parallel_sum<realType>(v.size(), [&v, p](positiveIntegerType i){
+            return realType(zlab::pow(realType(std::abs(v[i])), p));
+        });
+    }
+    return zlab::pow(sumOfPowers, 1 / p);
 }
 
 // DOT (Vector Dot Product/Inner Product)
-// This function computes the scalar result of transpose(x) * y.
+// This function computes the scalar result of transpose(x) * y as a parallel_sum,
+// so it follows the summation mode. Complex entries are not conjugated.
 template <VectorConcept vectorTypeX, VectorConcept vectorTypeY>
-scalarType dot(const vectorTypeX& x, const vectorTypeY& y) {
+auto dot(const vectorTypeX& x, const vectorTypeY& y) {
     assert(x.size() == y.size());
-    scalarType result{0};
-    for(auto i=0; i < x.size(); i++){
-        result += x[i] * y[i];
-    }
-    return result;
+    using valueType = std::common_type_t<VectorValueType<vectorTypeX>, VectorValueType<vectorTypeY>>;
+    return parallel_sum<valueType>(x.size(), [&x, &y](positiveIntegerType i) -> valueType {
+        return x[i] * y[i];
+    });
 }
 
 // CROSS (Vector Cross Product)
@@ -191,28 +576,156 @@ concept MatrixConcept = requires(const matrixType m, positiveIntegerType i, posi
     m(i,j);
 };
 
+// MATRIX VALUE TYPE
+// The element type of a matrix with references and const removed. Algorithms use
+// it for their scalar arguments, accumulators and working copies.
+template <typename matrixType>
+using MatrixValueType = std::remove_cvref_t<decltype(std::declval<const matrixType&>()(0, 0))>;
+
+// REAL MATRIX CONCEPT
+// This concept is satisfied by matrices with a real element type. The orthogonal
+// and symmetric factorizations require it because they never conjugate.
+template <typename matrixType>
+concept RealMatrixConcept = MatrixConcept<matrixType> && RealScalarConcept<MatrixValueType<matrixType>>;
+
+// OWNING MATRIX CONCEPT
+// This concept is satisfied by matrices that own their storage: they can be
+// created from a shape and deep-copied with copy().
+template <typename matrixType>
+concept OwningMatrixConcept = MatrixConcept<matrixType> &&
+    std::constructible_from<matrixType, integerType, integerType> &&
+    requires(const matrixType m) {
+        { m.copy() } -> std::same_as<matrixType>;
+    };
+
+// OWNED MATRIX
+// The type algorithms use for working copies and results: the input type when it
+// owns its storage, a BasicZMatrix of the same element type for views such as
+// ZMatrixView or MappedMatrix.
+template <typename matrixType>
+using OwnedMatrix = std::conditional_t<OwningMatrixConcept<matrixType>, matrixType, BasicZMatrix<MatrixValueType<matrixType>>>;
+
+// COPY MATRIX
+// This function returns a deep copy of any matrix as an OwnedMatrix.
+template <MatrixConcept matrixType>
+OwnedMatrix<matrixType> copy_matrix(const matrixType& data){
+    if constexpr (OwningMatrixConcept<matrixType>) {
+        return data.copy();
+    } else {
+        auto numberOfRows = data.get_number_of_rows();
+        auto numberOfColumns = data.get_number_of_columns();
+        OwnedMatrix<matrixType> copy(numberOfRows, numberOfColumns);
+        parallel_for(0, numberOfRows, [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto i=first; i < last; ++i){
+                for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+                    copy(i,j) = data(i,j);
+                }
+            }
+        }, grain_size(numberOfColumns));
+        return copy;
+    }
+}
+
 // GEMM (General Matrix-Matrix Multiplication)
-// This function computes the operation C = a * A * B + b * C for three matrices 
-// and two scalars.
+// This function computes the operation C = a * op(A) * op(B) + b * C for three matrices 
+// and two scalars, where op(M) is M or M^T according to the transpose flags.
+// Rows of C are distributed over the library thread pool.
 template <MatrixConcept matrixTypeA, MatrixConcept matrixTypeB, MatrixConcept matrixTypeC>
 void gemm(
     const matrixTypeA& A, 
     const matrixTypeB& B, 
     matrixTypeC& C, 
-    scalarType a=1,
-    scalarType b=1)
+    MatrixValueType<matrixTypeC> a=1,
+    MatrixValueType<matrixTypeC> b=1,
+    bool isTransposeA=false,
+    bool isTransposeB=false)
 {
-    assert(C.get_number_of_rows() == A.get_number_of_rows());
-    assert(A.get_number_of_columns() == B.get_number_of_rows());
-    assert(C.get_number_of_columns() == B.get_number_of_columns());
-    for(auto i=0; i<A.get_number_of_rows(); ++i){
-        for(auto k=0; k<C.get_number_of_columns(); ++k){
-            C(i,k) *= b;
-            for(auto j=0; j<B.get_number_of_rows(); ++j){
-               C(i, k) += a * A(i,j) * B(j,k);
+    auto numberOfRows = C.get_number_of_rows();
+    auto numberOfColumns = C.get_number_of_columns();
+    auto innerDimension = isTransposeA ? A.get_number_of_rows() : A.get_number_of_columns();
+    ZLAB_INSTRUMENT("gemm", 2.0 * numberOfRows * numberOfColumns * innerDimension,
+        sizeof(MatrixValueType<matrixTypeC>) * (innerDimension * (numberOfRows + numberOfColumns) + 2.0 * numberOfRows * numberOfColumns));
+    assert(numberOfRows == (isTransposeA ? A.get_number_of_columns() : A.get_number_of_rows()));
+    assert(innerDimension == (isTransposeB ? B.get_number_of_columns() : B.get_number_of_rows()));
+    assert(numberOfColumns == (isTransposeB ? B.get_number_of_rows() : B.get_number_of_columns()));
+    auto grainSize = grain_size(innerDimension * numberOfColumns);
+    parallel_for(0, numberOfRows, [&](positiveIntegerType first, positiveIntegerType last){
+        for(auto i=first; i < last; ++i){
+            for(positiveIntegerType k=0; k < numberOfColumns; ++k){
+                C(i,k) *= b;
+            }
+            for(positiveIntegerType j=0; j < innerDimension; ++j){
+                auto aij = a * (isTransposeA ? A(j,i) : A(i,j));
+                for(positiveIntegerType k=0; k < numberOfColumns; ++k){
+                    C(i,k) += aij * (isTransposeB ? B(k,j) : B(j,k));
+                }
             }
         }
+    }, grainSize);
+}
+
+// SYRK (Symmetric Rank-k Update)
+// This function computes the lower triangle of C = a * A * A^T + b * C, or of
+// C = a * A^T * A + b * C when isTranspose is set. The strict upper triangle of C
+// is not referenced. A Gram matrix can be accumulated over row chunks of A by
+// calling it once per chunk with isTranspose=true and b=1.
+template <MatrixConcept matrixTypeA, MatrixConcept matrixTypeC>
+void syrk(
+    const matrixTypeA& A,
+    matrixTypeC& C,
+    MatrixValueType<matrixTypeC> a=1,
+    MatrixValueType<matrixTypeC> b=1,
+    bool isTranspose=false)
+{
+    auto order = C.get_number_of_rows();
+    auto innerDimension = isTranspose ? A.get_number_of_rows() : A.get_number_of_columns();
+    ZLAB_INSTRUMENT("syrk", 1.0 * order * (order + 1) * innerDimension,
+        sizeof(MatrixValueType<matrixTypeC>) * (1.0 * order * innerDimension + 1.0 * order * (order + 1)));
+    assert(order == C.get_number_of_columns());
+    assert(order == (isTranspose ? A.get_number_of_columns() : A.get_number_of_rows()));
+    auto grainSize = grain_size(innerDimension * order / 2);
+    parallel_for(0, order, [&](positiveIntegerType first, positiveIntegerType last){
+        for(auto i=first; i < last; ++i){
+            for(positiveIntegerType k=0; k <= i; ++k){
+                C(i,k) *= b;
+            }
+        }
+        if (isTranspose) {
+            for(positiveIntegerType j=0; j < innerDimension; ++j){
+                for(auto i=first; i < last; ++i){
+                    auto aji = a * A(j,i);
+                    for(positiveIntegerType k=0; k <= i; ++k){
+                        C(i,k) += aji * A(j,k);
+                    }
+                }
+            }
+        } else {
+            for(auto i=first; i < last; ++i){
+                for(positiveIntegerType k=0; k <= i; ++k){
+                    MatrixValueType<matrixTypeC> sum{0};
+                    for(positiveIntegerType j=0; j < innerDimension; ++j){
+                        sum += A(i,j) * A(k,j);
+                    }
+                    C(i,k) += a * sum;
+                }
+            }
+        }
+    }, grainSize);
+}
+
+// GRAM MATRIX
+// This function computes the full symmetric matrix A^T * A.
+template <MatrixConcept matrixType>
+BasicZMatrix<MatrixValueType<matrixType>> gram_matrix(const matrixType& A){
+    auto numberOfColumns = A.get_number_of_columns();
+    BasicZMatrix<MatrixValueType<matrixType>> G(numberOfColumns, numberOfColumns);
+    syrk(A, G, 1, 0, true);
+    for(positiveIntegerType i=0; i < numberOfColumns; ++i){
+        for(auto k=i+1; k < numberOfColumns; ++k){
+            G(i,k) = G(k,i);
+        }
     }
+    return G;
 }
 
 // GEMV (General Matrix-Vector Multiplication)
@@ -222,10 +735,12 @@ void gemv(
     const MatrixType& M,
     const VectorTypeX& x,
     VectorTypeY& y,
-    scalarType a=1,
-    scalarType b=0,
+    VectorValueType<VectorTypeY> a=1,
+    VectorValueType<VectorTypeY> b=0,
     bool isTranspose=true)
 {
+    ZLAB_INSTRUMENT("gemv", 2.0 * x.size() * y.size(),
+        sizeof(VectorValueType<VectorTypeY>) * (1.0 * x.size() * y.size() + x.size() + 2.0 * y.size()));
     if (isTranspose){
         assert(x.size() == M.get_number_of_rows());
         assert(y.size() == M.get_number_of_columns());
@@ -250,7 +765,7 @@ void gemv(
 // SCALE (General Matrix Scaling)
 // This function computes the operation M = a * M for a matrix and a scalar.
 template <MatrixConcept matrixType>
-void scale(matrixType& m, scalarType a){
+void scale(matrixType& m, MatrixValueType<matrixType> a){
     for(auto i=0; i < m.get_number_of_rows(); i++){
         for(auto j=0; j < m.get_number_of_columns(); j++){
             m(i,j) *=  a;
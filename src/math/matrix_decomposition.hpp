@@ -2,35 +2,54 @@
 #pragma once
 
 #include <stdexcept>
+#include <optional>
+#include <algorithm>
+#include <utility>
+#include <numeric>
+#include <limits>
+#include <vector>
+#include <cmath>
 
 #include "utilities.hpp"
+#include "triangular_solve.hpp"
+#include "matrix.hpp"
 #include "core.hpp"
 
 namespace zlab{
 
 template <typename matrixType>
-struct ModifiedGramSchmidt {
+struct GramSchmidtQR {
     matrixType Q;
     matrixType R; 
 };
 
 template <typename matrixType>
-using MGS = ModifiedGramSchmidt<matrixType>;
+using ModifiedGramSchmidt = GramSchmidtQR<matrixType>;
 
 template <typename matrixType>
-MGS<matrixType> modified_gram_schmidt(
+using MGS = ModifiedGramSchmidt<matrixType>;
+
+enum class GramSchmidtMethod { Modified, BlockClassicalTwice };
+
+template <RealMatrixConcept matrixType>
+MGS<OwnedMatrix<matrixType>> modified_gram_schmidt(
     const matrixType& data,
     std::optional<scalarType> marginOfError = std::nullopt)
 {
+    using valueType = MatrixValueType<matrixType>;
     auto numberOfRows = data.get_number_of_rows();
     auto numberOfColumns = data.get_number_of_columns();
-    matrixType Q(numberOfRows,numberOfColumns), R(numberOfColumns,numberOfColumns);
-    auto V = data.copy();
+    OwnedMatrix<matrixType> Q(numberOfRows,numberOfColumns), R(numberOfColumns,numberOfColumns);
+    ZLAB_INSTRUMENT("modified_gram_schmidt", 2.0 * numberOfRows * numberOfColumns * numberOfColumns,
+        sizeof(valueType) * (3.0 * numberOfRows * numberOfColumns + 1.0 * numberOfColumns * numberOfColumns));
+    // Q and R are returned, so only the working copy lives in the workspace.
+    ScopedWorkspace workspace;
+    auto V = copy_matrix(data);
     for(auto j=0; j < numberOfColumns; ++j){
         auto vj = V.column_view(j);
         auto qj = Q.column_view(j);
-        R(j,j) = norm(vj);
-        auto tolerance=evaluate_safe_tolerance(marginOfError);
+        R(j,j) = norm2(vj);
+        auto tolerance=evaluate_safe_tolerance<valueType>(marginOfError);
         if (R(j,j) < tolerance) {
             throw std::runtime_error("MGS: Matrix is ill-conditioned or rank-deficient.");
         }
@@ -44,4 +63,666 @@ MGS<matrixType> modified_gram_schmidt(
     return {std::move(Q), std::move(R)};
 }
 
+// CLASSICAL GRAM SCHMIDT TWICE (CGS2 Within a Panel)
+// This function overwrites the columns of V with orthonormal columns spanning the
+// same space and T with the upper triangular factor of V = V_out * T. Each column
+// is projected on the previous ones twice with GEMV; the second pass restores the
+// orthogonality that a single classical pass loses.
+template <RealMatrixConcept panelType, RealMatrixConcept factorType>
+void classical_gram_schmidt_twice(
+    panelType& V,
+    factorType& T,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    using valueType = MatrixValueType<panelType>;
+    auto numberOfRows = V.get_number_of_rows();
+    auto numberOfColumns = V.get_number_of_columns();
+    assert(T.get_number_of_rows() == numberOfColumns && T.get_number_of_columns() == numberOfColumns);
+    auto tolerance = evaluate_safe_tolerance<valueType>(marginOfError);
+    BasicZVector<valueType> projection(numberOfColumns);
+    for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+        auto vj = V.column_view(j);
+        for(positiveIntegerType i=0; i < numberOfColumns; ++i){
+            T(i,j) = 0;
+        }
+        if (j > 0) {
+            auto previous = V.block_view(0, 0, numberOfRows, j);
+            auto s = projection.view().subvector_view(0, j);
+            for(positiveIntegerType pass=0; pass < 2; ++pass){
+                gemv(previous, vj, s, 1, 0, true);
+                gemv(previous, s, vj, -1, 1, false);
+                for(positiveIntegerType i=0; i < j; ++i){
+                    T(i,j) += s[i];
+                }
+            }
+        }
+        T(j,j) = norm2(vj);
+        if (T(j,j) < tolerance) {
+            throw std::runtime_error("CGS2: Matrix is ill-conditioned or rank-deficient.");
+        }
+        scale(vj, 1 / T(j,j));
+    }
+}
+
+// BLOCK CLASSICAL GRAM SCHMIDT TWICE (BCGS2 Panel Orthogonalization)
+// This function orthogonalizes the panel V against the orthonormal columns of Q
+// and within itself. On return V holds the new orthonormal columns, S the
+// coefficients on Q and T the upper triangular factor, with
+// V_in = Q * S + V_out * T. The projection on Q runs twice as a pair of GEMMs,
+// each followed by CGS2 within the panel, so the loss of orthogonality stays at
+// rounding level (unlike the eps * cond(A) of MGS) while most flops are level-3.
+// Q may have no columns. The same call extends a Krylov basis: Q holds the basis
+// so far, V the new vectors and S, T the new columns of the Hessenberg matrix.
+template <RealMatrixConcept basisType, RealMatrixConcept panelType,
+          RealMatrixConcept coefficientType, RealMatrixConcept factorType>
+void block_classical_gram_schmidt_twice(
+    const basisType& Q,
+    panelType& V,
+    coefficientType& S,
+    factorType& T,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    using valueType = MatrixValueType<panelType>;
+    auto basisSize = Q.get_number_of_columns();
+    auto panelSize = V.get_number_of_columns();
+    assert(Q.get_number_of_rows() == V.get_number_of_rows());
+    assert(S.get_number_of_rows() == basisSize && S.get_number_of_columns() == panelSize);
+    if (basisSize == 0) {
+        classical_gram_schmidt_twice(V, T, marginOfError);
+        return;
+    }
+    ScopedWorkspace workspace;
+    BasicZMatrix<valueType> secondS(basisSize, panelSize), firstT(panelSize, panelSize), secondT(panelSize, panelSize);
+    gemm(Q, V, S, 1, 0, true, false);
+    gemm(Q, S, V, -1, 1);
+    classical_gram_schmidt_twice(V, firstT, marginOfError);
+    gemm(Q, V, secondS, 1, 0, true, false);
+    gemm(Q, secondS, V, -1, 1);
+    classical_gram_schmidt_twice(V, secondT, marginOfError);
+    // V_in = Q * (S1 + S2 * T1) + V_out * (T2 * T1).
+    gemm(secondS, firstT, S, 1, 1);
+    gemm(secondT, firstT, T, 1, 0);
+}
+
+// BLOCK GRAM SCHMIDT (QR Decomposition by BCGS2)
+// This function computes the thin QR decomposition of data, orthogonalizing
+// blockSize columns at a time against the columns already done with
+// block_classical_gram_schmidt_twice.
+template <RealMatrixConcept matrixType>
+GramSchmidtQR<OwnedMatrix<matrixType>> block_gram_schmidt(
+    const matrixType& data,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    auto numberOfRows = data.get_number_of_rows();
+    auto numberOfColumns = data.get_number_of_columns();
+    assert(blockSize > 0);
+    ZLAB_INSTRUMENT("block_gram_schmidt", 4.0 * numberOfRows * numberOfColumns * numberOfColumns,
+        sizeof(MatrixValueType<matrixType>) * (4.0 * numberOfRows * numberOfColumns + 1.0 * numberOfColumns * numberOfColumns));
+    auto Q = copy_matrix(data);
+    OwnedMatrix<matrixType> R(numberOfColumns, numberOfColumns);
+    for(positiveIntegerType k0=0; k0 < numberOfColumns; k0 += blockSize){
+        auto kb = std::min(blockSize, numberOfColumns - k0);
+        auto basis = Q.block_view(0, 0, numberOfRows, k0);
+        auto panel = Q.block_view(0, k0, numberOfRows, kb);
+        auto S = R.block_view(0, k0, k0, kb);
+        auto T = R.block_view(k0, k0, kb, kb);
+        block_classical_gram_schmidt_twice(basis, panel, S, T, marginOfError);
+    }
+    return {std::move(Q), std::move(R)};
+}
+
+// GRAM SCHMIDT (QR Decomposition With a Selectable Scheme)
+// This function computes the thin QR decomposition of data with modified
+// Gram-Schmidt or with block classical Gram-Schmidt with reorthogonalization.
+template <RealMatrixConcept matrixType>
+GramSchmidtQR<OwnedMatrix<matrixType>> gram_schmidt(
+    const matrixType& data,
+    GramSchmidtMethod method = GramSchmidtMethod::BlockClassicalTwice,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    if (method == GramSchmidtMethod::Modified) {
+        return modified_gram_schmidt(data, marginOfError);
+    }
+    return block_gram_schmidt(data, marginOfError);
+}
+
+template <typename matrixType>
+struct CholeskyDecomposition {
+    matrixType L;
+};
+
+// CHOLESKY (Blocked Right-Looking Cholesky Factorization)
+// This function computes the lower triangular L with A = L * L^T for a symmetric
+// positive definite A. Only the lower triangle of A is read. Each diagonal block is
+// factored unblocked, the panel below it is solved row by row in parallel and the
+// trailing matrix is updated with GEMM.
+template <RealMatrixConcept matrixType>
+CholeskyDecomposition<OwnedMatrix<matrixType>> cholesky(
+    const matrixType& data,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto order = data.get_number_of_rows();
+    ZLAB_INSTRUMENT("cholesky", 1.0 * order * order * order / 3,
+        sizeof(valueType) * 2.0 * order * order);
+    assert(order == data.get_number_of_columns());
+    assert(blockSize > 0);
+    auto L = copy_matrix(data);
+    RealType<valueType> largestDiagonal{0};
+    for(positiveIntegerType i=0; i < order; ++i){
+        largestDiagonal = std::max(largestDiagonal, std::abs(L(i,i)));
+    }
+    auto tolerance = evaluate_safe_tolerance<valueType>(marginOfError) * largestDiagonal;
+
+    // Solves row i of the block column [k0, j0) against the already factored rows.
+    auto eliminate_row = [&L](positiveIntegerType i, positiveIntegerType k0, positiveIntegerType j0){
+        for(auto j=k0; j < j0; ++j){
+            valueType sum{0};
+            for(auto p=k0; p < j; ++p){
+                sum += L(i,p) * L(j,p);
+            }
+            L(i,j) = (L(i,j) - sum) / L(j,j);
+        }
+    };
+
+    for(positiveIntegerType k0=0; k0 < order; k0 += blockSize){
+        auto kb = std::min(blockSize, order - k0);
+        for(auto j=k0; j < k0 + kb; ++j){
+            eliminate_row(j, k0, j);
+            valueType pivot = L(j,j);
+            for(auto p=k0; p < j; ++p){
+                pivot -= L(j,p) * L(j,p);
+            }
+            if (pivot <= tolerance) {
+                throw std::runtime_error("Cholesky: Matrix is not positive definite.");
+            }
+            L(j,j) = std::sqrt(pivot);
+        }
+        auto trailingStart = k0 + kb;
+        if (trailingStart == order) break;
+        parallel_for(trailingStart, order, [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto i=first; i < last; ++i){
+                eliminate_row(i, k0, k0 + kb);
+            }
+        }, grain_size(kb * kb));
+        for(auto j0=trailingStart; j0 < order; j0 += blockSize){
+            auto jb = std::min(blockSize, order - j0);
+            auto panelRows = L.block_view(j0, k0, order - j0, kb);
+            auto panelColumns = L.block_view(j0, k0, jb, kb);
+            auto trailing = L.block_view(j0, j0, order - j0, jb);
+            gemm(panelRows, panelColumns, trailing, -1, 1, false, true);
+        }
+    }
+    for(positiveIntegerType i=0; i < order; ++i){
+        for(auto j=i+1; j < order; ++j){
+            L(i,j) = 0;
+        }
+    }
+    return {std::move(L)};
+}
+
+template <typename matrixType>
+struct LDLTDecomposition {
+    matrixType L;
+    BasicZVector<MatrixValueType<matrixType>> D;
+};
+
+// LDLT (Blocked Right-Looking LDL^T Factorization)
+// This function computes the unit lower triangular L and the diagonal D with
+// A = L * diag(D) * L^T for a symmetric A whose leading principal minors are
+// nonzero (e.g. positive definite or quasi-definite matrices); no pivoting is
+// performed. Only the lower triangle of A is read. The blocking follows cholesky.
+template <RealMatrixConcept matrixType>
+LDLTDecomposition<OwnedMatrix<matrixType>> ldlt(
+    const matrixType& data,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto order = data.get_number_of_rows();
+    ZLAB_INSTRUMENT("ldlt", 1.0 * order * order * order / 3,
+        sizeof(valueType) * 2.0 * order * order);
+    assert(order == data.get_number_of_columns());
+    assert(blockSize > 0);
+    auto L = copy_matrix(data);
+    BasicZVector<valueType> D(order);
+    RealType<valueType> largestDiagonal{0};
+    for(positiveIntegerType i=0; i < order; ++i){
+        largestDiagonal = std::max(largestDiagonal, std::abs(L(i,i)));
+    }
+    auto tolerance = evaluate_safe_tolerance<valueType>(marginOfError) * largestDiagonal;
+
+    auto eliminate_row = [&L, &D](positiveIntegerType i, positiveIntegerType k0, positiveIntegerType j0){
+        for(auto j=k0; j < j0; ++j){
+            valueType sum{0};
+            for(auto p=k0; p < j; ++p){
+                sum += L(i,p) * L(j,p) * D[p];
+            }
+            L(i,j) = (L(i,j) - sum) / D[j];
+        }
+    };
+
+    for(positiveIntegerType k0=0; k0 < order; k0 += blockSize){
+        auto kb = std::min(blockSize, order - k0);
+        for(auto j=k0; j < k0 + kb; ++j){
+            eliminate_row(j, k0, j);
+            valueType pivot = L(j,j);
+            for(auto p=k0; p < j; ++p){
+                pivot -= L(j,p) * L(j,p) * D[p];
+            }
+            if (std::abs(pivot) <= tolerance) {
+                throw std::runtime_error("LDLT: Matrix has a zero pivot.");
+            }
+            D[j] = pivot;
+            L(j,j) = 1;
+        }
+        auto trailingStart = k0 + kb;
+        if (trailingStart == order) break;
+        auto numberOfTrailingRows = order - trailingStart;
+        BasicZMatrix<valueType> scaledPanel(numberOfTrailingRows, kb);
+        parallel_for(trailingStart, order, [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto i=first; i < last; ++i){
+                eliminate_row(i, k0, k0 + kb);
+                for(positiveIntegerType p=0; p < kb; ++p){
+                    scaledPanel(i - trailingStart, p) = L(i, k0 + p) * D[k0 + p];
+                }
+            }
+        }, grain_size(kb * kb));
+        for(auto j0=trailingStart; j0 < order; j0 += blockSize){
+            auto jb = std::min(blockSize, order - j0);
+            auto panelRows = scaledPanel.block_view(j0 - trailingStart, 0, order - j0, kb);
+            auto panelColumns = L.block_view(j0, k0, jb, kb);
+            auto trailing = L.block_view(j0, j0, order - j0, jb);
+            gemm(panelRows, panelColumns, trailing, -1, 1, false, true);
+        }
+    }
+    for(positiveIntegerType i=0; i < order; ++i){
+        for(auto j=i+1; j < order; ++j){
+            L(i,j) = 0;
+        }
+    }
+    return {std::move(L), std::move(D)};
+}
+
+// PARTIAL PIVOTING LU IN PLACE (Blocked Right-Looking LU Factorization)
+// This function overwrites a square A with the factors of P * A = L * U, where L is
+// unit lower triangular (stored below the diagonal) and U is upper triangular.
+// The returned pivots record that row i was swapped with row pivots[i] at step i.
+// Each panel is factored unblocked, the block row of U is solved with trsm and
+// the trailing matrix is updated with GEMM. Complex matrices are pivoted on the
+// modulus.
+template <typename matrixType>
+std::vector<positiveIntegerType> partial_pivoting_lu_in_place(
+    matrixType& A,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto order = A.get_number_of_rows();
+    ZLAB_INSTRUMENT("partial_pivoting_lu", 2.0 * order * order * order / 3,
+        sizeof(valueType) * 2.0 * order * order);
+    assert(order == A.get_number_of_columns());
+    assert(blockSize > 0);
+    std::vector<positiveIntegerType> pivots(order);
+    RealType<valueType> largestEntry{0};
+    for(positiveIntegerType i=0; i < order; ++i){
+        for(positiveIntegerType j=0; j < order; ++j){
+            largestEntry = std::max(largestEntry, std::abs(A(i,j)));
+        }
+    }
+    auto tolerance = evaluate_safe_tolerance<valueType>(marginOfError) * largestEntry;
+
+    for(positiveIntegerType k0=0; k0 < order; k0 += blockSize){
+        auto kb = std::min(blockSize, order - k0);
+        auto panelEnd = k0 + kb;
+        for(auto j=k0; j < panelEnd; ++j){
+            auto pivotRow = j;
+            for(auto i=j+1; i < order; ++i){
+                if (std::abs(A(i,j)) > std::abs(A(pivotRow,j))) pivotRow = i;
+            }
+            if (std::abs(A(pivotRow,j)) <= tolerance) {
+                throw std::runtime_error("LU: Matrix is singular (zero pivot found).");
+            }
+            pivots[j] = pivotRow;
+            if (pivotRow != j) {
+                for(positiveIntegerType c=0; c < order; ++c){
+                    std::swap(A(j,c), A(pivotRow,c));
+                }
+            }
+            auto inversePivot = valueType{1} / A(j,j);
+            parallel_for(j+1, order, [&](positiveIntegerType first, positiveIntegerType last){
+                for(auto i=first; i < last; ++i){
+                    A(i,j) *= inversePivot;
+                    for(auto c=j+1; c < panelEnd; ++c){
+                        A(i,c) -= A(i,j) * A(j,c);
+                    }
+                }
+            }, grain_size(panelEnd - j));
+        }
+        if (panelEnd == order) break;
+        auto L11 = A.block_view(k0, k0, kb, kb);
+        auto U12 = A.block_view(k0, panelEnd, kb, order - panelEnd);
+        trsm(L11, U12, TriangularPart::Lower, false, true, std::nullopt, kb);
+        auto L21 = A.block_view(panelEnd, k0, order - panelEnd, kb);
+        auto A22 = A.block_view(panelEnd, panelEnd, order - panelEnd, order - panelEnd);
+        gemm(L21, U12, A22, -1, 1);
+    }
+    return pivots;
+}
+
+template <typename matrixType>
+struct PartialPivotingLU {
+    matrixType LU;
+    std::vector<positiveIntegerType> pivots;
+};
+
+// PARTIAL PIVOTING LU
+// This function returns the packed factors and pivots of P * A = L * U without
+// modifying A (see partial_pivoting_lu_in_place).
+template <typename matrixType>
+PartialPivotingLU<OwnedMatrix<matrixType>> partial_pivoting_lu(
+    const matrixType& data,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    auto LU = copy_matrix(data);
+    auto pivots = partial_pivoting_lu_in_place(LU, marginOfError, blockSize);
+    return {std::move(LU), std::move(pivots)};
+}
+
+// HOUSEHOLDER REFLECTOR
+// This function computes H = I - tau * v * v^T with H * A(row:, column) = beta * e1.
+// beta overwrites A(row, column) and v, whose first entry is an implicit one,
+// overwrites the entries below it. tau is zero when the column is already reduced.
+template <RealMatrixConcept matrixType>
+MatrixValueType<matrixType> householder_reflector(matrixType& A, positiveIntegerType row, positiveIntegerType column){
+    using valueType = MatrixValueType<matrixType>;
+    auto numberOfRows = A.get_number_of_rows();
+    valueType alpha = A(row, column);
+    valueType tailNormSquared{0};
+    for(auto i=row+1; i < numberOfRows; ++i){
+        tailNormSquared += A(i, column) * A(i, column);
+    }
+    if (tailNormSquared == 0) return 0;
+    auto beta = -std::copysign(std::sqrt(alpha * alpha + tailNormSquared), alpha);
+    auto inverseScale = 1 / (alpha - beta);
+    for(auto i=row+1; i < numberOfRows; ++i){
+        A(i, column) *= inverseScale;
+    }
+    A(row, column) = beta;
+    return (beta - alpha) / beta;
+}
+
+// APPLY HOUSEHOLDER REFLECTOR
+// This function applies H = I - tau * v * v^T from the left to the columns
+// [firstColumn, lastColumn) of A, rows row and below. v has an implicit one at
+// row and is stored in V(row + 1:, column). Column chunks run in parallel.
+template <typename matrixTypeV, typename matrixTypeA>
+void apply_householder_reflector(
+    const matrixTypeV& V,
+    positiveIntegerType row,
+    positiveIntegerType column,
+    MatrixValueType<matrixTypeA> tau,
+    matrixTypeA& A,
+    positiveIntegerType firstColumn,
+    positiveIntegerType lastColumn)
+{
+    if (tau == 0 || firstColumn >= lastColumn) return;
+    auto numberOfRows = A.get_number_of_rows();
+    parallel_for(firstColumn, lastColumn, [&](positiveIntegerType first, positiveIntegerType last){
+        std::vector<MatrixValueType<matrixTypeA>> projections(last - first);
+        for(auto c=first; c < last; ++c){
+            projections[c - first] = A(row, c);
+        }
+        for(auto i=row+1; i < numberOfRows; ++i){
+            auto vi = V(i, column);
+            for(auto c=first; c < last; ++c){
+                projections[c - first] += vi * A(i, c);
+            }
+        }
+        for(auto c=first; c < last; ++c){
+            projections[c - first] *= tau;
+            A(row, c) -= projections[c - first];
+        }
+        for(auto i=row+1; i < numberOfRows; ++i){
+            auto vi = V(i, column);
+            for(auto c=first; c < last; ++c){
+                A(i, c) -= projections[c - first] * vi;
+            }
+        }
+    }, grain_size(numberOfRows - row));
+}
+
+// HOUSEHOLDER QR IN PLACE
+// This function overwrites A with R (upper triangle) and the Householder vectors
+// of Q (below the diagonal) and returns the reflector scalars.
+template <RealMatrixConcept matrixType>
+BasicZVector<MatrixValueType<matrixType>> householder_qr_in_place(matrixType& A){
+    using valueType = MatrixValueType<matrixType>;
+    auto numberOfColumns = A.get_number_of_columns();
+    auto numberOfReflectors = std::min(A.get_number_of_rows(), numberOfColumns);
+    BasicZVector<valueType> tau(numberOfReflectors);
+    ZLAB_INSTRUMENT("householder_qr", 2.0 * A.get_number_of_rows() * numberOfColumns * numberOfReflectors - 2.0 * numberOfReflectors * numberOfReflectors * numberOfReflectors / 3,
+        sizeof(valueType) * 2.0 * A.get_number_of_rows() * numberOfColumns);
+    for(positiveIntegerType k=0; k < numberOfReflectors; ++k){
+        tau[k] = householder_reflector(A, k, k);
+        apply_householder_reflector(A, k, k, tau[k], A, k + 1, numberOfColumns);
+    }
+    return tau;
+}
+
+// HOUSEHOLDER THIN Q
+// This function forms the first min(m, n) columns of Q from the output of
+// householder_qr_in_place by backward accumulation.
+template <RealMatrixConcept matrixType>
+BasicZMatrix<MatrixValueType<matrixType>> householder_thin_q(const matrixType& QR, const BasicZVector<MatrixValueType<matrixType>>& tau){
+    auto numberOfRows = QR.get_number_of_rows();
+    auto numberOfReflectors = tau.size();
+    BasicZMatrix<MatrixValueType<matrixType>> Q(numberOfRows, numberOfReflectors);
+    for(positiveIntegerType k=0; k < numberOfReflectors; ++k){
+        Q(k,k) = 1;
+    }
+    auto k = numberOfReflectors;
+    while (k > 0) {
+        --k;
+        apply_householder_reflector(QR, k, k, tau[k], Q, k, numberOfReflectors);
+    }
+    return Q;
+}
+
+template <typename matrixType>
+struct ColumnPivotingQR {
+    matrixType QR;
+    BasicZVector<MatrixValueType<matrixType>> tau;
+    std::vector<positiveIntegerType> permutation;
+    positiveIntegerType rank;
+};
+
+// COLUMN PIVOTING QR (Blocked Householder QR with Column Pivoting, QP3)
+// This function computes A * P = Q * R without failing on rank-deficient input.
+// R overwrites the upper triangle of QR and the Householder vectors of Q lie below
+// it; column j of A * P is column permutation[j] of A. Within a block the trailing
+// columns are updated lazily through the auxiliary matrix F (only the pivot row is
+// kept current), and the block is applied with one GEMM. Partial column norms are
+// downdated and recomputed when cancellation makes the downdate unreliable.
+// The numerical rank counts the diagonal entries of R above tolerance * |R(0,0)|.
+template <RealMatrixConcept matrixType>
+ColumnPivotingQR<OwnedMatrix<matrixType>> column_pivoting_qr(
+    const matrixType& data,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto numberOfRows = data.get_number_of_rows();
+    auto numberOfColumns = data.get_number_of_columns();
+    auto numberOfReflectors = std::min(numberOfRows, numberOfColumns);
+    assert(blockSize > 0);
+    ZLAB_INSTRUMENT("column_pivoting_qr", 4.0 * numberOfRows * numberOfColumns * numberOfReflectors - 4.0 * numberOfReflectors * numberOfReflectors * numberOfReflectors / 3,
+        sizeof(valueType) * 2.0 * numberOfRows * numberOfColumns);
+    auto A = copy_matrix(data);
+    BasicZVector<valueType> tau(numberOfReflectors);
+    std::vector<positiveIntegerType> permutation(numberOfColumns);
+    std::iota(permutation.begin(), permutation.end(), 0);
+
+    auto column_norm = [&A, numberOfRows](positiveIntegerType firstRow, positiveIntegerType column){
+        valueType sumOfSquares{0};
+        for(auto i=firstRow; i < numberOfRows; ++i){
+            sumOfSquares += A(i, column) * A(i, column);
+        }
+        return std::sqrt(sumOfSquares);
+    };
+    std::vector<valueType> partialNorms(numberOfColumns), exactNorms(numberOfColumns);
+    for(positiveIntegerType c=0; c < numberOfColumns; ++c){
+        partialNorms[c] = exactNorms[c] = column_norm(0, c);
+    }
+    auto downdateTolerance = std::sqrt(std::numeric_limits<valueType>::epsilon());
+    BasicZMatrix<valueType> F(numberOfColumns, blockSize);
+    std::vector<valueType> auxiliary(blockSize);
+
+    positiveIntegerType offset = 0;
+    while (offset < numberOfReflectors) {
+        auto currentBlockSize = std::min(blockSize, numberOfReflectors - offset);
+        std::vector<positiveIntegerType> columnsToRecompute;
+        positiveIntegerType k = 0;
+        while (k < currentBlockSize && columnsToRecompute.empty()) {
+            auto j = offset + k;
+            auto pivot = static_cast<positiveIntegerType>(
+                std::max_element(partialNorms.begin() + j, partialNorms.end()) - partialNorms.begin());
+            if (pivot != j) {
+                for(positiveIntegerType i=0; i < numberOfRows; ++i){
+                    std::swap(A(i, pivot), A(i, j));
+                }
+                for(positiveIntegerType p=0; p < k; ++p){
+                    std::swap(F(pivot - offset, p), F(k, p));
+                }
+                std::swap(permutation[pivot], permutation[j]);
+                partialNorms[pivot] = partialNorms[j];
+                exactNorms[pivot] = exactNorms[j];
+            }
+            // Bring column j up to date with the reflectors of this block.
+            for(auto i=j; i < numberOfRows && k > 0; ++i){
+                valueType sum{0};
+                for(positiveIntegerType p=0; p < k; ++p){
+                    sum += A(i, offset + p) * F(k, p);
+                }
+                A(i, j) -= sum;
+            }
+            tau[j] = householder_reflector(A, j, j);
+            auto diagonal = A(j, j);
+            A(j, j) = 1;
+            // F(:, k) = tau * A(j:, :)^T * v, corrected for the lazy updates.
+            parallel_for(j + 1, numberOfColumns, [&](positiveIntegerType first, positiveIntegerType last){
+                for(auto c=first; c < last; ++c){
+                    valueType sum{0};
+                    for(auto i=j; i < numberOfRows; ++i){
+                        sum += A(i, c) * A(i, j);
+                    }
+                    F(c - offset, k) = tau[j] * sum;
+                }
+            }, grain_size(numberOfRows - j));
+            for(positiveIntegerType c=0; c <= k; ++c){
+                F(c, k) = 0;
+            }
+            if (k > 0) {
+                for(positiveIntegerType p=0; p < k; ++p){
+                    valueType sum{0};
+                    for(auto i=j; i < numberOfRows; ++i){
+                        sum += A(i, offset + p) * A(i, j);
+                    }
+                    auxiliary[p] = -tau[j] * sum;
+                }
+                for(auto c=offset; c < numberOfColumns; ++c){
+                    for(positiveIntegerType p=0; p < k; ++p){
+                        F(c - offset, k) += F(c - offset, p) * auxiliary[p];
+                    }
+                }
+            }
+            for(auto c=j+1; c < numberOfColumns; ++c){
+                valueType sum{0};
+                for(positiveIntegerType p=0; p <= k; ++p){
+                    sum += A(j, offset + p) * F(c - offset, p);
+                }
+                A(j, c) -= sum;
+            }
+            if (j + 1 < numberOfReflectors) {
+                for(auto c=j+1; c < numberOfColumns; ++c){
+                    if (partialNorms[c] == 0) continue;
+                    auto ratio = std::abs(A(j, c)) / partialNorms[c];
+                    auto remaining = std::max(valueType{0}, (1 + ratio) * (1 - ratio));
+                    auto drift = remaining * zlab::pow(partialNorms[c] / exactNorms[c], 2);
+                    if (drift <= downdateTolerance) {
+                        columnsToRecompute.push_back(c);
+                    } else {
+                        partialNorms[c] *= std::sqrt(remaining);
+                    }
+                }
+            }
+            A(j, j) = diagonal;
+            ++k;
+        }
+        auto blockEnd = offset + k;
+        if (blockEnd < numberOfRows && blockEnd < numberOfColumns) {
+            auto reflectors = A.block_view(blockEnd, offset, numberOfRows - blockEnd, k);
+            auto lazyUpdates = F.block_view(blockEnd - offset, 0, numberOfColumns - blockEnd, k);
+            auto trailing = A.block_view(blockEnd, blockEnd, numberOfRows - blockEnd, numberOfColumns - blockEnd);
+            gemm(reflectors, lazyUpdates, trailing, -1, 1, false, true);
+        }
+        for(auto c : columnsToRecompute){
+            partialNorms[c] = exactNorms[c] = column_norm(blockEnd, c);
+        }
+        offset = blockEnd;
+    }
+
+    positiveIntegerType rank = 0;
+    auto rankTolerance = evaluate_safe_tolerance<valueType>(marginOfError) * std::abs(A(0, 0));
+    while (rank < numberOfReflectors && std::abs(A(rank, rank)) > rankTolerance) {
+        ++rank;
+    }
+    return {std::move(A), std::move(tau), std::move(permutation), rank};
+}
+
+// UPPER TRAPEZOIDAL RZ (Complete Orthogonal Decomposition Step)
+// This function reduces the leading rank x n upper trapezoid [R11 R12] of A to
+// [T 0] * Z, with Z the product of Householder reflectors applied from the right,
+// bottom row first. T overwrites R11, the reflector tails overwrite R12 and the
+// reflector scalars are returned.
+template <RealMatrixConcept matrixType>
+std::vector<MatrixValueType<matrixType>> upper_trapezoidal_rz_in_place(matrixType& A, positiveIntegerType rank){
+    using valueType = MatrixValueType<matrixType>;
+    auto numberOfColumns = A.get_number_of_columns();
+    assert(rank <= A.get_number_of_rows() && rank <= numberOfColumns);
+    std::vector<valueType> tau(rank, 0);
+    auto k = rank;
+    while (k > 0) {
+        --k;
+        valueType alpha = A(k, k);
+        valueType tailNormSquared{0};
+        for(auto c=rank; c < numberOfColumns; ++c){
+            tailNormSquared += A(k, c) * A(k, c);
+        }
+        if (tailNormSquared == 0) continue;
+        auto beta = -std::copysign(std::sqrt(alpha * alpha + tailNormSquared), alpha);
+        auto inverseScale = 1 / (alpha - beta);
+        for(auto c=rank; c < numberOfColumns; ++c){
+            A(k, c) *= inverseScale;
+        }
+        A(k, k) = beta;
+        tau[k] = (beta - alpha) / beta;
+        for(positiveIntegerType i=0; i < k; ++i){
+            auto sum = A(i, k);
+            for(auto c=rank; c < numberOfColumns; ++c){
+                sum += A(i, c) * A(k, c);
+            }
+            sum *= tau[k];
+            A(i, k) -= sum;
+            for(auto c=rank; c < numberOfColumns; ++c){
+                A(i, c) -= sum * A(k, c);
+            }
+        }
+    }
+    return tau;
+}
+
 } // end namespace zlab
@@ -0,0 +1,173 @@
+
+#include <stdexcept>
+#include <utility>
+#include <limits>
+#include <cstring>
+#include <cstdio>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "matrix_io.hpp"
+
+namespace zlab{
+
+namespace {
+    constexpr char matrixFileMagic[8] = {'Z', 'L', 'A', 'B', 'M', 'A', 'T', '\0'};
+    constexpr std::uint32_t nativeByteOrderMark = 0x01020304;
+
+    // Checks a header read from a file of fileSize bytes.
+    void validate_header(const MatrixFileHeader& header, positiveIntegerType fileSize, const std::string& path){
+        auto fail = [&path](const std::string& reason){
+            throw std::runtime_error("Matrix file '" + path + "': " + reason);
+        };
+        if (std::memcmp(header.magic, matrixFileMagic, sizeof(matrixFileMagic)) != 0) fail("not a zlab matrix file.");
+        if (header.version != matrixFileVersion) fail("unsupported format version.");
+        if (header.byteOrderMark != nativeByteOrderMark) fail("written with a different byte order.");
+        if (header.scalarCode != static_cast<std::uint32_t>(MatrixFileScalar::Float64)) fail("unsupported scalar type.");
+        if (header.layout != static_cast<std::uint32_t>(MatrixFileLayout::RowMajor)) fail("unsupported layout.");
+        if (header.numberOfRows == 0 || header.numberOfColumns == 0) fail("empty matrix.");
+        // MappedMatrix uses the elements in place, so they must be aligned for scalarType.
+        if (header.alignment == 0 || header.dataOffset % header.alignment != 0 ||
+            header.dataOffset % alignof(scalarType) != 0 || header.dataOffset < sizeof(MatrixFileHeader)) {
+            fail("invalid data offset.");
+        }
+        auto largestDimension = static_cast<std::uint64_t>(std::numeric_limits<integerType>::max());
+        if (header.numberOfRows > largestDimension || header.numberOfColumns > largestDimension) fail("dimensions too large.");
+        // Divisions instead of products, which a crafted header could overflow.
+        if (header.dataOffset > fileSize ||
+            header.numberOfRows > (fileSize - header.dataOffset) / sizeof(scalarType) / header.numberOfColumns) {
+            fail("file is truncated.");
+        }
+    }
+}
+
+MatrixFileWriter::MatrixFileWriter(
+    const std::string& path,
+    positiveIntegerType numberOfRows,
+    positiveIntegerType numberOfColumns) :
+    file(std::fopen(path.c_str(), "wb")),
+    numberOfColumns(numberOfColumns) {
+    if (!file) throw std::runtime_error("Matrix file '" + path + "': cannot open for writing.");
+    MatrixFileHeader header{};
+    std::memcpy(header.magic, matrixFileMagic, sizeof(matrixFileMagic));
+    header.version = matrixFileVersion;
+    header.scalarCode = static_cast<std::uint32_t>(MatrixFileScalar::Float64);
+    header.layout = static_cast<std::uint32_t>(MatrixFileLayout::RowMajor);
+    header.alignment = memoryAlignment;
+    header.numberOfRows = numberOfRows;
+    header.numberOfColumns = numberOfColumns;
+    header.dataOffset = sizeof(MatrixFileHeader);
+    header.byteOrderMark = nativeByteOrderMark;
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        throw std::runtime_error("Matrix file '" + path + "': write failed.");
+    }
+}
+
+MatrixFileWriter::~MatrixFileWriter(){
+    if (file) std::fclose(file);
+}
+
+void MatrixFileWriter::write_row(std::span<const scalarType> row){
+    assert(file && row.size() == numberOfColumns);
+    if (std::fwrite(row.data(), sizeof(scalarType), row.size(), file) != row.size()) {
+        throw std::runtime_error("Matrix file: write failed.");
+    }
+}
+
+void MatrixFileWriter::close(){
+    if (!file) return;
+    auto isClosed = std::fclose(file) == 0;
+    file = nullptr;
+    if (!isClosed) throw std::runtime_error("Matrix file: close failed.");
+}
+
+ZMatrix load_matrix(const std::string& path){
+    auto file = std::fopen(path.c_str(), "rb");
+    if (!file) throw std::runtime_error("Matrix file '" + path + "': cannot open for reading.");
+    MatrixFileHeader header{};
+    struct stat status{};
+    auto isHeaderRead = std::fread(&header, sizeof(header), 1, file) == 1 && fstat(fileno(file), &status) == 0;
+    if (!isHeaderRead) {
+        std::fclose(file);
+        throw std::runtime_error("Matrix file '" + path + "': cannot read the header.");
+    }
+    try {
+        validate_header(header, status.st_size, path);
+        // ZMatrix counts its elements in integerType.
+        if (header.numberOfRows > std::numeric_limits<integerType>::max() / header.numberOfColumns) {
+            throw std::runtime_error("Matrix file '" + path + "': too many elements to load.");
+        }
+    } catch (...) {
+        std::fclose(file);
+        throw;
+    }
+    ZMatrix A(header.numberOfRows, header.numberOfColumns);
+    auto numberOfElements = A.get_number_of_elements();
+    auto isDataRead = std::fseek(file, header.dataOffset, SEEK_SET) == 0 &&
+        std::fread(A.data(), sizeof(scalarType), numberOfElements, file) == numberOfElements;
+    std::fclose(file);
+    if (!isDataRead) throw std::runtime_error("Matrix file '" + path + "': cannot read the elements.");
+    return A;
+}
+
+MappedMatrix::MappedMatrix(const std::string& path){
+    auto descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) throw std::runtime_error("Matrix file '" + path + "': cannot open for reading.");
+    struct stat status{};
+    if (::fstat(descriptor, &status) != 0 || status.st_size < static_cast<off_t>(sizeof(MatrixFileHeader))) {
+        ::close(descriptor);
+        throw std::runtime_error("Matrix file '" + path + "': cannot read the header.");
+    }
+    mappingSize = status.st_size;
+    mapping = ::mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Matrix file '" + path + "': mmap failed.");
+    }
+    MatrixFileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    try {
+        validate_header(header, mappingSize, path);
+    } catch (...) {
+        unmap();
+        throw;
+    }
+    elements = reinterpret_cast<const scalarType*>(static_cast<const std::byte*>(mapping) + header.dataOffset);
+    numberOfRows = header.numberOfRows;
+    numberOfColumns = header.numberOfColumns;
+}
+
+MappedMatrix::MappedMatrix(MappedMatrix&& other) noexcept :
+    mapping(std::exchange(other.mapping, nullptr)),
+    mappingSize(std::exchange(other.mappingSize, 0)),
+    elements(std::exchange(other.elements, nullptr)),
+    numberOfRows(std::exchange(other.numberOfRows, 0)),
+    numberOfColumns(std::exchange(other.numberOfColumns, 0)) {}
+
+MappedMatrix& MappedMatrix::operator=(MappedMatrix&& other) noexcept {
+    if (this == &other) return *this;
+    unmap();
+    mapping = std::exchange(other.mapping, nullptr);
+    mappingSize = std::exchange(other.mappingSize, 0);
+    elements = std::exchange(other.elements, nullptr);
+    numberOfRows = std::exchange(other.numberOfRows, 0);
+    numberOfColumns = std::exchange(other.numberOfColumns, 0);
+    return *this;
+}
+
+MappedMatrix::~MappedMatrix(){
+    unmap();
+}
+
+void MappedMatrix::unmap(){
+    if (mapping) ::munmap(mapping, mappingSize);
+    mapping = nullptr;
+    mappingSize = 0;
+}
+
+} // end namespace zlab
@@ -0,0 +1,112 @@
+
+#pragma once
+
+#include <cstdint>
+#include <cassert>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <span>
+
+#include "matrix.hpp"
+
+namespace zlab{
+
+// MATRIX FILE FORMAT (Version 1)
+// A 64-byte header followed by the elements in row-major order, starting at
+// dataOffset (a multiple of alignment). A file can therefore be memory-mapped
+// and its elements used in place. byteOrderMark is written in the native byte
+// order so that files from a machine with a different endianness are rejected.
+struct MatrixFileHeader{
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t scalarCode;
+    std::uint32_t layout;
+    std::uint32_t alignment;
+    std::uint64_t numberOfRows;
+    std::uint64_t numberOfColumns;
+    std::uint64_t dataOffset;
+    std::uint32_t byteOrderMark;
+    std::uint8_t reserved[12];
+};
+static_assert(sizeof(MatrixFileHeader) == 64);
+
+static constexpr std::uint32_t matrixFileVersion = 1;
+enum class MatrixFileScalar : std::uint32_t { Float64 = 1 };
+enum class MatrixFileLayout : std::uint32_t { RowMajor = 0 };
+
+// MATRIX FILE WRITER
+// Writes the header on construction and accepts the rows in order.
+class MatrixFileWriter{
+    private:
+        std::FILE* file;
+        positiveIntegerType numberOfColumns;
+    public:
+        MatrixFileWriter(const std::string&, positiveIntegerType, positiveIntegerType);
+        MatrixFileWriter(const MatrixFileWriter&) = delete;
+        MatrixFileWriter& operator=(const MatrixFileWriter&) = delete;
+        ~MatrixFileWriter();
+        void write_row(std::span<const scalarType>);
+        void close();
+};
+
+// SAVE MATRIX
+// This function writes any matrix to path in the binary matrix format.
+template <MatrixConcept matrixType>
+void save_matrix(const std::string& path, const matrixType& A){
+    auto numberOfRows = A.get_number_of_rows();
+    auto numberOfColumns = A.get_number_of_columns();
+    MatrixFileWriter writer(path, numberOfRows, numberOfColumns);
+    std::vector<scalarType> row(numberOfColumns);
+    for(positiveIntegerType i=0; i < numberOfRows; ++i){
+        for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+            row[j] = A(i,j);
+        }
+        writer.write_row(row);
+    }
+    writer.close();
+}
+
+// LOAD MATRIX
+// This function reads a binary matrix file into a new ZMatrix.
+ZMatrix load_matrix(const std::string&);
+
+// MAPPED MATRIX
+// A read-only, non-owning view of a matrix file mapped into memory with mmap.
+// Nothing is read until elements are touched, so opening a large file takes
+// constant time. It satisfies MatrixConcept and can be passed directly to gemv,
+// gemm and the solvers, which use ZMatrix for any working copies they need.
+class MappedMatrix{
+    private:
+        void* mapping{nullptr};
+        positiveIntegerType mappingSize{0};
+        const scalarType* elements{nullptr};
+        positiveIntegerType numberOfRows{0};
+        positiveIntegerType numberOfColumns{0};
+
+        void unmap();
+    public:
+        MappedMatrix() = delete;
+        explicit MappedMatrix(const std::string&);
+        MappedMatrix(const MappedMatrix&) = delete;
+        MappedMatrix(MappedMatrix&&) noexcept;
+        ~MappedMatrix();
+        MappedMatrix& operator=(const MappedMatrix&) = delete;
+        MappedMatrix& operator=(MappedMatrix&&) noexcept;
+
+        const scalarType& operator()(integerType row, integerType column) const {
+            assert(row < numberOfRows && column < numberOfColumns);
+            return elements[row * numberOfColumns + column];
+        }
+        std::span<const scalarType> row_view(integerType rowIndex) const {
+            assert(rowIndex < numberOfRows);
+            return {elements + rowIndex * numberOfColumns, numberOfColumns};
+        }
+        const scalarType* data() const { return elements; }
+        ConstZMatrixView view() const { return {elements, numberOfRows, numberOfColumns}; }
+
+        positiveIntegerType get_number_of_rows() const { return numberOfRows; }
+        positiveIntegerType get_number_of_columns() const { return numberOfColumns; }
+};
+
+} // end namespace zlab
@@ -0,0 +1,2 @@
+
+#include "nonlinear_least_squares.hpp"
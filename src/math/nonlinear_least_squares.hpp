@@ -0,0 +1,319 @@
+
+#pragma once
+
+#include <stdexcept>
+#include <optional>
+#include <type_traits>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "matrix.hpp"
+#include "matrix_decomposition.hpp"
+#include "solvers.hpp"
+#include "core.hpp"
+
+namespace zlab{
+
+// LSQR (Damped Least Squares by Golub-Kahan Bidiagonalization)
+// This function solves min ||A * x - b||^2 + damping^2 ||x||^2 for an operator
+// given only through apply(v, w), which must set w = A * v, and
+// applyTranspose(u, w), which must set w = A^T * u (Paige and Saunders). x is
+// overwritten, starting from zero. The iteration stops when the residual or the
+// normal-equations residual falls below tolerance relative to the estimates of
+// ||b|| or ||A|| * ||r||, or after maximumIterations (2 n by default). It returns
+// the number of iterations taken. Only five vectors are kept.
+template <typename operatorType, typename transposeOperatorType>
+positiveIntegerType lsqr(
+    const operatorType& apply,
+    const transposeOperatorType& applyTranspose,
+    const ZVector& b,
+    ZVector& x,
+    scalarType damping = 0,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    std::optional<positiveIntegerType> maximumIterationsOption = std::nullopt)
+{
+    // The operator is opaque, so only the time and the calls are recorded.
+    ZLAB_INSTRUMENT("lsqr", 0, 0);
+    auto numberOfRows = b.size();
+    auto numberOfColumns = x.size();
+    auto maximumIterations = maximumIterationsOption.value_or(2 * numberOfColumns);
+    auto tolerance = evaluate_safe_tolerance(marginOfError);
+    x.fill(0);
+    ZVector u(numberOfRows), v(numberOfColumns), w(numberOfColumns), Av(numberOfRows), Atu(numberOfColumns);
+    u = b;
+    auto beta = norm2(u);
+    if (beta == 0) return 0;
+    scale(u, 1 / beta);
+    applyTranspose(u, v);
+    auto alpha = norm2(v);
+    if (alpha == 0) return 0;
+    scale(v, 1 / alpha);
+    w = v;
+    auto bNorm = beta;
+    auto phiBar = beta;
+    auto rhoBar = alpha;
+    scalarType operatorNormSquared{0};
+    scalarType dampedResidualSquared{0};
+    for(positiveIntegerType iteration=1; iteration <= maximumIterations; ++iteration){
+        apply(v, Av);
+        axpby(1, Av, -alpha, u);
+        beta = norm2(u);
+        if (beta > 0) scale(u, 1 / beta);
+        operatorNormSquared += alpha * alpha + beta * beta + damping * damping;
+        applyTranspose(u, Atu);
+        axpby(1, Atu, -beta, v);
+        alpha = norm2(v);
+        if (alpha > 0) scale(v, 1 / alpha);
+
+        // The damping row is rotated away first, then the bidiagonal subdiagonal.
+        auto rhoBarDamped = std::hypot(rhoBar, damping);
+        auto psi = damping / rhoBarDamped * phiBar;
+        phiBar *= rhoBar / rhoBarDamped;
+        auto rho = std::hypot(rhoBarDamped, beta);
+        auto c = rhoBarDamped / rho;
+        auto s = beta / rho;
+        auto theta = s * alpha;
+        rhoBar = -c * alpha;
+        auto phi = c * phiBar;
+        phiBar *= s;
+        axpy(phi / rho, w, x);
+        axpby(1, v, -theta / rho, w);
+
+        dampedResidualSquared += psi * psi;
+        auto residualNorm = std::sqrt(phiBar * phiBar + dampedResidualSquared);
+        auto normalResidualNorm = alpha * std::abs(s * phi);
+        auto operatorNorm = std::sqrt(operatorNormSquared);
+        if (residualNorm <= tolerance * bNorm || normalResidualNorm <= tolerance * operatorNorm * residualNorm
+            || alpha == 0) {
+            return iteration;
+        }
+    }
+    return maximumIterations;
+}
+
+// FINITE DIFFERENCE JACOBIAN
+// A Jacobian functor J(x) for a residual functor r(x, f) that sets f = r(x), by
+// forward differences with the step sqrt(eps) * max(|x_j|, 1). When the residual
+// at x is already known, J(x, r, J) takes it as the base point and costs
+// x.size() residual evaluations instead of one more. The columns are split over
+// the library thread pool, so the residual functor must be safe to call
+// concurrently; each chunk perturbs its own copy of x.
+template <typename residualType>
+class FiniteDifferenceJacobian{
+        residualType residual;
+    public:
+        FiniteDifferenceJacobian() = delete;
+        explicit FiniteDifferenceJacobian(const residualType& residual) : residual(residual) {}
+
+        void operator()(const ZVector&, ZMatrix&) const;
+        void operator()(const ZVector&, const ZVector&, ZMatrix&) const;
+};
+
+template <typename residualType>
+void FiniteDifferenceJacobian<residualType>::operator()(const ZVector& x, ZMatrix& J) const {
+    ScopedArena arena;
+    ZVector r(J.get_number_of_rows(), 0, arena.get_resource());
+    residual(x, r);
+    (*this)(x, r, J);
+}
+
+template <typename residualType>
+void FiniteDifferenceJacobian<residualType>::operator()(const ZVector& x, const ZVector& r, ZMatrix& J) const {
+    auto numberOfRows = J.get_number_of_rows();
+    auto numberOfColumns = J.get_number_of_columns();
+    assert(x.size() == numberOfColumns && r.size() == numberOfRows);
+    ZLAB_INSTRUMENT("finite_difference_jacobian", 2.0 * numberOfRows * numberOfColumns,
+        sizeof(scalarType) * 2.0 * numberOfRows * numberOfColumns);
+    auto relativeStep = std::sqrt(std::numeric_limits<scalarType>::epsilon());
+    // Residual evaluations are opaque and usually expensive, so every column is
+    // a unit of parallel work. The residual is user code, so only the perturbed
+    // buffers come from the chunk's arena.
+    parallel_for(0, numberOfColumns, [&](positiveIntegerType first, positiveIntegerType last){
+        ScopedArena arena;
+        ZVector perturbedX(numberOfColumns, 0, arena.get_resource()), perturbedR(numberOfRows, 0, arena.get_resource());
+        perturbedX = x;
+        for(auto j=first; j < last; ++j){
+            perturbedX[j] = x[j] + relativeStep * std::max(std::abs(x[j]), scalarType{1});
+            auto step = perturbedX[j] - x[j];
+            residual(perturbedX, perturbedR);
+            for(positiveIntegerType i=0; i < numberOfRows; ++i){
+                J(i,j) = (perturbedR[i] - r[i]) / step;
+            }
+            perturbedX[j] = x[j];
+        }
+    });
+}
+
+struct LevenbergMarquardtResult {
+    scalarType residualNorm;
+    positiveIntegerType numberOfIterations;
+};
+
+// TRUST REGION LEVENBERG MARQUARDT (Iteration Shared by the Step Solvers)
+// This function minimizes ||r(x)||^2 / 2 from the given x. linearize(x, r, g)
+// evaluates the model at an accepted x, sets the gradient g = J^T * r and returns
+// an estimate of the largest diagonal of J^T * J; step(mu, h) solves
+// min ||J * h + r||^2 + mu ||h||^2. A step is accepted when the actual reduction
+// is positive, and the damping mu follows the gain ratio (Nielsen's update). The
+// iteration stops when ||g||_inf or the relative step size falls below
+// sqrt(safe tolerance) and throws after maximumIterations.
+template <typename residualType, typename linearizeType, typename stepType>
+LevenbergMarquardtResult trust_region_levenberg_marquardt(
+    const residualType& residual,
+    positiveIntegerType numberOfResiduals,
+    ZVector& x,
+    const linearizeType& linearize,
+    const stepType& step,
+    std::optional<scalarType> marginOfError,
+    positiveIntegerType maximumIterations)
+{
+    auto numberOfParameters = x.size();
+    auto tolerance = std::sqrt(evaluate_safe_tolerance(marginOfError));
+    // Every buffer of the iteration is allocated once.
+    ZVector r(numberOfResiduals), trialR(numberOfResiduals), g(numberOfParameters), h(numberOfParameters), trialX(numberOfParameters);
+    residual(x, r);
+    auto cost = dot(r, r) / 2;
+    auto largestCurvature = linearize(x, r, g);
+    scalarType mu = 1e-3 * (largestCurvature > 0 ? largestCurvature : 1);
+    scalarType nu = 2;
+    for(positiveIntegerType iteration=0; iteration < maximumIterations; ++iteration){
+        if (norm_infinity(g) <= tolerance) {
+            return {norm2(r), iteration};
+        }
+        step(mu, h);
+        if (norm2(h) <= tolerance * (norm2(x) + tolerance)) {
+            return {norm2(r), iteration};
+        }
+        trialX = x;
+        axpy(1, h, trialX);
+        residual(trialX, trialR);
+        auto trialCost = dot(trialR, trialR) / 2;
+        // Reduction predicted by the linear model: h^T (mu * h - g) / 2.
+        auto predictedReduction = (mu * dot(h, h) - dot(h, g)) / 2;
+        auto gainRatio = (cost - trialCost) / predictedReduction;
+        if (predictedReduction > 0 && gainRatio > 0) {
+            x = trialX;
+            r = trialR;
+            cost = trialCost;
+            largestCurvature = linearize(x, r, g);
+            auto shrink = 2 * gainRatio - 1;
+            mu *= std::max(scalarType{1} / 3, 1 - shrink * shrink * shrink);
+            nu = 2;
+        } else {
+            mu *= nu;
+            nu *= 2;
+        }
+    }
+    throw std::runtime_error("Levenberg-Marquardt: No convergence within the maximum number of iterations.");
+}
+
+// LEVENBERG MARQUARDT (Dense Jacobian)
+// This function minimizes ||r(x)||^2 for a residual functor residual(x, f) with
+// numberOfResiduals >= x.size() entries and a Jacobian functor jacobian(x, J),
+// analytic or a FiniteDifferenceJacobian. A functor that also accepts
+// jacobian(x, r, J) is given the residual the iteration already holds at x, which
+// saves a finite-difference Jacobian one residual evaluation. Each accepted point
+// factors [J r] once with Householder QR into preallocated storage; every damping
+// trial then only re-triangularizes the 2n x n matrix [R; sqrt(mu) I] in O(n^3), so
+// neither Q nor any buffer is formed again inside the loop.
+template <typename residualType, typename jacobianType>
+LevenbergMarquardtResult levenberg_marquardt(
+    const residualType& residual,
+    const jacobianType& jacobian,
+    positiveIntegerType numberOfResiduals,
+    ZVector& x,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType maximumIterations = 200)
+{
+    auto m = numberOfResiduals;
+    auto n = x.size();
+    assert(m >= n);
+    // Residuals and Jacobians are user code; the factorizations report themselves.
+    ZLAB_INSTRUMENT("levenberg_marquardt", 0, 0);
+    ZMatrix J(m, n), W(m, n + 1), S(2 * n, n + 1);
+    auto linearize = [&](const ZVector& x, const ZVector& r, ZVector& g){
+        if constexpr (std::is_invocable_v<const jacobianType&, const ZVector&, const ZVector&, ZMatrix&>) {
+            jacobian(x, r, J);
+        } else {
+            jacobian(x, J);
+        }
+        for(positiveIntegerType i=0; i < m; ++i){
+            for(positiveIntegerType j=0; j < n; ++j){
+                W(i,j) = J(i,j);
+            }
+            W(i,n) = r[i];
+        }
+        scalarType largestCurvature{0};
+        for(positiveIntegerType j=0; j < n; ++j){
+            largestCurvature = std::max(largestCurvature, dot(J.column_view(j), J.column_view(j)));
+        }
+        for(positiveIntegerType k=0; k < n; ++k){
+            auto tau = householder_reflector(W, k, k);
+            apply_householder_reflector(W, k, k, tau, W, k + 1, n + 1);
+        }
+        // J^T * r = R^T * (Q^T * r).
+        for(positiveIntegerType j=0; j < n; ++j){
+            scalarType sum{0};
+            for(positiveIntegerType i=0; i <= j; ++i){
+                sum += W(i,j) * W(i,n);
+            }
+            g[j] = sum;
+        }
+        return largestCurvature;
+    };
+    auto step = [&](scalarType mu, ZVector& h){
+        S.fill(0);
+        for(positiveIntegerType i=0; i < n; ++i){
+            for(auto j=i; j <= n; ++j){
+                S(i,j) = W(i,j);
+            }
+            S(n + i, i) = std::sqrt(mu);
+        }
+        for(positiveIntegerType k=0; k < n; ++k){
+            auto tau = householder_reflector(S, k, k);
+            apply_householder_reflector(S, k, k, tau, S, k + 1, n + 1);
+        }
+        backward_substitution(S.block_view(0, 0, n, n), S.column_view(n).subvector_view(0, n), h, scalarType{0});
+        scale(h, -1);
+    };
+    return trust_region_levenberg_marquardt(residual, m, x, linearize, step, marginOfError, maximumIterations);
+}
+
+// LEVENBERG MARQUARDT (Matrix-Free Jacobian)
+// This function minimizes ||r(x)||^2 with the Jacobian given only through
+// jacobianProduct(x, v, w, isTranspose), which must set w = J(x) * v, or
+// w = J(x)^T * v when isTranspose is set, e.g. for large sparse Jacobians. The
+// damped step is computed by lsqr, which never forms J or J^T * J.
+template <typename residualType, typename jacobianProductType>
+LevenbergMarquardtResult matrix_free_levenberg_marquardt(
+    const residualType& residual,
+    const jacobianProductType& jacobianProduct,
+    positiveIntegerType numberOfResiduals,
+    ZVector& x,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType maximumIterations = 200,
+    std::optional<positiveIntegerType> maximumInnerIterations = std::nullopt)
+{
+    auto m = numberOfResiduals;
+    auto n = x.size();
+    ZLAB_INSTRUMENT("levenberg_marquardt", 0, 0);
+    ZVector linearizationPoint(n), minusR(m);
+    auto linearize = [&](const ZVector& x, const ZVector& r, ZVector& g){
+        linearizationPoint = x;
+        minusR = r;
+        scale(minusR, -1);
+        jacobianProduct(x, r, g, true);
+        // Rayleigh quotient of J * J^T at r, a lower bound of the largest curvature.
+        auto rr = dot(r, r);
+        return rr > 0 ? dot(g, g) / rr : scalarType{0};
+    };
+    auto apply = [&](const ZVector& v, ZVector& w){ jacobianProduct(linearizationPoint, v, w, false); };
+    auto applyTranspose = [&](const ZVector& u, ZVector& w){ jacobianProduct(linearizationPoint, u, w, true); };
+    auto step = [&](scalarType mu, ZVector& h){
+        lsqr(apply, applyTranspose, minusR, h, std::sqrt(mu), marginOfError, maximumInnerIterations);
+    };
+    return trust_region_levenberg_marquardt(residual, m, x, linearize, step, marginOfError, maximumIterations);
+}
+
+} // end namespace zlab
@@ -1,10 +1,14 @@
 
-#pragma one
+#pragma once
 
 #include <functional>
+#include <stdexcept>
+#include <algorithm>
 #include <cassert>
+#include <optional>
 #include <vector>
 #include <array>
+#include <cmath>
 
 #include "core.hpp"
 #include "matrix.hpp"
@@ -97,54 +101,100 @@ static constexpr ButcherTableau<4> ButcherTableauClassicalRungeKutta4 = {
 };
 static constexpr auto& ClassicalRK4 = ButcherTableauClassicalRungeKutta4;
 
-template<positiveIntegerType numberOfStages, typename functionType>
+// Knoth and Wolke's third-order method, whose nondecreasing nodes make it a slow
+// tableau of third-order multirate (MIS) integration.
+static constexpr ButcherTableau<3> ButcherTableauKnothWolke3 = {
+    {{
+    {0.0, 0.0, 0.0},
+    {1.0/3.0, 0.0, 0.0},
+    {-3.0/16.0, 15.0/16.0, 0.0}
+    }},
+    {1.0/6.0, 3.0/10.0, 8.0/15.0},
+    {0.0, 1.0/3.0, 3.0/4.0}
+};
+static constexpr auto& KnothWolke3 = ButcherTableauKnothWolke3;
+
+// NUMBER OF STAGE UPDATES
+// This function counts the AXPY updates RungeKuttaSolver::solve performs per time
+// step: one per coefficient of A whose magnitude is above the safe tolerance and
+// one per weight.
+template <positiveIntegerType numberOfStages>
+positiveIntegerType number_of_stage_updates(const ButcherTableau<numberOfStages>& butcherTableau){
+    auto safeZero = evaluate_safe_tolerance();
+    positiveIntegerType numberOfUpdates = numberOfStages;
+    for(const auto& row : butcherTableau.A){
+        for(auto coefficient : row){
+            if (std::abs(coefficient) > safeZero) numberOfUpdates++;
+        }
+    }
+    return numberOfUpdates;
+}
+
+// RUNGE KUTTA SOLVER
+// Explicit Runge-Kutta time stepping of y' = F(t, y) for a state with valueType
+// entries, real or complex; the tableau coefficients stay in scalarType. The
+// integration starts at initialTime (zero by default).
+template<positiveIntegerType numberOfStages, typename functionType, ScalarConcept valueType = scalarType>
 class RungeKuttaSolver{
         functionType F;
-        scalarType timeStep;
+        RealType<valueType> timeStep;
         positiveIntegerType numberTimeSteps;
-        ZVector initialState;
+        BasicZVector<valueType> initialState;
         const ButcherTableau<numberOfStages>& butcherTableau;
+        RealType<valueType> initialTime;
     public:
         RungeKuttaSolver() = delete;
         RungeKuttaSolver(const functionType&, 
-                         const ZVector&, 
-                         const scalarType,
+                         const BasicZVector<valueType>&, 
+                         const RealType<valueType>,
                          const integerType,
-                         const ButcherTableau<numberOfStages>&);
+                         const ButcherTableau<numberOfStages>&,
+                         const RealType<valueType> = 0);
         
-        auto solve(std::function<void(integerType, const ZVector&)> = [](integerType, const ZVector&){});
+        auto solve(std::function<void(integerType, const BasicZVector<valueType>&)> = [](integerType, const BasicZVector<valueType>&){});
         
-        auto allocate_stage_buffers();
+        auto allocate_stage_buffers(std::pmr::memory_resource* = nullptr);
 };
 
-template<positiveIntegerType numberOfStages, typename functionType>
-RungeKuttaSolver<numberOfStages, functionType>::RungeKuttaSolver(
+template<positiveIntegerType numberOfStages, typename functionType, ScalarConcept valueType>
+RungeKuttaSolver<numberOfStages, functionType, valueType>::RungeKuttaSolver(
     const functionType& F,
-    const ZVector& initialState,
-    const scalarType timeStep,
+    const BasicZVector<valueType>& initialState,
+    const RealType<valueType> timeStep,
     const integerType numberTimeSteps,
-    const ButcherTableau<numberOfStages>& butcherTableau) : 
+    const ButcherTableau<numberOfStages>& butcherTableau,
+    const RealType<valueType> initialTime) : 
     F(std::move(F)), 
     initialState(initialState.copy()),
     timeStep(timeStep), 
     numberTimeSteps(numberTimeSteps),
-    butcherTableau(butcherTableau) {
+    butcherTableau(butcherTableau),
+    initialTime(initialTime) {
     assert(timeStep > 0);
     assert(numberTimeSteps > 0);
 }
 
-template <positiveIntegerType numberOfStages, typename functionType>
-auto RungeKuttaSolver<numberOfStages, functionType>::solve(std::function<void(integerType, const ZVector&)> callback){
-    scalarType presentTime{0};
+template <positiveIntegerType numberOfStages, typename functionType, ScalarConcept valueType>
+auto RungeKuttaSolver<numberOfStages, functionType, valueType>::solve(std::function<void(integerType, const BasicZVector<valueType>&)> callback){
+    // Vector updates only; the right-hand side is user code.
+    ZLAB_INSTRUMENT("runge_kutta_solve",
+        2.0 * number_of_stage_updates(butcherTableau) * initialState.size() * numberTimeSteps,
+        sizeof(valueType) * 3.0 * number_of_stage_updates(butcherTableau) * initialState.size() * numberTimeSteps);
+    auto presentTime = initialTime;
     
-    auto bufferState = initialState.copy();
-    auto futureState = initialState.copy();
+    // The scratch buffers are recycled from the thread's arena on every call. F
+    // and the callback are user code and keep allocating from the default resource.
     auto presentState = initialState.copy();
-    auto bufferFunction = initialState.copy();
+    ScopedArena arena;
+    auto n = initialState.size();
+    BasicZVector<valueType> bufferState(n, 0, arena.get_resource());
+    BasicZVector<valueType> futureState(n, 0, arena.get_resource());
+    BasicZVector<valueType> bufferFunction(n, 0, arena.get_resource());
+    futureState = initialState;
     
     const auto& [A, b, c] = butcherTableau;
     
-    auto K = allocate_stage_buffers();
+    auto K = allocate_stage_buffers(arena.get_resource());
 
     auto safeZero = evaluate_safe_tolerance();
       
@@ -152,7 +202,7 @@ auto RungeKuttaSolver<numberOfStages, functionType>::solve(std::function<void(in
         for(auto s=0; s < numberOfStages; s++){
             bufferState = presentState;
             for(auto j=0; j < numberOfStages; j++){
-                if(A[s][j] > safeZero) {
+                if(std::abs(A[s][j]) > safeZero) {
                     axpy(A[s][j] * timeStep, K[j], bufferState);
                 }
             }
@@ -168,18 +218,521 @@ auto RungeKuttaSolver<numberOfStages, functionType>::solve(std::function<void(in
     return presentState;
 }
 
-template <positiveIntegerType numberOfStages, typename functionType>
-using RKSolver = RungeKuttaSolver<numberOfStages, functionType>;
+template <positiveIntegerType numberOfStages, typename functionType, ScalarConcept valueType = scalarType>
+using RKSolver = RungeKuttaSolver<numberOfStages, functionType, valueType>;
 
-template <positiveIntegerType numberOfStages, typename functionType>
-auto RungeKuttaSolver<numberOfStages, functionType>::allocate_stage_buffers(){
-    std::vector<ZVector> K;
+template <positiveIntegerType numberOfStages, typename functionType, ScalarConcept valueType>
+auto RungeKuttaSolver<numberOfStages, functionType, valueType>::allocate_stage_buffers(std::pmr::memory_resource* resource){
+    std::vector<BasicZVector<valueType>> K;
     K.reserve(numberOfStages);
     for(auto s=0; s < numberOfStages; s++) {
-        K.emplace_back(initialState.size());
+        K.emplace_back(initialState.size(), 0, resource);
     }
     return K;
 }
 
+// LOW-STORAGE TABLEAUS
+// Compact coefficients of Runge-Kutta methods that never keep their stages.
+// Williamson (2N) form, with a register dq and A[0] = 0:
+//     dq = A[s] * dq + h * F(t + c[s] * h, y),  y = y + B[s] * dq.
+// Two-register Shu-Osher (2S*) form, with S1 = y and the step's start S2 = y_n:
+//     S1 = gamma1[s] * S1 + gamma2[s] * S2 + beta[s] * h * F(t + c[s] * h, S1).
+template <positiveIntegerType numberOfStages_>
+struct LowStorageTableau2N {
+    static constexpr auto numberOfStages = numberOfStages_;
+    std::array<scalarType, numberOfStages_> A;
+    std::array<scalarType, numberOfStages_> B;
+    std::array<scalarType, numberOfStages_> c;
+};
+
+template <positiveIntegerType numberOfStages_>
+struct LowStorageTableau2S {
+    static constexpr auto numberOfStages = numberOfStages_;
+    std::array<scalarType, numberOfStages_> gamma1;
+    std::array<scalarType, numberOfStages_> gamma2;
+    std::array<scalarType, numberOfStages_> beta;
+    std::array<scalarType, numberOfStages_> c;
+};
+
+// Williamson's three-stage, third-order method.
+static constexpr LowStorageTableau2N<3> LowStorageTableauWilliamson3 = {
+    {0.0, -5.0/9.0, -153.0/128.0},
+    {1.0/3.0, 15.0/16.0, 8.0/15.0},
+    {0.0, 1.0/3.0, 3.0/4.0}
+};
+static constexpr auto& LSRK3 = LowStorageTableauWilliamson3;
+
+// Carpenter and Kennedy's five-stage, fourth-order method, LSRK4(5).
+static constexpr LowStorageTableau2N<5> LowStorageTableauCarpenterKennedy4 = {
+    {0.0,
+     -567301805773.0/1357537059087.0,
+     -2404267990393.0/2016746695238.0,
+     -3550918686646.0/2091501179385.0,
+     -1275806237668.0/842570457699.0},
+    {1432997174477.0/9575080441755.0,
+     5161836677717.0/13612068292357.0,
+     1720146321549.0/2090206949498.0,
+     3134564353537.0/4481467310338.0,
+     2277821191437.0/14882151754819.0},
+    {0.0,
+     1432997174477.0/9575080441755.0,
+     2526269341429.0/6820363266374.0,
+     2006345519317.0/3224310063776.0,
+     2802321613138.0/2924317926251.0}
+};
+static constexpr auto& LSRK4 = LowStorageTableauCarpenterKennedy4;
+
+// Shu and Osher's three-stage, third-order SSP method (SSPRK3).
+static constexpr LowStorageTableau2S<3> LowStorageTableauSSPRK3 = {
+    {1.0, 1.0/4.0, 2.0/3.0},
+    {0.0, 3.0/4.0, 1.0/3.0},
+    {1.0, 1.0/4.0, 2.0/3.0},
+    {0.0, 1.0, 0.5}
+};
+static constexpr auto& LowStorageSSPRK3 = LowStorageTableauSSPRK3;
+
+// Five-stage, second-order SSP method with SSP coefficient 4 (SSPRK(5,2)).
+static constexpr LowStorageTableau2S<5> LowStorageTableauSSPRK52 = {
+    {1.0, 1.0, 1.0, 1.0, 4.0/5.0},
+    {0.0, 0.0, 0.0, 0.0, 1.0/5.0},
+    {1.0/4.0, 1.0/4.0, 1.0/4.0, 1.0/4.0, 1.0/5.0},
+    {0.0, 1.0/4.0, 1.0/2.0, 3.0/4.0, 1.0}
+};
+static constexpr auto& LowStorageSSPRK52 = LowStorageTableauSSPRK52;
+
+// LOW STORAGE RUNGE KUTTA SOLVER
+// Explicit Runge-Kutta time stepping of y' = F(t, y) with a LowStorageTableau2N
+// or LowStorageTableau2S. solve advances the given state in place and keeps only
+// two more vectors of its size: the register (dq or y_n) and the output of F,
+// against numberOfStages + 4 for RungeKuttaSolver. Each stage is one evaluation
+// of F followed by a single fused pass over the registers, split over the library
+// thread pool.
+template<typename tableauType, typename functionType, ScalarConcept valueType = scalarType>
+class LowStorageRungeKuttaSolver{
+        functionType F;
+        RealType<valueType> timeStep;
+        positiveIntegerType numberTimeSteps;
+        const tableauType& tableau;
+        RealType<valueType> initialTime;
+
+        template <positiveIntegerType numberOfStages>
+        void step(const LowStorageTableau2N<numberOfStages>&, RealType<valueType>, BasicZVector<valueType>&,
+                  BasicZVector<valueType>&, BasicZVector<valueType>&);
+        template <positiveIntegerType numberOfStages>
+        void step(const LowStorageTableau2S<numberOfStages>&, RealType<valueType>, BasicZVector<valueType>&,
+                  BasicZVector<valueType>&, BasicZVector<valueType>&);
+    public:
+        LowStorageRungeKuttaSolver() = delete;
+        LowStorageRungeKuttaSolver(const functionType&,
+                                   const RealType<valueType>,
+                                   const integerType,
+                                   const tableauType&,
+                                   const RealType<valueType> = 0);
+
+        void solve(BasicZVector<valueType>&,
+                   std::function<void(integerType, const BasicZVector<valueType>&)> = [](integerType, const BasicZVector<valueType>&){});
+};
+
+template<typename tableauType, typename functionType, ScalarConcept valueType>
+LowStorageRungeKuttaSolver<tableauType, functionType, valueType>::LowStorageRungeKuttaSolver(
+    const functionType& F,
+    const RealType<valueType> timeStep,
+    const integerType numberTimeSteps,
+    const tableauType& tableau,
+    const RealType<valueType> initialTime) :
+    F(F),
+    timeStep(timeStep),
+    numberTimeSteps(numberTimeSteps),
+    tableau(tableau),
+    initialTime(initialTime) {
+    assert(timeStep > 0);
+    assert(numberTimeSteps > 0);
+}
+
+template<typename tableauType, typename functionType, ScalarConcept valueType>
+void LowStorageRungeKuttaSolver<tableauType, functionType, valueType>::solve(
+    BasicZVector<valueType>& state,
+    std::function<void(integerType, const BasicZVector<valueType>&)> callback)
+{
+    auto n = state.size();
+    // Vector updates only; the right-hand side is user code.
+    ZLAB_INSTRUMENT("low_storage_runge_kutta_solve",
+        4.0 * tableau.numberOfStages * n * numberTimeSteps,
+        sizeof(valueType) * 5.0 * tableau.numberOfStages * n * numberTimeSteps);
+    // F and the callback are user code; only the registers come from the arena.
+    ScopedArena arena;
+    BasicZVector<valueType> registerState(n, 0, arena.get_resource()), bufferFunction(n, 0, arena.get_resource());
+    auto presentTime = initialTime;
+    for(auto it=0; it < numberTimeSteps; it++){
+        step(tableau, presentTime, state, registerState, bufferFunction);
+        presentTime += timeStep;
+        callback(it, state);
+    }
+}
+
+template<typename tableauType, typename functionType, ScalarConcept valueType>
+template <positiveIntegerType numberOfStages>
+void LowStorageRungeKuttaSolver<tableauType, functionType, valueType>::step(
+    const LowStorageTableau2N<numberOfStages>& lowStorageTableau,
+    RealType<valueType> presentTime,
+    BasicZVector<valueType>& y,
+    BasicZVector<valueType>& dq,
+    BasicZVector<valueType>& f)
+{
+    const auto& [A, B, c] = lowStorageTableau;
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        F(presentTime + c[s] * timeStep, y, f);
+        RealType<valueType> a = A[s], b = B[s];
+        // A[0] = 0 resets the register, whatever it held from the last step.
+        parallel_for(0, y.size(), [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto i=first; i < last; ++i){
+                dq[i] = (s == 0 ? valueType{0} : a * dq[i]) + timeStep * f[i];
+                y[i] += b * dq[i];
+            }
+        }, grain_size(4));
+    }
+}
+
+template<typename tableauType, typename functionType, ScalarConcept valueType>
+template <positiveIntegerType numberOfStages>
+void LowStorageRungeKuttaSolver<tableauType, functionType, valueType>::step(
+    const LowStorageTableau2S<numberOfStages>& lowStorageTableau,
+    RealType<valueType> presentTime,
+    BasicZVector<valueType>& y,
+    BasicZVector<valueType>& initialY,
+    BasicZVector<valueType>& f)
+{
+    const auto& [gamma1, gamma2, beta, c] = lowStorageTableau;
+    initialY = y;
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        F(presentTime + c[s] * timeStep, y, f);
+        RealType<valueType> g1 = gamma1[s], g2 = gamma2[s], bh = beta[s] * timeStep;
+        parallel_for(0, y.size(), [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto i=first; i < last; ++i){
+                y[i] = g1 * y[i] + g2 * initialY[i] + bh * f[i];
+            }
+        }, grain_size(5));
+    }
+}
+
+template <typename tableauType, typename functionType, ScalarConcept valueType = scalarType>
+using LSRKSolver = LowStorageRungeKuttaSolver<tableauType, functionType, valueType>;
+
+// MULTIRATE RUNGE KUTTA SOLVER
+// Multirate infinitesimal step (MIS) integration of y' = F(t, y) for a state whose
+// fastComponents change much faster than the rest. The right-hand side is
+// evaluated by parts: slowF(t, y, f) must set f on the slow components and
+// fastF(t, y, f) on the fast ones (the other entries are ignored), and both
+// receive the whole state; one functor may serve as both. Each slow step of size
+// h runs the explicit slowTableau, whose nodes c must be nondecreasing. Between
+// slow stages i - 1 and i the fast components are advanced over (c[i] - c[i-1]) h
+// with round((c[i] - c[i-1]) * numberOfSubsteps) steps of fastTableau, while the
+// slow components follow the slow stage increments linearly, so fastF is called
+// about numberOfSubsteps times as often as slowF. The method has the order of the
+// slow tableau up to two, and three with KnothWolke3. If fastF reads only a few
+// slow components, listing them as coupledComponents limits the per-substep
+// interpolation to them; fastF then sees the other slow components at their
+// values from the start of the slow stage, and they are advanced once per stage.
+template <positiveIntegerType slowStages, positiveIntegerType fastStages, typename slowFunctionType,
+          typename fastFunctionType, ScalarConcept valueType = scalarType>
+class MultirateRungeKuttaSolver{
+        slowFunctionType slowF;
+        fastFunctionType fastF;
+        std::vector<positiveIntegerType> fastComponents;
+        std::vector<positiveIntegerType> slowComponents;
+        std::vector<positiveIntegerType> coupledComponents;
+        std::vector<positiveIntegerType> uncoupledComponents;
+        RealType<valueType> timeStep;
+        positiveIntegerType numberTimeSteps;
+        positiveIntegerType numberOfSubsteps;
+        BasicZVector<valueType> initialState;
+        const ButcherTableau<slowStages>& slowTableau;
+        const ButcherTableau<fastStages>& fastTableau;
+        RealType<valueType> initialTime;
+
+        void advance_fast(RealType<valueType>, RealType<valueType>, positiveIntegerType, const BasicZVector<valueType>&,
+                          BasicZVector<valueType>&, BasicZVector<valueType>&, std::vector<BasicZVector<valueType>>&);
+    public:
+        MultirateRungeKuttaSolver() = delete;
+        MultirateRungeKuttaSolver(const slowFunctionType&,
+                                  const fastFunctionType&,
+                                  const std::vector<positiveIntegerType>&,
+                                  const BasicZVector<valueType>&,
+                                  const RealType<valueType>,
+                                  const integerType,
+                                  const integerType,
+                                  const ButcherTableau<slowStages>&,
+                                  const ButcherTableau<fastStages>&,
+                                  const RealType<valueType> = 0,
+                                  const std::optional<std::vector<positiveIntegerType>>& = std::nullopt);
+
+        auto solve(std::function<void(integerType, const BasicZVector<valueType>&)> = [](integerType, const BasicZVector<valueType>&){});
+};
+
+template <positiveIntegerType slowStages, positiveIntegerType fastStages, typename slowFunctionType,
+          typename fastFunctionType, ScalarConcept valueType>
+MultirateRungeKuttaSolver<slowStages, fastStages, slowFunctionType, fastFunctionType, valueType>::MultirateRungeKuttaSolver(
+    const slowFunctionType& slowF,
+    const fastFunctionType& fastF,
+    const std::vector<positiveIntegerType>& fastComponents,
+    const BasicZVector<valueType>& initialState,
+    const RealType<valueType> timeStep,
+    const integerType numberTimeSteps,
+    const integerType numberOfSubsteps,
+    const ButcherTableau<slowStages>& slowTableau,
+    const ButcherTableau<fastStages>& fastTableau,
+    const RealType<valueType> initialTime,
+    const std::optional<std::vector<positiveIntegerType>>& coupledComponentsOption) :
+    slowF(slowF),
+    fastF(fastF),
+    fastComponents(fastComponents),
+    timeStep(timeStep),
+    numberTimeSteps(numberTimeSteps),
+    numberOfSubsteps(numberOfSubsteps),
+    initialState(initialState.copy()),
+    slowTableau(slowTableau),
+    fastTableau(fastTableau),
+    initialTime(initialTime) {
+    assert(timeStep > 0);
+    assert(numberTimeSteps > 0);
+    assert(numberOfSubsteps > 0);
+    std::vector<bool> isFast(initialState.size(), false);
+    for(auto component : fastComponents){
+        if (component >= initialState.size() || isFast[component]) {
+            throw std::invalid_argument("Multirate: Fast components must be distinct state indices.");
+        }
+        isFast[component] = true;
+    }
+    for(positiveIntegerType i=0; i < initialState.size(); ++i){
+        if (!isFast[i]) slowComponents.push_back(i);
+    }
+    if (!coupledComponentsOption) {
+        coupledComponents = slowComponents;
+    } else {
+        std::vector<bool> isCoupled(initialState.size(), false);
+        for(auto component : *coupledComponentsOption){
+            if (component >= initialState.size() || isFast[component] || isCoupled[component]) {
+                throw std::invalid_argument("Multirate: Coupled components must be distinct slow state indices.");
+            }
+            isCoupled[component] = true;
+            coupledComponents.push_back(component);
+        }
+        for(auto component : slowComponents){
+            if (!isCoupled[component]) uncoupledComponents.push_back(component);
+        }
+    }
+    for(positiveIntegerType s=1; s < slowStages; ++s){
+        if (slowTableau.c[s] < slowTableau.c[s-1] || slowTableau.c[s] > 1) {
+            throw std::invalid_argument("Multirate: The slow tableau nodes must be nondecreasing in [0, 1].");
+        }
+    }
+}
+
+// Advances the fast components of y over [t, t + length] in numberOfFastSteps steps
+// of the fast tableau, with the slow components moving at the constant rate
+// slowRate (the uncoupled ones in a single update at the end).
+template <positiveIntegerType slowStages, positiveIntegerType fastStages, typename slowFunctionType,
+          typename fastFunctionType, ScalarConcept valueType>
+void MultirateRungeKuttaSolver<slowStages, fastStages, slowFunctionType, fastFunctionType, valueType>::advance_fast(
+    RealType<valueType> t,
+    RealType<valueType> length,
+    positiveIntegerType numberOfFastSteps,
+    const BasicZVector<valueType>& slowRate,
+    BasicZVector<valueType>& y,
+    BasicZVector<valueType>& stageState,
+    std::vector<BasicZVector<valueType>>& K)
+{
+    const auto& [A, b, c] = fastTableau;
+    auto fastStep = length / numberOfFastSteps;
+    // The uncoupled slow components are frozen at their stage-start values.
+    for(auto i : uncoupledComponents){
+        stageState[i] = y[i];
+    }
+    for(positiveIntegerType step=0; step < numberOfFastSteps; ++step){
+        for(positiveIntegerType q=0; q < fastStages; ++q){
+            for(auto i : fastComponents){
+                auto value = y[i];
+                for(positiveIntegerType r=0; r < q; ++r){
+                    value += fastStep * A[q][r] * K[r][i];
+                }
+                stageState[i] = value;
+            }
+            for(auto i : coupledComponents){
+                stageState[i] = y[i] + c[q] * fastStep * slowRate[i];
+            }
+            fastF(t + c[q] * fastStep, stageState, K[q]);
+        }
+        for(auto i : fastComponents){
+            for(positiveIntegerType q=0; q < fastStages; ++q){
+                y[i] += fastStep * b[q] * K[q][i];
+            }
+        }
+        for(auto i : coupledComponents){
+            y[i] += fastStep * slowRate[i];
+        }
+        t += fastStep;
+    }
+    for(auto i : uncoupledComponents){
+        y[i] += length * slowRate[i];
+    }
+}
+
+template <positiveIntegerType slowStages, positiveIntegerType fastStages, typename slowFunctionType,
+          typename fastFunctionType, ScalarConcept valueType>
+auto MultirateRungeKuttaSolver<slowStages, fastStages, slowFunctionType, fastFunctionType, valueType>::solve(
+    std::function<void(integerType, const BasicZVector<valueType>&)> callback)
+{
+    // Vector updates only; the right-hand sides are user code.
+    ZLAB_INSTRUMENT("multirate_runge_kutta_solve", 0, 0);
+    auto n = initialState.size();
+    auto presentState = initialState.copy();
+    // Both right-hand sides and the callback are user code; only the solver's
+    // buffers come from the arena.
+    ScopedArena arena;
+    auto resource = arena.get_resource();
+    BasicZVector<valueType> stageState(n, 0, resource), fastStageState(n, 0, resource), slowRate(n, 0, resource);
+    std::vector<BasicZVector<valueType>> slowK, fastK;
+    slowK.reserve(slowStages);
+    fastK.reserve(fastStages);
+    for(positiveIntegerType s=0; s < slowStages; ++s) slowK.emplace_back(n, 0, resource);
+    for(positiveIntegerType s=0; s < fastStages; ++s) fastK.emplace_back(n, 0, resource);
+    const auto& [A, b, c] = slowTableau;
+
+    auto presentTime = initialTime;
+    for(auto it=0; it < numberTimeSteps; it++){
+        // Stage i starts from stage i - 1; the last pass (i = slowStages) uses the
+        // weights and ends the step at c = 1.
+        stageState = presentState;
+        slowF(presentTime, stageState, slowK[0]);
+        for(positiveIntegerType i=1; i <= slowStages; ++i){
+            auto previousNode = c[i-1];
+            auto node = i < slowStages ? c[i] : scalarType{1};
+            auto deltaNode = node - previousNode;
+            slowRate.fill(0);
+            for(positiveIntegerType j=0; j < i; ++j){
+                auto coefficient = (i < slowStages ? A[i][j] : b[j]) - A[i-1][j];
+                if (coefficient == 0) continue;
+                for(auto k : slowComponents){
+                    slowRate[k] += coefficient * slowK[j][k];
+                }
+            }
+            auto numberOfFastSteps = static_cast<positiveIntegerType>(std::lround(deltaNode * numberOfSubsteps));
+            if (deltaNode == 0) {
+                // Coincident nodes: only the slow increment remains.
+                for(auto k : slowComponents){
+                    stageState[k] += timeStep * slowRate[k];
+                }
+            } else {
+                scale(slowRate, 1 / deltaNode);
+                advance_fast(presentTime + previousNode * timeStep, deltaNode * timeStep,
+                    std::max<positiveIntegerType>(numberOfFastSteps, 1), slowRate, stageState, fastStageState, fastK);
+            }
+            if (i < slowStages) slowF(presentTime + node * timeStep, stageState, slowK[i]);
+        }
+        presentState = stageState;
+        presentTime += timeStep;
+        callback(it, presentState);
+    }
+    return presentState;
+}
+
+template <positiveIntegerType slowStages, positiveIntegerType fastStages, typename slowFunctionType,
+          typename fastFunctionType, ScalarConcept valueType = scalarType>
+using MRKSolver = MultirateRungeKuttaSolver<slowStages, fastStages, slowFunctionType, fastFunctionType, valueType>;
+
+template <ScalarConcept valueType>
+struct PararealSolution {
+    std::vector<BasicZVector<valueType>> states;
+    positiveIntegerType numberOfIterations;
+    RealType<valueType> correctionNorm;
+};
+
+// PARAREAL (Parallel-in-Time Integration)
+// This function integrates y' = F(t, y) from t = 0 to finalTime over numberOfSlices
+// time slices. A cheap coarse propagator G (coarseTableau, coarseStepsPerSlice
+// steps per slice) is swept sequentially, and the accurate fine propagator F
+// (fineTableau, fineStepsPerSlice steps) runs on all unconverged slices
+// concurrently on the library thread pool. The update is
+// U[n+1] = G(U[n]) + F(U_old[n]) - G(U_old[n]). After k iterations the first k
+// slices equal the sequential fine solution, so they are not propagated again,
+// and the result is exact after numberOfSlices iterations. The iteration stops
+// earlier, when the largest correction is below sqrt(safe tolerance) relative to
+// the state. states[n] is the solution at n * finalTime / numberOfSlices. F must
+// be safe to call concurrently.
+template <positiveIntegerType coarseStages, positiveIntegerType fineStages, typename functionType, ScalarConcept valueType>
+PararealSolution<valueType> parareal(
+    const functionType& F,
+    const BasicZVector<valueType>& initialState,
+    const RealType<valueType> finalTime,
+    const positiveIntegerType numberOfSlices,
+    const ButcherTableau<coarseStages>& coarseTableau,
+    const positiveIntegerType coarseStepsPerSlice,
+    const ButcherTableau<fineStages>& fineTableau,
+    const positiveIntegerType fineStepsPerSlice,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    assert(finalTime > 0 && numberOfSlices > 0);
+    assert(coarseStepsPerSlice > 0 && fineStepsPerSlice > 0);
+    auto n = initialState.size();
+    // The propagations report themselves as runge_kutta_solve.
+    ZLAB_INSTRUMENT("parareal", 0, 0);
+    auto sliceLength = finalTime / numberOfSlices;
+    auto tolerance = std::sqrt(evaluate_safe_tolerance(marginOfError));
+    auto coarse = [&](positiveIntegerType slice, const BasicZVector<valueType>& state){
+        RungeKuttaSolver<coarseStages, functionType, valueType> solver(F, state,
+            sliceLength / coarseStepsPerSlice, coarseStepsPerSlice, coarseTableau, slice * sliceLength);
+        return solver.solve();
+    };
+    auto fine = [&](positiveIntegerType slice, const BasicZVector<valueType>& state){
+        RungeKuttaSolver<fineStages, functionType, valueType> solver(F, state,
+            sliceLength / fineStepsPerSlice, fineStepsPerSlice, fineTableau, slice * sliceLength);
+        return solver.solve();
+    };
+
+    PararealSolution<valueType> solution{{}, 0, 0};
+    std::vector<BasicZVector<valueType>> coarseStates, fineStates;
+    solution.states.reserve(numberOfSlices + 1);
+    coarseStates.reserve(numberOfSlices);
+    fineStates.reserve(numberOfSlices);
+    solution.states.push_back(initialState.copy());
+    for(positiveIntegerType slice=0; slice < numberOfSlices; ++slice){
+        coarseStates.push_back(coarse(slice, solution.states[slice]));
+        solution.states.push_back(coarseStates[slice].copy());
+        fineStates.emplace_back(n);
+    }
+    BasicZVector<valueType> correctedState(n);
+    for(positiveIntegerType iteration=0; iteration < numberOfSlices; ++iteration){
+        // Slices before the iteration index already hold the fine solution.
+        parallel_for(iteration, numberOfSlices, [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto slice=first; slice < last; ++slice){
+                fineStates[slice] = fine(slice, solution.states[slice]);
+            }
+        }, 1);
+        solution.numberOfIterations = iteration + 1;
+        solution.correctionNorm = 0;
+        RealType<valueType> stateNorm{0};
+        for(auto slice=iteration; slice < numberOfSlices; ++slice){
+            if (slice == iteration) {
+                // The start of the first unconverged slice is exact, so its end is the fine value.
+                correctedState = fineStates[slice];
+            } else {
+                auto coarseState = coarse(slice, solution.states[slice]);
+                correctedState = coarseState;
+                axpy(1, fineStates[slice], correctedState);
+                axpy(-1, coarseStates[slice], correctedState);
+                coarseStates[slice] = coarseState;
+            }
+            auto& state = solution.states[slice + 1];
+            for(positiveIntegerType i=0; i < n; ++i){
+                solution.correctionNorm = std::max(solution.correctionNorm, std::abs(correctedState[i] - state[i]));
+            }
+            state = correctedState;
+            stateNorm = std::max(stateNorm, norm_infinity(state));
+        }
+        if (solution.correctionNorm <= tolerance * (stateNorm + tolerance)) break;
+    }
+    return solution;
+}
+
 } // end namespace zlab
 
@@ -0,0 +1,2 @@
+
+#include "ode_adjoint.hpp"
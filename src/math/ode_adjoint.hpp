@@ -0,0 +1,262 @@
+
+#pragma once
+
+#include <functional>
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+#include "core.hpp"
+#include "matrix.hpp"
+#include "ode.hpp"
+
+namespace zlab{
+
+template <RealScalarConcept valueType>
+struct RungeKuttaGradient {
+    BasicZVector<valueType> finalState;
+    BasicZVector<valueType> stateGradient;
+    BasicZVector<valueType> parameterGradient;
+    positiveIntegerType numberOfForwardSteps;
+};
+
+// CHECKPOINT BINOMIAL
+// This function returns (snapshots + repetitions)! / (snapshots! repetitions!), the
+// largest number of steps that can be reversed with the given number of stored
+// states when no step is advanced more than repetitions times.
+inline positiveIntegerType checkpoint_binomial(integerType snapshots, integerType repetitions){
+    if (snapshots < 0 || repetitions < 0) return 0;
+    positiveIntegerType binomial = 1;
+    auto k = std::min(snapshots, repetitions);
+    for(integerType i=1; i <= k; ++i){
+        binomial = binomial * (snapshots + repetitions - k + i) / i;
+    }
+    return binomial;
+}
+
+// CHECKPOINT SPLIT (Binomial Checkpointing)
+// This function returns how many steps to advance before storing the next
+// checkpoint when numberOfSteps steps have to be reversed from one stored state
+// with numberOfSnapshots more states to spare (Griewank's revolve). With r the
+// smallest number of repetitions such that beta(s + 1, r) >= l, the split is
+// min(beta(s + 1, r - 1), l - beta(s, r - 1)), which minimizes the number of
+// recomputed steps.
+inline positiveIntegerType checkpoint_split(positiveIntegerType numberOfSteps, positiveIntegerType numberOfSnapshots){
+    assert(numberOfSteps > 1 && numberOfSnapshots > 0);
+    integerType snapshots = numberOfSnapshots + 1;
+    integerType repetitions = 0;
+    while (checkpoint_binomial(snapshots, repetitions) < numberOfSteps) repetitions++;
+    auto split = std::min(checkpoint_binomial(snapshots, repetitions - 1),
+                          numberOfSteps - checkpoint_binomial(snapshots - 1, repetitions - 1));
+    return std::clamp<positiveIntegerType>(split, 1, numberOfSteps - 1);
+}
+
+// ADJOINT RUNGE KUTTA SOLVER
+// Gradients of an objective g(y_N) of the explicit Runge-Kutta trajectory of
+// y' = F(t, y; p), with respect to the initial state and the parameters p, by the
+// discrete adjoint of the tableau: the exact gradient of the computed y_N. The
+// right-hand side is differentiated through vectorJacobianProduct(t, y, w, wy, wp),
+// which must set wy = (dF/dy)^T w and wp = (dF/dp)^T w (p has at least one entry).
+// The trajectory is never stored: at most numberOfCheckpoints states (y_0 included)
+// are kept, placed by binomial checkpointing, and the other states are recomputed.
+// With c checkpoints and N steps each step is recomputed at most r times, for the
+// smallest r with (c + r)! / (c! r!) >= N, so O(log N) checkpoints cost O(log N)
+// recomputations per step. Each reversed step keeps 3 * numberOfStages vectors.
+template <positiveIntegerType numberOfStages, typename functionType, typename vectorJacobianProductType,
+          RealScalarConcept valueType = scalarType>
+class AdjointRungeKuttaSolver{
+        functionType F;
+        vectorJacobianProductType vectorJacobianProduct;
+        valueType timeStep;
+        positiveIntegerType numberTimeSteps;
+        positiveIntegerType numberOfParameters;
+        BasicZVector<valueType> initialState;
+        const ButcherTableau<numberOfStages>& butcherTableau;
+        valueType initialTime;
+        std::vector<BasicZVector<valueType>> checkpoints, stageStates, K, stageAdjoints;
+        BasicZVector<valueType> workState, bufferState, stageWeights, adjoint, parameterBuffer;
+        positiveIntegerType numberOfForwardSteps;
+
+        void advance(positiveIntegerType, BasicZVector<valueType>&, bool);
+        void reverse_step(positiveIntegerType, RungeKuttaGradient<valueType>&,
+                          const std::function<void(const BasicZVector<valueType>&, BasicZVector<valueType>&)>&);
+        void reverse(positiveIntegerType, positiveIntegerType, positiveIntegerType, RungeKuttaGradient<valueType>&,
+                     const std::function<void(const BasicZVector<valueType>&, BasicZVector<valueType>&)>&);
+    public:
+        AdjointRungeKuttaSolver() = delete;
+        AdjointRungeKuttaSolver(const functionType&,
+                                const vectorJacobianProductType&,
+                                const BasicZVector<valueType>&,
+                                const valueType,
+                                const integerType,
+                                const ButcherTableau<numberOfStages>&,
+                                const integerType,
+                                const integerType,
+                                const valueType = 0);
+
+        RungeKuttaGradient<valueType> gradient(const std::function<void(const BasicZVector<valueType>&, BasicZVector<valueType>&)>&);
+};
+
+template <positiveIntegerType numberOfStages, typename functionType, typename vectorJacobianProductType, RealScalarConcept valueType>
+AdjointRungeKuttaSolver<numberOfStages, functionType, vectorJacobianProductType, valueType>::AdjointRungeKuttaSolver(
+    const functionType& F,
+    const vectorJacobianProductType& vectorJacobianProduct,
+    const BasicZVector<valueType>& initialState,
+    const valueType timeStep,
+    const integerType numberTimeSteps,
+    const ButcherTableau<numberOfStages>& butcherTableau,
+    const integerType numberOfParameters,
+    const integerType numberOfCheckpoints,
+    const valueType initialTime) :
+    F(F),
+    vectorJacobianProduct(vectorJacobianProduct),
+    timeStep(timeStep),
+    numberTimeSteps(numberTimeSteps),
+    numberOfParameters(numberOfParameters),
+    initialState(initialState.copy()),
+    butcherTableau(butcherTableau),
+    initialTime(initialTime),
+    workState(initialState.size()),
+    bufferState(initialState.size()),
+    stageWeights(initialState.size()),
+    adjoint(initialState.size()),
+    parameterBuffer(numberOfParameters),
+    numberOfForwardSteps(0) {
+    assert(timeStep > 0);
+    assert(numberTimeSteps > 0);
+    assert(numberOfParameters > 0);
+    assert(numberOfCheckpoints > 0);
+    auto n = initialState.size();
+    // More checkpoints than steps would never be used.
+    auto numberOfStoredStates = std::min<positiveIntegerType>(numberOfCheckpoints, numberTimeSteps);
+    checkpoints.reserve(numberOfStoredStates);
+    for(positiveIntegerType c=0; c < numberOfStoredStates; ++c) checkpoints.emplace_back(n);
+    stageStates.reserve(numberOfStages);
+    K.reserve(numberOfStages);
+    stageAdjoints.reserve(numberOfStages);
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        stageStates.emplace_back(n);
+        K.emplace_back(n);
+        stageAdjoints.emplace_back(n);
+    }
+}
+
+// Advances y from step n to step n + 1, keeping the stage states in stageStates
+// when isReversing is set.
+template <positiveIntegerType numberOfStages, typename functionType, typename vectorJacobianProductType, RealScalarConcept valueType>
+void AdjointRungeKuttaSolver<numberOfStages, functionType, vectorJacobianProductType, valueType>::advance(
+    positiveIntegerType n,
+    BasicZVector<valueType>& y,
+    bool isReversing)
+{
+    const auto& [A, b, c] = butcherTableau;
+    auto presentTime = initialTime + n * timeStep;
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        auto& stageState = isReversing ? stageStates[s] : bufferState;
+        stageState = y;
+        for(positiveIntegerType j=0; j < s; ++j){
+            if (A[s][j] != 0) axpy(timeStep * A[s][j], K[j], stageState);
+        }
+        F(presentTime + c[s] * timeStep, stageState, K[s]);
+    }
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        if (b[s] != 0) axpy(timeStep * b[s], K[s], y);
+    }
+    numberOfForwardSteps++;
+}
+
+// Recomputes step n from the state in workState and pulls the adjoint back
+// through it: with nu_s = h * (b_s * lambda + sum_{i>s} a_is * mu_i), the stage
+// adjoints are mu_s = (dF/dy(Y_s))^T nu_s, lambda becomes lambda + sum_s mu_s and
+// the parameter gradient gains sum_s (dF/dp(Y_s))^T nu_s.
+template <positiveIntegerType numberOfStages, typename functionType, typename vectorJacobianProductType, RealScalarConcept valueType>
+void AdjointRungeKuttaSolver<numberOfStages, functionType, vectorJacobianProductType, valueType>::reverse_step(
+    positiveIntegerType n,
+    RungeKuttaGradient<valueType>& result,
+    const std::function<void(const BasicZVector<valueType>&, BasicZVector<valueType>&)>& terminalGradient)
+{
+    const auto& [A, b, c] = butcherTableau;
+    advance(n, workState, true);
+    if (n + 1 == numberTimeSteps) {
+        // The first step reversed is the last one, which yields y_N and the seed.
+        result.finalState = workState;
+        terminalGradient(result.finalState, adjoint);
+    }
+    auto presentTime = initialTime + n * timeStep;
+    for(positiveIntegerType s=numberOfStages; s-- > 0;){
+        stageWeights.fill(0);
+        if (b[s] != 0) axpy(timeStep * b[s], adjoint, stageWeights);
+        for(auto i=s + 1; i < numberOfStages; ++i){
+            if (A[i][s] != 0) axpy(timeStep * A[i][s], stageAdjoints[i], stageWeights);
+        }
+        vectorJacobianProduct(presentTime + c[s] * timeStep, stageStates[s], stageWeights, stageAdjoints[s], parameterBuffer);
+        axpy(1, parameterBuffer, result.parameterGradient);
+    }
+    for(positiveIntegerType s=0; s < numberOfStages; ++s){
+        axpy(1, stageAdjoints[s], adjoint);
+    }
+}
+
+// Reverses steps [first, last) from the state of step first, held in checkpoint
+// slot. The right part is reversed first from a new checkpoint placed by
+// checkpoint_split, then the left part from the same slot.
+template <positiveIntegerType numberOfStages, typename functionType, typename vectorJacobianProductType, RealScalarConcept valueType>
+void AdjointRungeKuttaSolver<numberOfStages, functionType, vectorJacobianProductType, valueType>::reverse(
+    positiveIntegerType first,
+    positiveIntegerType last,
+    positiveIntegerType slot,
+    RungeKuttaGradient<valueType>& result,
+    const std::function<void(const BasicZVector<valueType>&, BasicZVector<valueType>&)>& terminalGradient)
+{
+    while (last - first > 1) {
+        auto numberOfSnapshots = checkpoints.size() - 1 - slot;
+        if (numberOfSnapshots == 0) {
+            // No state to spare: every step is recomputed from the slot.
+            for(auto n=last - 1; n > first; --n){
+                workState = checkpoints[slot];
+                for(auto k=first; k < n; ++k){
+                    advance(k, workState, false);
+                }
+                reverse_step(n, result, terminalGradient);
+            }
+            last = first + 1;
+            break;
+        }
+        auto middle = first + checkpoint_split(last - first, numberOfSnapshots);
+        checkpoints[slot + 1] = checkpoints[slot];
+        for(auto k=first; k < middle; ++k){
+            advance(k, checkpoints[slot + 1], false);
+        }
+        reverse(middle, last, slot + 1, result, terminalGradient);
+        last = middle;
+    }
+    workState = checkpoints[slot];
+    reverse_step(first, result, terminalGradient);
+}
+
+template <positiveIntegerType numberOfStages, typename functionType, typename vectorJacobianProductType, RealScalarConcept valueType>
+RungeKuttaGradient<valueType> AdjointRungeKuttaSolver<numberOfStages, functionType, vectorJacobianProductType, valueType>::gradient(
+    const std::function<void(const BasicZVector<valueType>&, BasicZVector<valueType>&)>& terminalGradient)
+{
+    auto n = initialState.size();
+    // The right-hand side and its products are user code; the updates are counted.
+    ZLAB_INSTRUMENT("adjoint_runge_kutta_gradient", 0, 0);
+    RungeKuttaGradient<valueType> result{
+        BasicZVector<valueType>(n),
+        BasicZVector<valueType>(n),
+        BasicZVector<valueType>(numberOfParameters),
+        0};
+    numberOfForwardSteps = 0;
+    adjoint.fill(0);
+    checkpoints[0] = initialState;
+    reverse(0, numberTimeSteps, 0, result, terminalGradient);
+    result.stateGradient = adjoint;
+    result.numberOfForwardSteps = numberOfForwardSteps;
+    return result;
+}
+
+template <positiveIntegerType numberOfStages, typename functionType, typename vectorJacobianProductType,
+          RealScalarConcept valueType = scalarType>
+using AdjointRKSolver = AdjointRungeKuttaSolver<numberOfStages, functionType, vectorJacobianProductType, valueType>;
+
+} // end namespace zlab
@@ -0,0 +1,2 @@
+
+#include "qr_update.hpp"
@@ -0,0 +1,307 @@
+
+#pragma once
+
+#include <stdexcept>
+#include <optional>
+#include <utility>
+#include <vector>
+#include <cmath>
+
+#include "matrix.hpp"
+#include "solvers.hpp"
+#include "core.hpp"
+
+namespace zlab{
+
+// GIVENS ROTATION
+// This function applies to the rows x and y, from entry first on, the plane
+// rotation that maps (x[first], y[first]) to (hypot(x[first], y[first]), 0).
+template <VectorConcept vectorTypeX, VectorConcept vectorTypeY>
+void apply_givens_rotation(vectorTypeX& x, vectorTypeY& y, positiveIntegerType first){
+    assert(x.size() == y.size());
+    auto r = std::hypot(x[first], y[first]);
+    if (r == 0) return;
+    auto c = x[first] / r;
+    auto s = y[first] / r;
+    for(auto j=first; j < x.size(); ++j){
+        auto xj = x[j];
+        x[j] = c * xj + s * y[j];
+        y[j] = c * y[j] - s * xj;
+    }
+    y[first] = 0;
+}
+
+// HYPERBOLIC ROTATION
+// This function applies to the rows x and y, from entry first on, the hyperbolic
+// rotation that maps (x[first], y[first]) to (sqrt(x[first]^2 - y[first]^2), 0),
+// i.e. it removes y from the Gram matrix of the rows. The mixed form (each new y
+// is formed from the new x) keeps the downdate stable. It returns false and leaves
+// both rows untouched when x[first]^2 - y[first]^2 is not safely positive.
+template <VectorConcept vectorTypeX, VectorConcept vectorTypeY>
+bool apply_hyperbolic_rotation(
+    vectorTypeX& x,
+    vectorTypeY& y,
+    positiveIntegerType first,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    assert(x.size() == y.size());
+    auto r = x[first];
+    auto t = y[first];
+    if (t == 0) return true;
+    auto tolerance = evaluate_safe_tolerance<VectorValueType<vectorTypeX>>(marginOfError) * std::abs(r);
+    auto rhoSquared = (r - t) * (r + t);
+    if (!(rhoSquared > tolerance * tolerance)) return false;
+    auto rho = std::sqrt(rhoSquared);
+    auto c = rho / r;
+    auto s = t / r;
+    x[first] = rho;
+    y[first] = 0;
+    for(auto j=first+1; j < x.size(); ++j){
+        x[j] = (x[j] - s * y[j]) / c;
+        y[j] = c * y[j] - s * x[j];
+    }
+    return true;
+}
+
+// QR FACTORIZATION (Updatable Least-Squares Factorization)
+// This class keeps the triangular factor of min ||A * x - b|| while rows of [A b]
+// enter or leave and columns of A are appended or removed, without storing Q or A.
+// It holds the (n + 1) x (n + 1) upper triangular factor of [A b]: R in the
+// leading n x n block, Q^T * b in the last column and the residual norm in the
+// corner. Rows are inserted with Givens and removed with hyperbolic rotations,
+// columns are removed by restoring the triangle with Givens rotations, all in
+// O(n^2) operations per change; the solution is one backward substitution away.
+// A failed update throws and leaves the factorization unchanged.
+template <RealScalarConcept valueType = scalarType>
+class QRFactorization{
+        positiveIntegerType numberOfColumns;
+        positiveIntegerType numberOfRows{0};
+        std::vector<valueType> elements;
+        std::optional<scalarType> marginOfError;
+
+        BasicMatrixView<valueType> augmented_factor() { return {elements.data(), numberOfColumns + 1, numberOfColumns + 1}; }
+        BasicMatrixView<const valueType> augmented_factor() const { return {elements.data(), numberOfColumns + 1, numberOfColumns + 1}; }
+    public:
+        QRFactorization() = delete;
+        explicit QRFactorization(positiveIntegerType, std::optional<scalarType> = std::nullopt);
+
+        template <MatrixConcept matrixType, VectorConcept vectorType>
+        QRFactorization(const matrixType&, const vectorType&, std::optional<scalarType> = std::nullopt);
+
+        template <VectorConcept vectorType>
+        void insert_row(const vectorType&, valueType);
+
+        template <VectorConcept vectorType>
+        void remove_row(const vectorType&, valueType);
+
+        template <MatrixConcept matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeC>
+        void append_column(const matrixType&, const vectorTypeB&, const vectorTypeC&);
+
+        void remove_column(positiveIntegerType);
+
+        template <VectorConcept vectorTypeX>
+        void solve(vectorTypeX&) const;
+
+        BasicMatrixView<const valueType> get_R() const { return augmented_factor().block_view(0, 0, numberOfColumns, numberOfColumns); }
+        BasicVectorView<const valueType> get_Qtb() const {
+            return augmented_factor().column_view(numberOfColumns).subvector_view(0, numberOfColumns);
+        }
+        valueType get_residual_norm() const { return elements.back(); }
+        positiveIntegerType get_number_of_rows() const { return numberOfRows; }
+        positiveIntegerType get_number_of_columns() const { return numberOfColumns; }
+};
+
+template <MatrixConcept matrixType, VectorConcept vectorType>
+QRFactorization(const matrixType&, const vectorType&) -> QRFactorization<MatrixValueType<matrixType>>;
+
+template <MatrixConcept matrixType, VectorConcept vectorType>
+QRFactorization(const matrixType&, const vectorType&, std::optional<scalarType>) -> QRFactorization<MatrixValueType<matrixType>>;
+
+template <RealScalarConcept valueType>
+QRFactorization<valueType>::QRFactorization(
+    positiveIntegerType numberOfColumns,
+    std::optional<scalarType> marginOfError) :
+    numberOfColumns(numberOfColumns),
+    elements((numberOfColumns + 1) * (numberOfColumns + 1)),
+    marginOfError(marginOfError) {}
+
+template <RealScalarConcept valueType>
+template <MatrixConcept matrixType, VectorConcept vectorType>
+QRFactorization<valueType>::QRFactorization(
+    const matrixType& A,
+    const vectorType& b,
+    std::optional<scalarType> marginOfError) :
+    QRFactorization(A.get_number_of_columns(), marginOfError) {
+    auto m = A.get_number_of_rows();
+    auto n = numberOfColumns;
+    assert(b.size() == m);
+    if (m < n) {
+        BasicZVector<valueType> row(n);
+        for(positiveIntegerType i=0; i < m; ++i){
+            for(positiveIntegerType j=0; j < n; ++j){
+                row[j] = A(i,j);
+            }
+            insert_row(row, b[i]);
+        }
+        return;
+    }
+    BasicZMatrix<valueType> B(m, 1);
+    for(positiveIntegerType i=0; i < m; ++i){
+        B(i,0) = b[i];
+    }
+    auto [R, QtB, residualNorms] = qr_least_squares_factors(A, B);
+    auto factor = augmented_factor();
+    // Rows are flipped to a nonnegative diagonal, which the rotations rely on.
+    for(positiveIntegerType i=0; i < n; ++i){
+        valueType sign = R(i,i) < 0 ? -1 : 1;
+        for(auto j=i; j < n; ++j){
+            factor(i,j) = sign * R(i,j);
+        }
+        factor(i,n) = sign * QtB(i,0);
+    }
+    factor(n,n) = residualNorms[0];
+    numberOfRows = m;
+}
+
+// INSERT ROW
+// This function adds the row [a^T beta] to [A b] by rotating it into the factor.
+template <RealScalarConcept valueType>
+template <VectorConcept vectorType>
+void QRFactorization<valueType>::insert_row(const vectorType& row, valueType rightHandSide){
+    auto n = numberOfColumns;
+    assert(row.size() == n);
+    ZLAB_INSTRUMENT("qr_update_row", 3.0 * (n + 1) * (n + 1), sizeof(valueType) * (n + 1) * (n + 1));
+    BasicZVector<valueType> w(n + 1);
+    for(positiveIntegerType j=0; j < n; ++j){
+        w[j] = row[j];
+    }
+    w[n] = rightHandSide;
+    auto factor = augmented_factor();
+    for(positiveIntegerType k=0; k <= n; ++k){
+        auto factorRow = factor.row_view(k);
+        apply_givens_rotation(factorRow, w, k);
+    }
+    ++numberOfRows;
+}
+
+// REMOVE ROW
+// This function removes a row [a^T beta] that was part of [A b] with hyperbolic
+// rotations. It throws when the remaining rows no longer have full column rank.
+template <RealScalarConcept valueType>
+template <VectorConcept vectorType>
+void QRFactorization<valueType>::remove_row(const vectorType& row, valueType rightHandSide){
+    auto n = numberOfColumns;
+    assert(row.size() == n && numberOfRows > 0);
+    ZLAB_INSTRUMENT("qr_update_row", 3.0 * (n + 1) * (n + 1), sizeof(valueType) * 2.0 * (n + 1) * (n + 1));
+    BasicZVector<valueType> w(n + 1);
+    for(positiveIntegerType j=0; j < n; ++j){
+        w[j] = row[j];
+    }
+    w[n] = rightHandSide;
+    auto downdated = elements;
+    BasicMatrixView<valueType> factor(downdated.data(), n + 1, n + 1);
+    for(positiveIntegerType k=0; k < n; ++k){
+        auto factorRow = factor.row_view(k);
+        if (!apply_hyperbolic_rotation(factorRow, w, k, marginOfError)) {
+            throw std::runtime_error("QR: Removing the row leaves the matrix rank-deficient.");
+        }
+    }
+    // The residual may vanish (e.g. n rows left), so its downdate is clamped at zero.
+    factor(n,n) = std::sqrt(std::max(valueType{0}, (factor(n,n) - w[n]) * (factor(n,n) + w[n])));
+    elements = std::move(downdated);
+    --numberOfRows;
+}
+
+// APPEND COLUMN
+// This function appends the column c to A, given the current rows of A and b in
+// any order (A^T * c and b^T * c are the only O(m * n) work). The new column of
+// the factor of [A c b] comes from R^T * r = [A b]^T * c (semi-normal equations),
+// so it is accurate when [A c] is well conditioned; the column moves in front of
+// b with one Givens rotation. It throws when c is numerically in the span of A.
+template <RealScalarConcept valueType>
+template <MatrixConcept matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeC>
+void QRFactorization<valueType>::append_column(const matrixType& A, const vectorTypeB& b, const vectorTypeC& column){
+    auto n = numberOfColumns;
+    assert(A.get_number_of_rows() == numberOfRows && A.get_number_of_columns() == n);
+    assert(b.size() == numberOfRows && column.size() == numberOfRows);
+    ZLAB_INSTRUMENT("qr_update_column", 2.0 * numberOfRows * (n + 2) + 1.0 * n * n, sizeof(valueType) * (numberOfRows * (n + 2) + 2.0 * n * n));
+    BasicZVector<valueType> r(n);
+    if (n > 0) {
+        gemv(A, column, r, 1, 0, true);
+        forward_substitution(get_R(), r, r, marginOfError, true);
+    }
+    auto factor = augmented_factor();
+    auto residualNorm = factor(n,n);
+    valueType residualComponent{0};
+    if (residualNorm > 0) {
+        residualComponent = dot(b, column);
+        for(positiveIntegerType i=0; i < n; ++i){
+            residualComponent -= factor(i,n) * r[i];
+        }
+        residualComponent /= residualNorm;
+    }
+    auto columnNorm = norm2(column);
+    auto rho = std::sqrt(std::max(valueType{0}, columnNorm * columnNorm - dot(r, r) - residualComponent * residualComponent));
+    if (!(std::hypot(rho, residualComponent) > evaluate_safe_tolerance<valueType>(marginOfError) * columnNorm)) {
+        throw std::runtime_error("QR: Appended column is linearly dependent on the current columns.");
+    }
+    // Factor of [A c b]: the new column sits in column n, b moves to column n + 1.
+    std::vector<valueType> appended((n + 2) * (n + 2));
+    BasicMatrixView<valueType> extended(appended.data(), n + 2, n + 2);
+    for(positiveIntegerType i=0; i <= n; ++i){
+        for(auto j=i; j < n; ++j){
+            extended(i,j) = factor(i,j);
+        }
+        extended(i, n + 1) = factor(i,n);
+    }
+    for(positiveIntegerType i=0; i < n; ++i){
+        extended(i,n) = r[i];
+    }
+    extended(n,n) = residualComponent;
+    extended(n + 1, n) = rho;
+    auto rowN = extended.row_view(n);
+    auto rowN1 = extended.row_view(n + 1);
+    apply_givens_rotation(rowN, rowN1, n);
+    if (extended(n + 1, n + 1) < 0) extended(n + 1, n + 1) = -extended(n + 1, n + 1);
+    elements = std::move(appended);
+    ++numberOfColumns;
+}
+
+// REMOVE COLUMN
+// This function removes column k of A. Deleting it leaves the factor upper
+// Hessenberg from column k on, and one Givens rotation per later column restores
+// the triangle.
+template <RealScalarConcept valueType>
+void QRFactorization<valueType>::remove_column(positiveIntegerType k){
+    auto n = numberOfColumns;
+    assert(k < n);
+    ZLAB_INSTRUMENT("qr_update_column", 3.0 * (n - k) * (n - k), sizeof(valueType) * 2.0 * (n + 1) * (n + 1));
+    auto factor = augmented_factor();
+    std::vector<valueType> hessenberg((n + 1) * n);
+    BasicMatrixView<valueType> H(hessenberg.data(), n + 1, n);
+    for(positiveIntegerType i=0; i <= n; ++i){
+        for(positiveIntegerType j=0; j < n; ++j){
+            H(i,j) = factor(i, j < k ? j : j + 1);
+        }
+    }
+    for(auto j=k; j < n; ++j){
+        auto upper = H.row_view(j);
+        auto lower = H.row_view(j + 1);
+        apply_givens_rotation(upper, lower, j);
+    }
+    hessenberg.resize(n * n);
+    elements = std::move(hessenberg);
+    --numberOfColumns;
+}
+
+// SOLVE
+// This function returns the least-squares solution for the current rows and
+// columns by backward substitution with R and Q^T * b.
+template <RealScalarConcept valueType>
+template <VectorConcept vectorTypeX>
+void QRFactorization<valueType>::solve(vectorTypeX& x) const {
+    assert(x.size() == numberOfColumns);
+    backward_substitution(get_R(), get_Qtb(), x, marginOfError);
+}
+
+} // end namespace zlab
@@ -8,36 +8,82 @@
 
 namespace zlab{
 
+// RADIAL BASIS FUNCTIONS
+// Compactly supported radial basis functions of the distance r. valueType is the
+// type of the radius and of the returned value; a complex radius evaluates the
+// analytic continuation in the shape parameter 1 / radius (as needed by
+// contour-Pade stabilizations), with the support cut off at |radius|.
+template <ScalarConcept valueType_>
 class AbstractRadialBasisFunction{
     protected:
-        scalarType radius;
+        valueType_ radius;
     public:
-        AbstractRadialBasisFunction(scalarType radius) : radius(radius) {}
-        virtual scalarType evaluate(scalarType r) const = 0;
+        using valueType = valueType_;
+
+        AbstractRadialBasisFunction(valueType radius) : radius(radius) {}
+        virtual ~AbstractRadialBasisFunction() = default;
+        virtual valueType evaluate(RealType<valueType> r) const = 0;
 };
 
-using AbstractRBF = AbstractRadialBasisFunction;
+template <ScalarConcept valueType>
+using BasicAbstractRBF = AbstractRadialBasisFunction<valueType>;
+
+using AbstractRBF = AbstractRadialBasisFunction<scalarType>;
 
-class Bump : public AbstractRBF{
-    using Base = AbstractRBF;
+template <ScalarConcept valueType>
+class BasicBump : public BasicAbstractRBF<valueType>{
+    using Base = BasicAbstractRBF<valueType>;
     public:
-        Bump(scalarType radius) : Base(radius) {}
-        scalarType evaluate(scalarType r) const override;
+        BasicBump(valueType radius) : Base(radius) {}
+        valueType evaluate(RealType<valueType> r) const override;
 };
 
-class WendlandC0 : public AbstractRBF{
-    using Base = AbstractRBF;
+template <ScalarConcept valueType>
+class BasicWendlandC0 : public BasicAbstractRBF<valueType>{
+    using Base = BasicAbstractRBF<valueType>;
     public:
-        WendlandC0(scalarType radius) : Base(radius) {}
-        scalarType evaluate(scalarType r) const override;
+        BasicWendlandC0(valueType radius) : Base(radius) {}
+        valueType evaluate(RealType<valueType> r) const override;
 };
 
-class WendlandC2 : public AbstractRBF{
-    using Base = AbstractRBF;
+template <ScalarConcept valueType>
+class BasicWendlandC2 : public BasicAbstractRBF<valueType>{
+    using Base = BasicAbstractRBF<valueType>;
     public:
-        WendlandC2(scalarType radius) : Base(radius) {}
-        scalarType evaluate(scalarType r) const override;
+        BasicWendlandC2(valueType radius) : Base(radius) {}
+        valueType evaluate(RealType<valueType> r) const override;
 };
 
+using Bump = BasicBump<scalarType>;
+using WendlandC0 = BasicWendlandC0<scalarType>;
+using WendlandC2 = BasicWendlandC2<scalarType>;
+
+template <ScalarConcept valueType>
+valueType BasicBump<valueType>::evaluate(RealType<valueType> r) const {
+    auto R = this->radius;
+    if (r > std::abs(R)) return 0;
+    auto ratio = r / R;
+    return std::exp(valueType{-1} / (valueType{1} - zlab::pow(ratio,2)));
+}
+
+template <ScalarConcept valueType>
+valueType BasicWendlandC0<valueType>::evaluate(RealType<valueType> r) const {
+    auto R = this->radius;
+    if(r > std::abs(R)) return 0;
+    auto ratio = r / R;
+    return zlab::pow(valueType{1} - ratio, 2);
 }
 
+template <ScalarConcept valueType>
+valueType BasicWendlandC2<valueType>::evaluate(RealType<valueType> r) const {
+    auto R = this->radius;
+    if(r > std::abs(R)) return 0;
+    auto ratio = r / R;
+    return zlab::pow(valueType{1} - ratio, 4) * (valueType{4} * ratio + valueType{1});
+}
+
+extern template class BasicBump<scalarType>;
+extern template class BasicWendlandC0<scalarType>;
+extern template class BasicWendlandC2<scalarType>;
+
+}
@@ -0,0 +1,214 @@
+
+#pragma once
+
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "matrix.hpp"
+#include "matrix_decomposition.hpp"
+#include "solvers.hpp"
+#include "svd.hpp"
+#include "core.hpp"
+
+namespace zlab{
+
+template <typename matrixType>
+struct RegularizationPath {
+    matrixType X;
+    BasicZVector<MatrixValueType<matrixType>> residualNorms;
+    BasicZVector<MatrixValueType<matrixType>> regularizationNorms;
+    BasicZVector<MatrixValueType<matrixType>> gcv;
+    positiveIntegerType gcvIndex;
+};
+
+// REGULARIZATION PATH (Filter Factors of a Standard-Form Problem)
+// This function evaluates the Tikhonov solutions of a problem already reduced to
+// standard form min ||Abar * y - bbar||^2 + lambda^2 ||y||^2, with
+// Abar = U * diag(S) * V^T, x = x0 + E * y and EV = E * V. For every lambda the
+// solution costs O(n * k) and the diagnostics O(k): the residual norm and ||y||
+// (the two L-curve coordinates) and the GCV function
+// ||A * x - b||^2 / (m - fixedDegreesOfFreedom - sum_i f_i)^2 with the filter
+// factors f_i = S_i^2 / (S_i^2 + lambda^2). gcvIndex points to the smallest GCV.
+template <MatrixConcept matrixTypeU, VectorConcept vectorTypeS, MatrixConcept matrixTypeEV,
+          VectorConcept vectorTypeB, VectorConcept vectorTypeX0, VectorConcept vectorTypeLambda>
+RegularizationPath<BasicZMatrix<MatrixValueType<matrixTypeEV>>> regularization_path(
+    const matrixTypeU& U,
+    const vectorTypeS& S,
+    const matrixTypeEV& EV,
+    const vectorTypeB& bbar,
+    const vectorTypeX0& x0,
+    positiveIntegerType fixedDegreesOfFreedom,
+    const vectorTypeLambda& lambdas)
+{
+    using valueType = MatrixValueType<matrixTypeEV>;
+    auto numberOfRows = U.get_number_of_rows();
+    auto numberOfUnknowns = EV.get_number_of_rows();
+    auto numberOfSingularValues = S.size();
+    auto numberOfLambdas = lambdas.size();
+    ZLAB_INSTRUMENT("regularization_path", 2.0 * numberOfRows * numberOfSingularValues + 2.0 * numberOfLambdas * numberOfUnknowns * numberOfSingularValues,
+        sizeof(valueType) * (1.0 * numberOfRows * numberOfSingularValues + numberOfLambdas * numberOfUnknowns));
+    BasicZVector<valueType> beta(numberOfSingularValues), coefficients(numberOfSingularValues), x(numberOfUnknowns);
+    gemv(U, bbar, beta, 1, 0, true);
+    // Part of bbar outside the range of U, which no lambda can fit.
+    auto outOfRange = std::max(valueType{0}, dot(bbar, bbar) - dot(beta, beta));
+
+    RegularizationPath<BasicZMatrix<valueType>> path{
+        BasicZMatrix<valueType>(numberOfUnknowns, numberOfLambdas),
+        BasicZVector<valueType>(numberOfLambdas),
+        BasicZVector<valueType>(numberOfLambdas),
+        BasicZVector<valueType>(numberOfLambdas),
+        0};
+    for(positiveIntegerType l=0; l < numberOfLambdas; ++l){
+        auto lambdaSquared = lambdas[l] * lambdas[l];
+        valueType residualSquared = outOfRange;
+        valueType sumOfFilterFactors{0};
+        for(positiveIntegerType i=0; i < numberOfSingularValues; ++i){
+            auto denominator = S[i] * S[i] + lambdaSquared;
+            if (denominator == 0) {
+                // A zero singular value with lambda = 0 is left out (pseudoinverse).
+                coefficients[i] = 0;
+                residualSquared += beta[i] * beta[i];
+                continue;
+            }
+            coefficients[i] = S[i] * beta[i] / denominator;
+            auto misfit = lambdaSquared * beta[i] / denominator;
+            residualSquared += misfit * misfit;
+            sumOfFilterFactors += S[i] * S[i] / denominator;
+        }
+        gemv(EV, coefficients, x, 1, 0, false);
+        for(positiveIntegerType j=0; j < numberOfUnknowns; ++j){
+            path.X(j,l) = x0[j] + x[j];
+        }
+        path.residualNorms[l] = std::sqrt(residualSquared);
+        path.regularizationNorms[l] = norm2(coefficients);
+        auto degreesOfFreedom = valueType(numberOfRows) - valueType(fixedDegreesOfFreedom) - sumOfFilterFactors;
+        path.gcv[l] = degreesOfFreedom > 0 ? residualSquared / (degreesOfFreedom * degreesOfFreedom)
+                                           : std::numeric_limits<valueType>::infinity();
+        if (path.gcv[l] < path.gcv[path.gcvIndex]) path.gcvIndex = l;
+    }
+    return path;
+}
+
+// RIDGE REGRESSION (Tikhonov Regularization With L = I)
+// This function solves min ||A * x - b||^2 + lambda^2 ||x||^2 for every lambda in
+// lambdas. A is factored once by the thin SVD and each lambda then costs O(n^2);
+// column l of X is the solution for lambdas[l]. The path also carries the
+// residual norms and ||x|| (L-curve) and the GCV function.
+template <RealMatrixConcept matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeLambda>
+RegularizationPath<BasicZMatrix<MatrixValueType<matrixType>>> ridge_regression(
+    const matrixType& A,
+    const vectorTypeB& b,
+    const vectorTypeLambda& lambdas)
+{
+    using valueType = MatrixValueType<matrixType>;
+    assert(b.size() == A.get_number_of_rows());
+    ZLAB_INSTRUMENT("ridge_regression", 0, 0);
+    auto [U, S, V] = singular_value_decomposition(A);
+    BasicZVector<valueType> x0(A.get_number_of_columns());
+    return regularization_path(U, S, V, b, x0, 0, lambdas);
+}
+
+// TIKHONOV REGRESSION (General Regularization Operator)
+// This function solves min ||A * x - b||^2 + lambda^2 ||L * x||^2 for every lambda
+// in lambdas, for any p x n operator L (e.g. finite differences) such that A and L
+// have no common null vector. The problem is brought to standard form once
+// (Elden): with the QR decomposition L^T = [Kp Ko] * [R; 0], x = Kp * R^-T * y +
+// Ko * z, the null-space component z is eliminated by a QR decomposition of A * Ko,
+// and the SVD of the projected n - dim(null(L)) column matrix gives every lambda
+// in O(n^2). Operators with p > n are first replaced by their n x n triangular
+// factor. The regularization norms are ||L * x||.
+template <RealMatrixConcept matrixType, MatrixConcept matrixTypeL, VectorConcept vectorTypeB, VectorConcept vectorTypeLambda>
+RegularizationPath<BasicZMatrix<MatrixValueType<matrixType>>> tikhonov_regression(
+    const matrixType& A,
+    const matrixTypeL& L,
+    const vectorTypeB& b,
+    const vectorTypeLambda& lambdas)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto m = A.get_number_of_rows();
+    auto n = A.get_number_of_columns();
+    auto p = L.get_number_of_rows();
+    assert(L.get_number_of_columns() == n && b.size() == m);
+    ZLAB_INSTRUMENT("tikhonov_regression", 0, 0);
+    if (p > n) {
+        BasicZMatrix<valueType> QR(p, n), squareL(n, n);
+        for(positiveIntegerType i=0; i < p; ++i){
+            for(positiveIntegerType j=0; j < n; ++j){
+                QR(i,j) = L(i,j);
+            }
+        }
+        householder_qr_in_place(QR);
+        for(positiveIntegerType i=0; i < n; ++i){
+            for(auto j=i; j < n; ++j){
+                squareL(i,j) = QR(i,j);
+            }
+        }
+        return tikhonov_regression(A, squareL, b, lambdas);
+    }
+    auto q = n - p;
+    // The returned path outlives the workspace, so it is built outside of it.
+    BasicZMatrix<valueType> EV(n, std::min(m, p)), Ubar(m, std::min(m, p));
+    BasicZVector<valueType> S(std::min(m, p)), bbar(m), x0(n);
+    {
+        ScopedWorkspace workspace;
+        // Full Q of L^T: the zero columns appended to L^T get identity reflectors.
+        BasicZMatrix<valueType> LT(n, n);
+        for(positiveIntegerType i=0; i < p; ++i){
+            for(positiveIntegerType j=0; j < n; ++j){
+                LT(j,i) = L(i,j);
+            }
+        }
+        auto tau = householder_qr_in_place(LT);
+        auto K = householder_thin_q(LT, tau);
+        auto R = LT.block_view(0, 0, p, p);
+        check_least_squares_rank(R, std::nullopt);
+        auto Kp = K.block_view(0, 0, n, p);
+        auto Ko = K.block_view(0, p, n, q);
+
+        // M = Kp * R^-T is stored transposed: R * M^T = Kp^T.
+        BasicZMatrix<valueType> Mt(p, n), AM(m, p), E(n, p);
+        for(positiveIntegerType i=0; i < p; ++i){
+            for(positiveIntegerType j=0; j < n; ++j){
+                Mt(i,j) = Kp(j,i);
+            }
+        }
+        backward_substitution(R, Mt, Mt);
+        gemm(A, Mt, AM, 1, 0, false, true);
+        for(positiveIntegerType i=0; i < n; ++i){
+            for(positiveIntegerType j=0; j < p; ++j){
+                E(i,j) = Mt(j,i);
+            }
+        }
+        for(positiveIntegerType i=0; i < m; ++i){
+            bbar[i] = b[i];
+        }
+        if (q > 0) {
+            // A * Ko = Qo * To. Projecting Qo out of A * M and b leaves the problem in y;
+            // z = To^-1 * Qo^T * (b - A * M * y) gives x = (M - Ko * G) * y + Ko * g.
+            BasicZMatrix<valueType> AKo(m, q), QtAM(q, p);
+            gemm(A, Ko, AKo, 1, 0);
+            auto nullTau = householder_qr_in_place(AKo);
+            auto Qo = householder_thin_q(AKo, nullTau);
+            auto To = AKo.block_view(0, 0, q, q);
+            check_least_squares_rank(To, std::nullopt);
+            gemm(Qo, AM, QtAM, 1, 0, true);
+            gemm(Qo, QtAM, AM, -1, 1);
+            backward_substitution(To, QtAM, QtAM);
+            gemm(Ko, QtAM, E, -1, 1);
+            BasicZVector<valueType> Qtb(q);
+            gemv(Qo, b, Qtb, 1, 0, true);
+            gemv(Qo, Qtb, bbar, -1, 1, false);
+            backward_substitution(To, Qtb, Qtb);
+            gemv(Ko, Qtb, x0, 1, 0, false);
+        }
+        auto [U, singularValues, V] = singular_value_decomposition(AM);
+        gemm(E, V, EV, 1, 0);
+        Ubar = U;
+        S = singularValues;
+    }
+    return regularization_path(Ubar, S, EV, bbar, x0, q, lambdas);
+}
+
+} // end namespace zlab
@@ -1,48 +1,183 @@
 
-#pragma one
+#pragma once
 
+#include <stdexcept>
 #include <optional>
+#include <utility>
+#include <limits>
+#include <vector>
 #include <cmath>
 
 #include "matrix.hpp"
+#include "matrix_decomposition.hpp"
 
 namespace zlab {
 
+// BACKWARD SUBSTITUTION
+// This function solves A * x = b for an upper triangular A, or A^T * x = b for a
+// lower triangular A when isTranspose is set, with the blocked trsv kernel.
+// x may be the same object as b.
 template <typename matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
 void backward_substitution(
     const matrixType& A,
     const vectorTypeB& b,
     vectorTypeX& x,
-    std::optional<scalarType> marginOfError = std::nullopt)
+    std::optional<scalarType> marginOfError = std::nullopt,
+    bool isTranspose = false)
+{
+    assert(b.size() == x.size());
+    for(positiveIntegerType i=0; i < x.size(); ++i){
+        x[i] = b[i];
+    }
+    trsv(A, x, isTranspose ? TriangularPart::Lower : TriangularPart::Upper, isTranspose, false, marginOfError);
+}
+
+// FORWARD SUBSTITUTION
+// This function solves A * x = b for a lower triangular A, or A^T * x = b for an
+// upper triangular A when isTranspose is set. With isUnitDiagonal the diagonal of
+// A is taken as one and never read, as for the packed L of an LU factorization.
+template <typename matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
+void forward_substitution(
+    const matrixType& A,
+    const vectorTypeB& b,
+    vectorTypeX& x,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    bool isTranspose = false,
+    bool isUnitDiagonal = false)
+{
+    assert(b.size() == x.size());
+    for(positiveIntegerType i=0; i < x.size(); ++i){
+        x[i] = b[i];
+    }
+    trsv(A, x, isTranspose ? TriangularPart::Upper : TriangularPart::Lower, isTranspose, isUnitDiagonal, marginOfError);
+}
+
+// BACKWARD SUBSTITUTION (Multiple Right-Hand Sides)
+// This function solves A * X = B for an upper triangular A, or A^T * X = B for a
+// lower triangular A when isTranspose is set, with the blocked trsm kernel.
+// X may be the same object as B.
+template <typename matrixType, MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+void backward_substitution(
+    const matrixType& A,
+    const matrixTypeB& B,
+    matrixTypeX& X,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    bool isTranspose = false)
+{
+    assert(B.get_number_of_rows() == X.get_number_of_rows());
+    assert(B.get_number_of_columns() == X.get_number_of_columns());
+    for(positiveIntegerType i=0; i < X.get_number_of_rows(); ++i){
+        for(positiveIntegerType c=0; c < X.get_number_of_columns(); ++c){
+            X(i,c) = B(i,c);
+        }
+    }
+    trsm(A, X, isTranspose ? TriangularPart::Lower : TriangularPart::Upper, isTranspose, false, marginOfError);
+}
+
+// FORWARD SUBSTITUTION (Multiple Right-Hand Sides)
+// This function solves A * X = B for a lower triangular A, or A^T * X = B for an
+// upper triangular A when isTranspose is set, with the same unit-diagonal option
+// as the single right-hand-side version.
+template <typename matrixType, MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+void forward_substitution(
+    const matrixType& A,
+    const matrixTypeB& B,
+    matrixTypeX& X,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    bool isTranspose = false,
+    bool isUnitDiagonal = false)
 {
+    assert(B.get_number_of_rows() == X.get_number_of_rows());
+    assert(B.get_number_of_columns() == X.get_number_of_columns());
+    for(positiveIntegerType i=0; i < X.get_number_of_rows(); ++i){
+        for(positiveIntegerType c=0; c < X.get_number_of_columns(); ++c){
+            X(i,c) = B(i,c);
+        }
+    }
+    trsm(A, X, isTranspose ? TriangularPart::Upper : TriangularPart::Lower, isTranspose, isUnitDiagonal, marginOfError);
+}
+
+template <typename matrixType>
+struct QRLeastSquaresFactors {
+    matrixType R;
+    matrixType QtB;
+    BasicZVector<MatrixValueType<matrixType>> residualNorms;
+};
+
+// QR LEAST SQUARES FACTORS (Householder QR with the Right-Hand Sides Carried Along)
+// This function reduces the m x (n + k) matrix [A B] with the n Householder
+// reflectors of A, so every reflector reaches the columns of B while it is applied
+// to A and Q is never formed. It returns the n x n upper triangular R, the first
+// n rows of Q^T * B and, for every column of B, the least-squares residual norm
+// ||A * x - b||, read off the remaining m - n rows. The working copy of [A B] is
+// the only O(m * n) allocation.
+template <RealMatrixConcept matrixType, MatrixConcept matrixTypeB>
+QRLeastSquaresFactors<BasicZMatrix<MatrixValueType<matrixType>>> qr_least_squares_factors(
+    const matrixType& A,
+    const matrixTypeB& B)
+{
+    using valueType = MatrixValueType<matrixType>;
     auto numberOfRows = A.get_number_of_rows();
-    assert(numberOfRows == A.get_number_of_columns());
-    auto tolerance = evaluate_safe_tolerance(marginOfError);
-    for (auto i = 0; i < numberOfRows; ++i) {
-        if (std::abs(A(i, i)) < tolerance) {
-            throw std::runtime_error("Matrix is singular (zero pivot found).");
-        }
-    }
-    auto i = numberOfRows;
-    /* *
-     * WARNING: Backward iteration uses the 'do-while' pattern to prevent 
-     * an infinite loop.
-     * * DANGER: A standard 'for (size_t i = n - 1; i >= 0; --i)' loop 
-     * WILL FAIL because 'i' is unsigned and can never be < 0. 
-     * When i=0 is decremented, it wraps around to SIZE_MAX.
-     * * The 'do-while (i > 0)' check correctly terminates the loop 
-     * after the i=0 calculation is performed.
-    */
-    do {
-        --i;
-        scalarType sum{0};
-        for(auto j=i+1; j < numberOfRows; ++j){
-            sum += A(i,j) * x[j];
-        }
-        x[i] = (b[i] - sum) / A(i,i);
-    } while (i >0);
+    auto numberOfColumns = A.get_number_of_columns();
+    auto numberOfRightHandSides = B.get_number_of_columns();
+    assert(numberOfRows >= numberOfColumns && B.get_number_of_rows() == numberOfRows);
+    auto numberOfWorkingColumns = numberOfColumns + numberOfRightHandSides;
+    BasicZMatrix<valueType> R(numberOfColumns, numberOfColumns), QtB(numberOfColumns, numberOfRightHandSides);
+    BasicZVector<valueType> residualNorms(numberOfRightHandSides);
+    ZLAB_INSTRUMENT("householder_qr", 2.0 * numberOfRows * numberOfWorkingColumns * numberOfColumns - 2.0 * numberOfColumns * numberOfColumns * numberOfColumns / 3,
+        sizeof(valueType) * 2.0 * numberOfRows * numberOfWorkingColumns);
+    ScopedWorkspace workspace;
+    BasicZMatrix<valueType> W(numberOfRows, numberOfWorkingColumns);
+    parallel_for(0, numberOfRows, [&](positiveIntegerType first, positiveIntegerType last){
+        for(auto i=first; i < last; ++i){
+            for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+                W(i,j) = A(i,j);
+            }
+            for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+                W(i, numberOfColumns + c) = B(i,c);
+            }
+        }
+    }, grain_size(numberOfWorkingColumns));
+    for(positiveIntegerType k=0; k < numberOfColumns; ++k){
+        auto tau = householder_reflector(W, k, k);
+        apply_householder_reflector(W, k, k, tau, W, k + 1, numberOfWorkingColumns);
+    }
+    for(positiveIntegerType i=0; i < numberOfColumns; ++i){
+        for(auto j=i; j < numberOfColumns; ++j){
+            R(i,j) = W(i,j);
+        }
+        for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+            QtB(i,c) = W(i, numberOfColumns + c);
+        }
+    }
+    for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+        auto tail = W.column_view(numberOfColumns + c).subvector_view(numberOfColumns, numberOfRows - numberOfColumns);
+        residualNorms[c] = numberOfRows > numberOfColumns ? norm2(tail) : 0;
+    }
+    return {std::move(R), std::move(QtB), std::move(residualNorms)};
+}
+
+// CHECK LEAST SQUARES RANK
+// This function throws when a diagonal entry of R is below the safe tolerance
+// relative to the largest one, i.e. when A is numerically rank-deficient.
+template <MatrixConcept matrixType>
+void check_least_squares_rank(const matrixType& R, std::optional<scalarType> marginOfError){
+    using valueType = MatrixValueType<matrixType>;
+    RealType<valueType> largestDiagonal{0};
+    for(positiveIntegerType i=0; i < R.get_number_of_rows(); ++i){
+        largestDiagonal = std::max(largestDiagonal, std::abs(R(i,i)));
+    }
+    auto tolerance = evaluate_safe_tolerance<valueType>(marginOfError) * largestDiagonal;
+    for(positiveIntegerType i=0; i < R.get_number_of_rows(); ++i){
+        if (!(std::abs(R(i,i)) > tolerance)) {
+            throw std::runtime_error("QR: Matrix is ill-conditioned or rank-deficient.");
+        }
+    }
 }
 
+// LINEAR LEAST SQUARES
+// This function solves min ||A * x - b|| for a full column rank A with the fused
+// Householder path of qr_least_squares_factors followed by one triangular solve.
 template <typename matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
 void linear_least_squares(
     const matrixType& A,
@@ -50,20 +185,516 @@ void linear_least_squares(
     vectorTypeX& x,
     std::optional<scalarType> marginOfError = std::nullopt)
 {
-    auto [Q, R] = modified_gram_schmidt(A,marginOfError);
-    vectorTypeX c(x.size());
-    gemv(Q,b,c,1,0,true);
-    backward_substitution(R,c,x,marginOfError);
+    ZLAB_INSTRUMENT("linear_least_squares", 0, 0);
+    ScopedWorkspace workspace;
+    BasicZMatrix<MatrixValueType<matrixType>> B(b.size(), 1);
+    for(positiveIntegerType i=0; i < b.size(); ++i){
+        B(i,0) = b[i];
+    }
+    auto [R, QtB, residualNorms] = qr_least_squares_factors(A, B);
+    check_least_squares_rank(R, marginOfError);
+    backward_substitution(R, QtB.column_view(0), x, marginOfError);
 }
 
+// LINEAR LEAST SQUARES (Multiple Right-Hand Sides)
+// This function factors A once and solves min ||A * X - B|| for every column of
+// B, carrying all columns of B through the reflectors of A.
+template <typename matrixType, MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+void linear_least_squares(
+    const matrixType& A,
+    const matrixTypeB& B,
+    matrixTypeX& X,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    ZLAB_INSTRUMENT("linear_least_squares", 0, 0);
+    ScopedWorkspace workspace;
+    auto [R, QtB, residualNorms] = qr_least_squares_factors(A, B);
+    check_least_squares_rank(R, marginOfError);
+    backward_substitution(R, QtB, X, marginOfError);
+}
+
+enum class RankDeficientSolution { MinimumNorm, Basic };
+
+// RANK REVEALING LEAST SQUARES (Multiple Right-Hand Sides)
+// This function solves min ||A * X - B|| with a column pivoting QR and returns the
+// numerical rank r instead of failing on rank-deficient A. Basic sets the n - r
+// trailing pivoted unknowns to zero; MinimumNorm additionally reduces [R11 R12]
+// to [T 0] * Z and returns the solution of smallest norm.
+template <typename matrixType, MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+positiveIntegerType rank_revealing_least_squares(
+    const matrixType& A,
+    const matrixTypeB& B,
+    matrixTypeX& X,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    RankDeficientSolution solution = RankDeficientSolution::MinimumNorm)
+{
+    ZLAB_INSTRUMENT("rank_revealing_least_squares", 0, 0);
+    using valueType = MatrixValueType<matrixType>;
+    auto numberOfRows = A.get_number_of_rows();
+    auto numberOfColumns = A.get_number_of_columns();
+    auto numberOfRightHandSides = B.get_number_of_columns();
+    assert(B.get_number_of_rows() == numberOfRows);
+    assert(X.get_number_of_rows() == numberOfColumns && X.get_number_of_columns() == numberOfRightHandSides);
+    auto [QR, tau, permutation, rank] = column_pivoting_qr(A, marginOfError);
+
+    BasicZMatrix<valueType> C(numberOfRows, numberOfRightHandSides);
+    for(positiveIntegerType i=0; i < numberOfRows; ++i){
+        for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+            C(i,c) = B(i,c);
+        }
+    }
+    std::vector<valueType> projections(numberOfRightHandSides);
+    for(positiveIntegerType j=0; j < tau.size(); ++j){
+        if (tau[j] == 0) continue;
+        for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+            projections[c] = C(j,c);
+        }
+        for(auto i=j+1; i < numberOfRows; ++i){
+            for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+                projections[c] += QR(i,j) * C(i,c);
+            }
+        }
+        for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+            projections[c] *= tau[j];
+            C(j,c) -= projections[c];
+        }
+        for(auto i=j+1; i < numberOfRows; ++i){
+            for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+                C(i,c) -= projections[c] * QR(i,j);
+            }
+        }
+    }
+
+    BasicZMatrix<valueType> Y(numberOfColumns, numberOfRightHandSides);
+    if (rank > 0) {
+        std::vector<valueType> tauZ;
+        auto isMinimumNorm = solution == RankDeficientSolution::MinimumNorm && rank < numberOfColumns;
+        if (isMinimumNorm) {
+            tauZ = upper_trapezoidal_rz_in_place(QR, rank);
+        }
+        auto T = QR.block_view(0, 0, rank, rank);
+        auto leadingC = C.block_view(0, 0, rank, numberOfRightHandSides);
+        auto leadingY = Y.block_view(0, 0, rank, numberOfRightHandSides);
+        backward_substitution(T, leadingC, leadingY, scalarType{0});
+        // Y = Z^T * [W; 0] applies the reflectors of Z from the top row down.
+        for(positiveIntegerType k=0; k < rank && isMinimumNorm; ++k){
+            for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+                auto sum = Y(k,c);
+                for(auto p=rank; p < numberOfColumns; ++p){
+                    sum += QR(k,p) * Y(p,c);
+                }
+                sum *= tauZ[k];
+                Y(k,c) -= sum;
+                for(auto p=rank; p < numberOfColumns; ++p){
+                    Y(p,c) -= sum * QR(k,p);
+                }
+            }
+        }
+    }
+    for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+        for(positiveIntegerType c=0; c < numberOfRightHandSides; ++c){
+            X(permutation[j], c) = Y(j,c);
+        }
+    }
+    return rank;
+}
+
+// RANK REVEALING LEAST SQUARES
 template <typename matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
-void linear_solver(
+positiveIntegerType rank_revealing_least_squares(
+    const matrixType& A,
+    const vectorTypeB& b,
+    vectorTypeX& x,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    RankDeficientSolution solution = RankDeficientSolution::MinimumNorm)
+{
+    BasicZMatrix<MatrixValueType<matrixType>> B(b.size(), 1), X(x.size(), 1);
+    for(positiveIntegerType i=0; i < b.size(); ++i){
+        B(i,0) = b[i];
+    }
+    auto rank = rank_revealing_least_squares(A, B, X, marginOfError, solution);
+    for(positiveIntegerType i=0; i < x.size(); ++i){
+        x[i] = X(i,0);
+    }
+    return rank;
+}
+
+// GRAM CHOLESKY FACTOR
+// This function returns the Cholesky factor of A^T * A and throws when the
+// estimated condition number of the Gram matrix exceeds 1/sqrt(eps).
+template <typename matrixType>
+BasicZMatrix<MatrixValueType<matrixType>> gram_cholesky_factor(
+    const matrixType& A,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto G = gram_matrix(A);
+    auto [L] = cholesky(G, marginOfError);
+    valueType smallestPivot = std::abs(L(0,0)), largestPivot = std::abs(L(0,0));
+    for(positiveIntegerType i=1; i < L.get_number_of_rows(); ++i){
+        smallestPivot = std::min(smallestPivot, std::abs(L(i,i)));
+        largestPivot = std::max(largestPivot, std::abs(L(i,i)));
+    }
+    auto conditionEstimate = zlab::pow(largestPivot / smallestPivot, 2);
+    auto conditionLimit = 1 / std::sqrt(std::numeric_limits<valueType>::epsilon());
+    if (conditionEstimate > conditionLimit) {
+        throw std::runtime_error("Normal equations: Gram matrix is too ill-conditioned.");
+    }
+    return std::move(L);
+}
+
+// NORMAL EQUATIONS LEAST SQUARES
+// This function solves min ||A * x - b|| through A^T * A * x = A^T * b with a
+// Cholesky factorization of the Gram matrix. It is several times cheaper than QR
+// for tall matrices but squares the condition number, so it throws when the
+// Gram matrix is not safely positive definite.
+template <typename matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
+void normal_equations_least_squares(
     const matrixType& A,
     const vectorTypeB& b,
     vectorTypeX& x,
     std::optional<scalarType> marginOfError = std::nullopt)
 {
-    linear_least_squares(A,b,x,marginOfError);
+    ZLAB_INSTRUMENT("normal_equations_least_squares", 0, 0);
+    ScopedWorkspace workspace;
+    auto L = gram_cholesky_factor(A, marginOfError);
+    BasicZVector<MatrixValueType<matrixType>> c(x.size()), y(x.size());
+    gemv(A,b,c,1,0,true);
+    forward_substitution(L,c,y,marginOfError);
+    backward_substitution(L,y,x,marginOfError,true);
+}
+
+// NORMAL EQUATIONS LEAST SQUARES (Multiple Right-Hand Sides)
+template <typename matrixType, MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+void normal_equations_least_squares(
+    const matrixType& A,
+    const matrixTypeB& B,
+    matrixTypeX& X,
+    std::optional<scalarType> marginOfError = std::nullopt)
+{
+    ZLAB_INSTRUMENT("normal_equations_least_squares", 0, 0);
+    ScopedWorkspace workspace;
+    auto L = gram_cholesky_factor(A, marginOfError);
+    BasicZMatrix<MatrixValueType<matrixType>> C(X.get_number_of_rows(), X.get_number_of_columns());
+    gemm(A,B,C,1,0,true);
+    forward_substitution(L,C,C,marginOfError);
+    backward_substitution(L,C,X,marginOfError,true);
+}
+
+enum class FactorizationMethod { LU, Cholesky };
+
+// FACTORIZATION
+// This class factors a square matrix once and solves any number of right-hand
+// sides with it afterwards, either one vector b or all columns of a matrix B.
+// LU uses partial pivoting and works for any nonsingular matrix, real or complex;
+// Cholesky requires a real symmetric positive definite matrix.
+template <typename matrixType>
+class Factorization{
+        FactorizationMethod method;
+        OwnedMatrix<matrixType> factor;
+        std::vector<positiveIntegerType> pivots;
+        std::optional<scalarType> marginOfError;
+    public:
+        Factorization() = delete;
+        Factorization(const matrixType&,
+                      FactorizationMethod = FactorizationMethod::LU,
+                      std::optional<scalarType> = std::nullopt);
+
+        template <VectorConcept vectorTypeB, VectorConcept vectorTypeX>
+        void solve(const vectorTypeB&, vectorTypeX&) const;
+
+        template <MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+        void solve(const matrixTypeB&, matrixTypeX&) const;
+
+        positiveIntegerType get_order() const { return factor.get_number_of_rows(); }
+        FactorizationMethod get_method() const { return method; }
+};
+
+template <typename matrixType>
+Factorization<matrixType>::Factorization(
+    const matrixType& A,
+    FactorizationMethod method,
+    std::optional<scalarType> marginOfError) :
+    method(method),
+    factor(copy_matrix(A)),
+    marginOfError(marginOfError) {
+    if (method == FactorizationMethod::LU) {
+        pivots = partial_pivoting_lu_in_place(factor, marginOfError);
+    } else if constexpr (RealMatrixConcept<matrixType>) {
+        factor = std::move(cholesky(factor, marginOfError).L);
+    } else {
+        throw std::invalid_argument("Cholesky requires a real matrix.");
+    }
+}
+
+template <typename matrixType>
+template <VectorConcept vectorTypeB, VectorConcept vectorTypeX>
+void Factorization<matrixType>::solve(const vectorTypeB& b, vectorTypeX& x) const {
+    auto order = get_order();
+    assert(b.size() == order && x.size() == order);
+    for(positiveIntegerType i=0; i < order; ++i){
+        x[i] = b[i];
+    }
+    if (method == FactorizationMethod::LU) {
+        for(positiveIntegerType i=0; i < order; ++i){
+            std::swap(x[i], x[pivots[i]]);
+        }
+        forward_substitution(factor, x, x, marginOfError, false, true);
+        backward_substitution(factor, x, x, marginOfError);
+    } else {
+        forward_substitution(factor, x, x, marginOfError);
+        backward_substitution(factor, x, x, marginOfError, true);
+    }
+}
+
+template <typename matrixType>
+template <MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+void Factorization<matrixType>::solve(const matrixTypeB& B, matrixTypeX& X) const {
+    auto order = get_order();
+    auto numberOfColumns = B.get_number_of_columns();
+    assert(B.get_number_of_rows() == order && X.get_number_of_rows() == order);
+    assert(X.get_number_of_columns() == numberOfColumns);
+    for(positiveIntegerType i=0; i < order; ++i){
+        for(positiveIntegerType c=0; c < numberOfColumns; ++c){
+            X(i,c) = B(i,c);
+        }
+    }
+    if (method == FactorizationMethod::LU) {
+        for(positiveIntegerType i=0; i < order; ++i){
+            if (pivots[i] == i) continue;
+            for(positiveIntegerType c=0; c < numberOfColumns; ++c){
+                std::swap(X(i,c), X(pivots[i],c));
+            }
+        }
+        forward_substitution(factor, X, X, marginOfError, false, true);
+        backward_substitution(factor, X, X, marginOfError);
+    } else {
+        forward_substitution(factor, X, X, marginOfError);
+        backward_substitution(factor, X, X, marginOfError, true);
+    }
+}
+
+// LOW PRECISION COPY
+// This function returns a copy of A rounded to lowPrecisionType.
+template <ScalarConcept lowPrecisionType, MatrixConcept matrixType>
+BasicZMatrix<lowPrecisionType> low_precision_copy(const matrixType& A){
+    auto numberOfRows = A.get_number_of_rows();
+    auto numberOfColumns = A.get_number_of_columns();
+    BasicZMatrix<lowPrecisionType> copy(numberOfRows, numberOfColumns);
+    parallel_for(0, numberOfRows, [&](positiveIntegerType first, positiveIntegerType last){
+        for(auto i=first; i < last; ++i){
+            for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+                copy(i,j) = static_cast<lowPrecisionType>(A(i,j));
+            }
+        }
+    }, grain_size(numberOfColumns));
+    return copy;
+}
+
+// ITERATIVE REFINEMENT
+// This function solves A * x = b with a factorization of a lower precision copy of
+// A and refines x with residuals r = b - A * x computed in the precision of A,
+// x <- x + solve(r), until ||r|| <= tolerance * ||A|| * ||x|| (infinity norms, the
+// tolerance being sqrt(n) times the safe tolerance of A). It returns the number of
+// refinement steps and throws when the residual stops decreasing, which happens
+// once the condition number of A approaches 1 / epsilon of the low precision.
+template <typename matrixType, typename lowPrecisionMatrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
+positiveIntegerType iterative_refinement(
+    const matrixType& A,
+    const Factorization<lowPrecisionMatrixType>& lowPrecisionFactorization,
+    const vectorTypeB& b,
+    vectorTypeX& x,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType maximumIterations = 30)
+{
+    using valueType = MatrixValueType<matrixType>;
+    using lowPrecisionType = MatrixValueType<lowPrecisionMatrixType>;
+    auto order = A.get_number_of_rows();
+    assert(order == A.get_number_of_columns() && order == lowPrecisionFactorization.get_order());
+    assert(b.size() == order && x.size() == order);
+    RealType<valueType> normOfA{0};
+    for(positiveIntegerType i=0; i < order; ++i){
+        RealType<valueType> rowSum{0};
+        for(positiveIntegerType j=0; j < order; ++j){
+            rowSum += std::abs(A(i,j));
+        }
+        normOfA = std::max(normOfA, rowSum);
+    }
+    auto tolerance = evaluate_safe_tolerance<valueType>(marginOfError) * std::sqrt(static_cast<RealType<valueType>>(order));
+    auto infinity = std::numeric_limits<RealType<valueType>>::infinity();
+
+    BasicZVector<valueType> residual(order);
+    BasicZVector<lowPrecisionType> lowPrecisionResidual(order), correction(order);
+    for(positiveIntegerType i=0; i < order; ++i){
+        lowPrecisionResidual[i] = static_cast<lowPrecisionType>(b[i]);
+    }
+    lowPrecisionFactorization.solve(lowPrecisionResidual, correction);
+    for(positiveIntegerType i=0; i < order; ++i){
+        x[i] = static_cast<valueType>(correction[i]);
+    }
+    auto previousResidualNorm = infinity;
+    for(positiveIntegerType iteration=0; iteration <= maximumIterations; ++iteration){
+        for(positiveIntegerType i=0; i < order; ++i){
+            residual[i] = b[i];
+        }
+        gemv(A, x, residual, -1, 1, false);
+        auto residualNorm = norm_infinity(residual);
+        if (residualNorm <= tolerance * normOfA * norm_infinity(x)) return iteration;
+        if (!(residualNorm < previousResidualNorm) || iteration == maximumIterations) break;
+        previousResidualNorm = residualNorm;
+        for(positiveIntegerType i=0; i < order; ++i){
+            lowPrecisionResidual[i] = static_cast<lowPrecisionType>(residual[i]);
+        }
+        lowPrecisionFactorization.solve(lowPrecisionResidual, correction);
+        for(positiveIntegerType i=0; i < order; ++i){
+            x[i] += static_cast<valueType>(correction[i]);
+        }
+    }
+    throw std::runtime_error("Iterative refinement: Residual stagnated; the matrix is too ill-conditioned for the low precision factorization.");
+}
+
+// MIXED PRECISION REFINEMENT
+// This function factors a square A in LowPrecisionType (float for double) and
+// refines the solution in the precision of A (see iterative_refinement). The O(n^3)
+// factorization moves half the bytes of a double one, while the O(n^2) refinement
+// steps recover full working accuracy for matrices that are not too ill-conditioned.
+template <typename matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
+positiveIntegerType mixed_precision_refinement(
+    const matrixType& A,
+    const vectorTypeB& b,
+    vectorTypeX& x,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType maximumIterations = 30)
+{
+    ZLAB_INSTRUMENT("mixed_precision_refinement", 0, 0);
+    using lowPrecisionType = LowPrecisionType<MatrixValueType<matrixType>>;
+    Factorization<BasicZMatrix<lowPrecisionType>> lowPrecisionFactorization(low_precision_copy<lowPrecisionType>(A));
+    return iterative_refinement(A, lowPrecisionFactorization, b, x, marginOfError, maximumIterations);
+}
+
+enum class LinearSolverMethod { Automatic, QR, NormalEquations, LU, ColumnPivotingQR, MixedPrecisionLU };
+
+// RESOLVE LINEAR SOLVER METHOD
+// This function maps Automatic to LU for square systems and QR otherwise, and
+// rejects LU for non-square systems and any method but LU for complex systems.
+template <typename matrixType>
+LinearSolverMethod resolve_linear_solver_method(const matrixType& A, LinearSolverMethod method){
+    auto isSquare = A.get_number_of_rows() == A.get_number_of_columns();
+    if (method == LinearSolverMethod::Automatic) {
+        method = isSquare ? LinearSolverMethod::LU : LinearSolverMethod::QR;
+    }
+    if ((method == LinearSolverMethod::LU || method == LinearSolverMethod::MixedPrecisionLU) && !isSquare) {
+        throw std::invalid_argument("LU requires a square matrix.");
+    }
+    if (!RealMatrixConcept<matrixType> && method != LinearSolverMethod::LU && method != LinearSolverMethod::MixedPrecisionLU) {
+        throw std::invalid_argument("Complex systems are solved with LU only.");
+    }
+    return method;
+}
+
+// LINEAR SOLVER
+// This function solves square and overdetermined systems. Automatic uses LU for
+// square systems and QR otherwise. NormalEquations falls back to QR when the Gram
+// matrix turns out to be ill-conditioned. ColumnPivotingQR returns the minimum
+// norm solution for rank-deficient systems instead of throwing. MixedPrecisionLU
+// factors in single precision with iterative refinement and falls back to LU in
+// the precision of A when the refinement does not converge. Complex systems
+// support the two LU methods.
+template <typename matrixType, VectorConcept vectorTypeB, VectorConcept vectorTypeX>
+void linear_solver(
+    const matrixType& A,
+    const vectorTypeB& b,
+    vectorTypeX& x,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    LinearSolverMethod method = LinearSolverMethod::Automatic)
+{
+    ZLAB_INSTRUMENT("linear_solver", 0, 0);
+    method = resolve_linear_solver_method(A, method);
+    if (method == LinearSolverMethod::MixedPrecisionLU) {
+        try {
+            mixed_precision_refinement(A,b,x,marginOfError);
+            return;
+        } catch (const std::runtime_error&) {
+            method = LinearSolverMethod::LU;
+        }
+    }
+    if (method == LinearSolverMethod::LU) {
+        Factorization<matrixType>(A, FactorizationMethod::LU, marginOfError).solve(b,x);
+        return;
+    }
+    if constexpr (RealMatrixConcept<matrixType>) {
+        if (method == LinearSolverMethod::ColumnPivotingQR) {
+            rank_revealing_least_squares(A,b,x,marginOfError);
+            return;
+        }
+        if (method == LinearSolverMethod::NormalEquations) {
+            try {
+                normal_equations_least_squares(A,b,x,marginOfError);
+                return;
+            } catch (const std::runtime_error&) {
+                // Fall back to the QR path below.
+            }
+        }
+        linear_least_squares(A,b,x,marginOfError);
+    } else {
+        throw std::invalid_argument("Complex systems are solved with LU only.");
+    }
+}
+
+// LINEAR SOLVER (Multiple Right-Hand Sides)
+// This function solves for every column of B with a single factorization of A.
+template <typename matrixType, MatrixConcept matrixTypeB, MatrixConcept matrixTypeX>
+void linear_solver(
+    const matrixType& A,
+    const matrixTypeB& B,
+    matrixTypeX& X,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    LinearSolverMethod method = LinearSolverMethod::Automatic)
+{
+    ZLAB_INSTRUMENT("linear_solver", 0, 0);
+    method = resolve_linear_solver_method(A, method);
+    if (method == LinearSolverMethod::MixedPrecisionLU) {
+        using valueType = MatrixValueType<matrixType>;
+        using lowPrecisionType = LowPrecisionType<valueType>;
+        try {
+            Factorization<BasicZMatrix<lowPrecisionType>> lowPrecisionFactorization(low_precision_copy<lowPrecisionType>(A));
+            auto order = A.get_number_of_rows();
+            BasicZVector<valueType> b(order), x(order);
+            for(positiveIntegerType c=0; c < B.get_number_of_columns(); ++c){
+                for(positiveIntegerType i=0; i < order; ++i){
+                    b[i] = B(i,c);
+                }
+                iterative_refinement(A, lowPrecisionFactorization, b, x, marginOfError);
+                for(positiveIntegerType i=0; i < order; ++i){
+                    X(i,c) = x[i];
+                }
+            }
+            return;
+        } catch (const std::runtime_error&) {
+            method = LinearSolverMethod::LU;
+        }
+    }
+    if (method == LinearSolverMethod::LU) {
+        Factorization<matrixType>(A, FactorizationMethod::LU, marginOfError).solve(B,X);
+        return;
+    }
+    if constexpr (RealMatrixConcept<matrixType>) {
+        if (method == LinearSolverMethod::ColumnPivotingQR) {
+            rank_revealing_least_squares(A,B,X,marginOfError);
+            return;
+        }
+        if (method == LinearSolverMethod::NormalEquations) {
+            try {
+                normal_equations_least_squares(A,B,X,marginOfError);
+                return;
+            } catch (const std::runtime_error&) {
+                // Fall back to the QR path below.
+            }
+        }
+        linear_least_squares(A,B,X,marginOfError);
+    } else {
+        throw std::invalid_argument("Complex systems are solved with LU only.");
+    }
 }
 
 } // end zlab namespace
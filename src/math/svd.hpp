@@ -0,0 +1,323 @@
+
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <optional>
+#include <numeric>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include <cmath>
+
+#include "matrix.hpp"
+#include "matrix_decomposition.hpp"
+#include "core.hpp"
+
+namespace zlab{
+
+template <typename matrixType>
+struct SingularValueDecomposition {
+    matrixType U;
+    BasicZVector<MatrixValueType<matrixType>> S;
+    matrixType V;
+};
+
+template <typename matrixType>
+using SVD = SingularValueDecomposition<matrixType>;
+
+// SINGULAR VALUE DECOMPOSITION (Golub-Kahan-Reinsch)
+// This function computes the thin SVD A = U * diag(S) * V^T with k = min(m, n)
+// singular values sorted in descending order, U of size m x k and V of size n x k.
+// A is reduced to upper bidiagonal form with Householder reflectors from both
+// sides, then the bidiagonal matrix is diagonalized by implicitly shifted QR
+// sweeps. The transforms are accumulated as rows of U^T and V^T so that every
+// plane rotation touches contiguous memory.
+template <RealMatrixConcept matrixType>
+SVD<OwnedMatrix<matrixType>> singular_value_decomposition(
+    const matrixType& data,
+    positiveIntegerType maximumIterations = 75)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto numberOfRows = data.get_number_of_rows();
+    auto numberOfColumns = data.get_number_of_columns();
+    if (numberOfRows < numberOfColumns) {
+        OwnedMatrix<matrixType> transposedData(numberOfColumns, numberOfRows);
+        for(positiveIntegerType i=0; i < numberOfRows; ++i){
+            for(positiveIntegerType j=0; j < numberOfColumns; ++j){
+                transposedData(j,i) = data(i,j);
+            }
+        }
+        auto [U, S, V] = singular_value_decomposition(transposedData, maximumIterations);
+        return {std::move(V), std::move(S), std::move(U)};
+    }
+    auto m = numberOfRows;
+    auto n = numberOfColumns;
+    ZLAB_INSTRUMENT("singular_value_decomposition", 14.0 * m * n * n + 8.0 * n * n * n,
+        sizeof(valueType) * (2.0 * m * n + 2.0 * n * n));
+    auto A = copy_matrix(data);
+    // d holds the diagonal and e[i] the superdiagonal entry above d[i] (e[0] = 0).
+    BasicZVector<valueType> d(n), e(n), leftTau(n), rightTau(n);
+
+    for(positiveIntegerType k=0; k < n; ++k){
+        leftTau[k] = householder_reflector(A, k, k);
+        apply_householder_reflector(A, k, k, leftTau[k], A, k + 1, n);
+        d[k] = A(k,k);
+        if (k + 2 < n) {
+            auto first = k + 1;
+            valueType alpha = A(k, first);
+            valueType tailNormSquared{0};
+            for(auto c=first+1; c < n; ++c){
+                tailNormSquared += A(k,c) * A(k,c);
+            }
+            if (tailNormSquared > 0) {
+                auto beta = -std::copysign(std::sqrt(alpha * alpha + tailNormSquared), alpha);
+                auto inverseScale = 1 / (alpha - beta);
+                for(auto c=first+1; c < n; ++c){
+                    A(k,c) *= inverseScale;
+                }
+                A(k, first) = beta;
+                auto tau = rightTau[k] = (beta - alpha) / beta;
+                parallel_for(k + 1, m, [&](positiveIntegerType firstRow, positiveIntegerType lastRow){
+                    for(auto r=firstRow; r < lastRow; ++r){
+                        auto sum = A(r, first);
+                        for(auto c=first+1; c < n; ++c){
+                            sum += A(k,c) * A(r,c);
+                        }
+                        sum *= tau;
+                        A(r, first) -= sum;
+                        for(auto c=first+1; c < n; ++c){
+                            A(r,c) -= sum * A(k,c);
+                        }
+                    }
+                }, grain_size(n - first));
+            }
+        }
+        if (k + 1 < n) e[k + 1] = A(k, k + 1);
+    }
+
+    // U^T = [I 0] * H(n-1) * ... * H(0) and V^T = G(n-3) * ... * G(0).
+    OwnedMatrix<matrixType> Ut(n, m), Vt(n, n);
+    for(positiveIntegerType i=0; i < n; ++i){
+        Ut(i,i) = 1;
+        Vt(i,i) = 1;
+    }
+    auto reflector = n;
+    while (reflector > 0) {
+        --reflector;
+        auto tau = leftTau[reflector];
+        if (tau == 0) continue;
+        parallel_for(0, n, [&](positiveIntegerType firstRow, positiveIntegerType lastRow){
+            for(auto r=firstRow; r < lastRow; ++r){
+                auto sum = Ut(r,reflector);
+                for(auto i=reflector+1; i < m; ++i){
+                    sum += Ut(r,i) * A(i,reflector);
+                }
+                sum *= tau;
+                Ut(r,reflector) -= sum;
+                for(auto i=reflector+1; i < m; ++i){
+                    Ut(r,i) -= sum * A(i,reflector);
+                }
+            }
+        }, grain_size(m - reflector));
+    }
+    reflector = n > 2 ? n - 2 : 0;
+    while (reflector > 0) {
+        --reflector;
+        auto tau = rightTau[reflector];
+        if (tau == 0) continue;
+        auto first = reflector + 1;
+        parallel_for(0, n, [&](positiveIntegerType firstRow, positiveIntegerType lastRow){
+            for(auto r=firstRow; r < lastRow; ++r){
+                auto sum = Vt(r, first);
+                for(auto c=first+1; c < n; ++c){
+                    sum += Vt(r,c) * A(reflector,c);
+                }
+                sum *= tau;
+                Vt(r, first) -= sum;
+                for(auto c=first+1; c < n; ++c){
+                    Vt(r,c) -= sum * A(reflector,c);
+                }
+            }
+        }, grain_size(n - first));
+    }
+
+    auto rotate_rows = [](OwnedMatrix<matrixType>& M, integerType p, integerType q, valueType c, valueType s){
+        for(positiveIntegerType j=0; j < M.get_number_of_columns(); ++j){
+            auto y = M(p,j);
+            auto z = M(q,j);
+            M(p,j) = y * c + z * s;
+            M(q,j) = z * c - y * s;
+        }
+    };
+    valueType bidiagonalNorm{0};
+    for(positiveIntegerType i=0; i < n; ++i){
+        bidiagonalNorm = std::max(bidiagonalNorm, std::abs(d[i]) + std::abs(e[i]));
+    }
+    auto negligible = std::numeric_limits<valueType>::epsilon() * bidiagonalNorm;
+
+    for(integerType k=n-1; k >= 0; --k){
+        for(positiveIntegerType iteration=0; ; ++iteration){
+            // Find the start l of the unreduced block ending at k.
+            integerType l = k, nm = 0;
+            bool isCancellationNeeded = true;
+            for(; l >= 0; --l){
+                nm = l - 1;
+                if (l == 0 || std::abs(e[l]) <= negligible) {
+                    isCancellationNeeded = false;
+                    break;
+                }
+                if (std::abs(d[nm]) <= negligible) break;
+            }
+            if (isCancellationNeeded) {
+                // d[nm] is negligible: chase e[l] out of the block with rotations.
+                valueType c{0}, s{1};
+                for(auto i=l; i <= k; ++i){
+                    auto f = s * e[i];
+                    e[i] = c * e[i];
+                    if (std::abs(f) <= negligible) break;
+                    auto g = d[i];
+                    auto h = std::hypot(f, g);
+                    d[i] = h;
+                    c = g / h;
+                    s = -f / h;
+                    rotate_rows(Ut, nm, i, c, s);
+                }
+            }
+            auto z = d[k];
+            if (l == k) {
+                if (z < 0) {
+                    d[k] = -z;
+                    for(positiveIntegerType j=0; j < n; ++j){
+                        Vt(k,j) = -Vt(k,j);
+                    }
+                }
+                break;
+            }
+            if (iteration == maximumIterations) {
+                throw std::runtime_error("SVD: No convergence in the bidiagonal QR iteration.");
+            }
+            // Wilkinson shift from the trailing 2x2 block, then one implicit QR sweep.
+            auto x = d[l];
+            nm = k - 1;
+            auto y = d[nm];
+            auto g = e[nm];
+            auto h = e[k];
+            auto f = ((y - z) * (y + z) + (g - h) * (g + h)) / (2 * h * y);
+            g = std::hypot(f, valueType{1});
+            f = ((x - z) * (x + z) + h * ((y / (f + std::copysign(g, f))) - h)) / x;
+            valueType c{1}, s{1};
+            for(auto j=l; j <= nm; ++j){
+                auto i = j + 1;
+                g = e[i];
+                y = d[i];
+                h = s * g;
+                g = c * g;
+                z = std::hypot(f, h);
+                e[j] = z;
+                c = f / z;
+                s = h / z;
+                f = x * c + g * s;
+                g = g * c - x * s;
+                h = y * s;
+                y *= c;
+                rotate_rows(Vt, j, i, c, s);
+                z = std::hypot(f, h);
+                d[j] = z;
+                if (z != 0) {
+                    c = f / z;
+                    s = h / z;
+                }
+                f = c * g + s * y;
+                x = c * y - s * g;
+                rotate_rows(Ut, j, i, c, s);
+            }
+            e[l] = 0;
+            e[k] = f;
+            d[k] = x;
+        }
+    }
+
+    std::vector<positiveIntegerType> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&d](auto i, auto j){ return d[i] > d[j]; });
+    OwnedMatrix<matrixType> U(m, n), V(n, n);
+    BasicZVector<valueType> S(n);
+    for(positiveIntegerType j=0; j < n; ++j){
+        S[j] = d[order[j]];
+        for(positiveIntegerType i=0; i < m; ++i){
+            U(i,j) = Ut(order[j], i);
+        }
+        for(positiveIntegerType i=0; i < n; ++i){
+            V(i,j) = Vt(order[j], i);
+        }
+    }
+    return {std::move(U), std::move(S), std::move(V)};
+}
+
+// RANDOMIZED SVD (Halko-Martinsson-Tropp Range Finder)
+// This function computes a rank-k approximation A ~ U * diag(S) * V^T in O(m n k)
+// time. The range of A is sampled with a Gaussian test matrix of k + oversampling
+// columns, refined by power iterations with re-orthonormalization, and the small
+// projected matrix Q^T * A is decomposed densely. All products go through the
+// parallel GEMM.
+template <RealMatrixConcept matrixType>
+SVD<OwnedMatrix<matrixType>> randomized_svd(
+    const matrixType& A,
+    positiveIntegerType rank,
+    positiveIntegerType oversampling = 10,
+    positiveIntegerType powerIterations = 2,
+    std::uint64_t seed = 0)
+{
+    using valueType = MatrixValueType<matrixType>;
+    auto numberOfRows = A.get_number_of_rows();
+    auto numberOfColumns = A.get_number_of_columns();
+    auto smallestDimension = std::min(numberOfRows, numberOfColumns);
+    assert(rank > 0 && rank <= smallestDimension);
+    auto numberOfSamples = std::min(rank + oversampling, smallestDimension);
+    ZLAB_INSTRUMENT("randomized_svd", 2.0 * (2 * powerIterations + 2) * numberOfRows * numberOfColumns * numberOfSamples,
+        sizeof(valueType) * (2 * powerIterations + 2) * 1.0 * numberOfRows * numberOfColumns);
+
+    std::mt19937_64 generator(seed);
+    std::normal_distribution<valueType> gaussian;
+    OwnedMatrix<matrixType> Omega(numberOfColumns, numberOfSamples);
+    for(positiveIntegerType i=0; i < numberOfColumns; ++i){
+        for(positiveIntegerType j=0; j < numberOfSamples; ++j){
+            Omega(i,j) = gaussian(generator);
+        }
+    }
+    auto orthonormal_basis = [](OwnedMatrix<matrixType>& M){
+        auto tau = householder_qr_in_place(M);
+        return householder_thin_q(M, tau);
+    };
+    OwnedMatrix<matrixType> Y(numberOfRows, numberOfSamples), Z(numberOfColumns, numberOfSamples);
+    gemm(A, Omega, Y, 1, 0);
+    auto Q = orthonormal_basis(Y);
+    for(positiveIntegerType iteration=0; iteration < powerIterations; ++iteration){
+        gemm(A, Q, Z, 1, 0, true);
+        auto W = orthonormal_basis(Z);
+        gemm(A, W, Y, 1, 0);
+        Q = orthonormal_basis(Y);
+    }
+    OwnedMatrix<matrixType> B(numberOfSamples, numberOfColumns);
+    gemm(Q, A, B, 1, 0, true);
+    auto [smallU, smallS, smallV] = singular_value_decomposition(B);
+    OwnedMatrix<matrixType> fullU(numberOfRows, numberOfSamples);
+    gemm(Q, smallU, fullU, 1, 0);
+
+    OwnedMatrix<matrixType> U(numberOfRows, rank), V(numberOfColumns, rank);
+    BasicZVector<valueType> S(rank);
+    for(positiveIntegerType j=0; j < rank; ++j){
+        S[j] = smallS[j];
+        for(positiveIntegerType i=0; i < numberOfRows; ++i){
+            U(i,j) = fullU(i,j);
+        }
+        for(positiveIntegerType i=0; i < numberOfColumns; ++i){
+            V(i,j) = smallV(i,j);
+        }
+    }
+    return {std::move(U), std::move(S), std::move(V)};
+}
+
+} // end namespace zlab
@@ -0,0 +1,2 @@
+
+#include "triangular_solve.hpp"
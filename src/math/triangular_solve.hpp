@@ -0,0 +1,185 @@
+
+#pragma once
+
+#include <stdexcept>
+#include <optional>
+#include <algorithm>
+#include <cmath>
+
+#include "matrix.hpp"
+#include "core.hpp"
+
+namespace zlab{
+
+static constexpr positiveIntegerType defaultBlockSize = 64;
+
+enum class TriangularPart { Lower, Upper };
+
+// TRIANGULAR SOLVE ORDER
+// The solves below run over op(T), the lower or upper triangle T of A or its
+// transpose. Rows are visited in solve order, position p being row p of a lower
+// triangular op(T) and row n - 1 - p of an upper triangular one, so that in
+// positions op(T) is always lower triangular and every algorithm is written once.
+struct TriangularSolveOrder{
+    positiveIntegerType order;
+    bool isForward;
+    bool isTranspose;
+
+    TriangularSolveOrder(positiveIntegerType order, TriangularPart part, bool isTranspose) :
+        order(order),
+        isForward((part == TriangularPart::Lower) != isTranspose),
+        isTranspose(isTranspose) {}
+
+    positiveIntegerType row(positiveIntegerType position) const {
+        return isForward ? position : order - 1 - position;
+    }
+
+    // Entry (p, q) of op(T) in solve positions.
+    template <typename matrixType>
+    decltype(auto) entry(const matrixType& A, positiveIntegerType p, positiveIntegerType q) const {
+        return isTranspose ? A(row(q), row(p)) : A(row(p), row(q));
+    }
+};
+
+// CHECK TRIANGULAR PIVOTS
+// This function throws when a diagonal entry of A in [first, last) is below the
+// safe tolerance.
+template <typename matrixType>
+void check_triangular_pivots(
+    const matrixType& A,
+    positiveIntegerType first,
+    positiveIntegerType last,
+    std::optional<scalarType> marginOfError)
+{
+    auto tolerance = evaluate_safe_tolerance<MatrixValueType<matrixType>>(marginOfError);
+    for(auto i=first; i < last; ++i){
+        if (std::abs(A(i,i)) < tolerance) {
+            throw std::runtime_error("Matrix is singular (zero pivot found).");
+        }
+    }
+}
+
+// TRSV (Triangular Solve, Single Right-Hand Side)
+// This function overwrites x with the solution of op(T) * x = x, where T is the
+// given triangle of the square A (the other triangle is never read) and op(T) is
+// T or T^T. With isUnitDiagonal the diagonal is taken as one. The solve is blocked:
+// after each diagonal block the remaining entries of x receive the GEMV update
+// with the panel below the block, split over rows on the thread pool. The panel
+// is swept along rows of A in either case (short dot products when op(T) = T,
+// AXPYs when op(T) = T^T), so the inner loops have unit stride.
+template <MatrixConcept matrixType, VectorConcept vectorType>
+void trsv(
+    const matrixType& A,
+    vectorType& x,
+    TriangularPart part,
+    bool isTranspose = false,
+    bool isUnitDiagonal = false,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    using valueType = VectorValueType<vectorType>;
+    auto order = A.get_number_of_rows();
+    assert(order == A.get_number_of_columns() && x.size() == order);
+    assert(blockSize > 0);
+    ZLAB_INSTRUMENT("trsv", 1.0 * order * order,
+        sizeof(MatrixValueType<matrixType>) * (0.5 * order * order + 2.0 * order));
+    TriangularSolveOrder solveOrder(order, part, isTranspose);
+    for(positiveIntegerType k0=0; k0 < order; k0 += blockSize){
+        auto blockEnd = std::min(order, k0 + blockSize);
+        if (!isUnitDiagonal) {
+            check_triangular_pivots(A, std::min(solveOrder.row(k0), solveOrder.row(blockEnd - 1)),
+                                    std::max(solveOrder.row(k0), solveOrder.row(blockEnd - 1)) + 1, marginOfError);
+        }
+        for(auto p=k0; p < blockEnd; ++p){
+            valueType sum{0};
+            for(auto q=k0; q < p; ++q){
+                sum += solveOrder.entry(A, p, q) * x[solveOrder.row(q)];
+            }
+            auto i = solveOrder.row(p);
+            x[i] = isUnitDiagonal ? x[i] - sum : (x[i] - sum) / A(i,i);
+        }
+        if (blockEnd == order) break;
+        parallel_for(blockEnd, order, [&](positiveIntegerType first, positiveIntegerType last){
+            if (isTranspose) {
+                for(auto q=k0; q < blockEnd; ++q){
+                    auto xq = x[solveOrder.row(q)];
+                    for(auto p=first; p < last; ++p){
+                        x[solveOrder.row(p)] -= solveOrder.entry(A, p, q) * xq;
+                    }
+                }
+            } else {
+                for(auto p=first; p < last; ++p){
+                    valueType sum{0};
+                    for(auto q=k0; q < blockEnd; ++q){
+                        sum += solveOrder.entry(A, p, q) * x[solveOrder.row(q)];
+                    }
+                    x[solveOrder.row(p)] -= sum;
+                }
+            }
+        }, grain_size(blockEnd - k0));
+    }
+}
+
+// TRSM (Triangular Solve, Multiple Right-Hand Sides)
+// This function overwrites X with the solution of op(T) * X = X, with op(T) as in
+// trsv. Each diagonal block is solved in parallel over chunks of columns of X, and
+// the rows below it receive the GEMM update X2 -= op(T)21 * X1 in parallel over
+// rows. Every inner loop runs along a row of X, so it has unit stride and the
+// block rows X1 stay in cache while the trailing rows stream past them.
+template <MatrixConcept matrixType, MatrixConcept matrixTypeX>
+void trsm(
+    const matrixType& A,
+    matrixTypeX& X,
+    TriangularPart part,
+    bool isTranspose = false,
+    bool isUnitDiagonal = false,
+    std::optional<scalarType> marginOfError = std::nullopt,
+    positiveIntegerType blockSize = defaultBlockSize)
+{
+    auto order = A.get_number_of_rows();
+    auto numberOfColumns = X.get_number_of_columns();
+    assert(order == A.get_number_of_columns() && X.get_number_of_rows() == order);
+    assert(blockSize > 0);
+    ZLAB_INSTRUMENT("trsm", 1.0 * order * order * numberOfColumns,
+        sizeof(MatrixValueType<matrixType>) * (0.5 * order * order + 2.0 * order * numberOfColumns));
+    TriangularSolveOrder solveOrder(order, part, isTranspose);
+    for(positiveIntegerType k0=0; k0 < order; k0 += blockSize){
+        auto blockEnd = std::min(order, k0 + blockSize);
+        if (!isUnitDiagonal) {
+            check_triangular_pivots(A, std::min(solveOrder.row(k0), solveOrder.row(blockEnd - 1)),
+                                    std::max(solveOrder.row(k0), solveOrder.row(blockEnd - 1)) + 1, marginOfError);
+        }
+        parallel_for(0, numberOfColumns, [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto p=k0; p < blockEnd; ++p){
+                auto i = solveOrder.row(p);
+                for(auto q=k0; q < p; ++q){
+                    auto apq = solveOrder.entry(A, p, q);
+                    auto j = solveOrder.row(q);
+                    for(auto c=first; c < last; ++c){
+                        X(i,c) -= apq * X(j,c);
+                    }
+                }
+                if (isUnitDiagonal) continue;
+                auto inversePivot = MatrixValueType<matrixType>{1} / A(i,i);
+                for(auto c=first; c < last; ++c){
+                    X(i,c) *= inversePivot;
+                }
+            }
+        }, grain_size((blockEnd - k0) * (blockEnd - k0) / 2));
+        if (blockEnd == order) break;
+        parallel_for(blockEnd, order, [&](positiveIntegerType first, positiveIntegerType last){
+            for(auto p=first; p < last; ++p){
+                auto i = solveOrder.row(p);
+                for(auto q=k0; q < blockEnd; ++q){
+                    auto apq = solveOrder.entry(A, p, q);
+                    auto j = solveOrder.row(q);
+                    for(positiveIntegerType c=0; c < numberOfColumns; ++c){
+                        X(i,c) -= apq * X(j,c);
+                    }
+                }
+            }
+        }, grain_size((blockEnd - k0) * numberOfColumns));
+    }
+}
+
+} // end namespace zlab
@@ -10,10 +10,10 @@
 namespace zlab{
 
 // NUMERIC CONCEPT
-// This concept enforces that a type T must be either a standard integral 
-// or floating-point type.
+// This concept enforces that a type T must be either a standard integral,
+// floating-point or complex type.
 template <typename T>
-concept NumericConcept = std::floating_point<T> || std::integral<T>;
+concept NumericConcept = std::floating_point<T> || std::integral<T> || ComplexScalarConcept<T>;
 
 // POW OVERLOAD 1: General Power (Floating-Point Exponent)
 // This uses the standard library's pow function.
@@ -30,7 +30,7 @@ auto pow(T a, U b) {
 // multiplications by halving the exponent (m /= 2) and checking if m is odd (m % 2 == 1).
 template<NumericConcept T, std::integral I>
 auto pow(T a, I n) {
-    using R = scalarType;
+    using R = std::conditional_t<std::integral<T>, scalarType, T>;
     R base{a};
     if (n == 0) return R{1};
     I m = std::abs(n);
@@ -0,0 +1,86 @@
+
+#include <numbers>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "core.hpp"
+#include "math.hpp"
+#include "test_utilities.hpp"
+
+using zlab::tests::symmetric_test_matrix;
+
+namespace {
+    // Eigenvalues of tridiag(-1, 2, -1) of order n are 2 - 2 cos(k pi / (n + 1)).
+    zlab::scalarType laplacian_eigenvalue(zlab::integerType k, zlab::integerType n){
+        return 2 - 2 * std::cos(k * std::numbers::pi / (n + 1));
+    }
+}
+
+TEST(Eigensolvers, SymmetricEigendecomposition){
+    auto n = 37;
+    auto A = symmetric_test_matrix(n);
+    auto [eigenvalues, V] = zlab::symmetric_eigendecomposition(A, 8);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    for(auto k=0; k < n; ++k){
+        if (k > 0) { EXPECT_LE(eigenvalues[k-1], eigenvalues[k]); }
+        for(auto i=0; i < n; ++i){
+            zlab::scalarType Av{0};
+            for(auto j=0; j < n; ++j) Av += A(i,j) * V(j,k);
+            EXPECT_NEAR(Av, eigenvalues[k] * V(i,k), tolerance);
+        }
+        for(auto l=0; l < n; ++l){
+            zlab::scalarType vv{0};
+            for(auto i=0; i < n; ++i) vv += V(i,k) * V(i,l);
+            EXPECT_NEAR(vv, k == l, tolerance);
+        }
+    }
+}
+
+TEST(Eigensolvers, SymmetricEigendecompositionKnownSpectrum){
+    auto n = 50;
+    zlab::ZMatrix A(n,n);
+    for(auto i=0; i < n; ++i){
+        A(i,i) = 2;
+        if (i > 0) A(i,i-1) = -1;
+    }
+    // Only the lower triangle is read.
+    auto [eigenvalues, V] = zlab::symmetric_eigendecomposition(A, 16);
+    for(auto k=0; k < n; ++k){
+        EXPECT_NEAR(eigenvalues[k], laplacian_eigenvalue(k + 1, n), zlab::evaluate_safe_tolerance(1e2));
+    }
+}
+
+TEST(Eigensolvers, LanczosMatrixFree){
+    auto n = 150;
+    auto apply = [n](const zlab::ZVector& x, zlab::ZVector& y){
+        for(auto i=0; i < n; ++i){
+            y[i] = 2 * x[i] - (i > 0 ? x[i-1] : 0) - (i + 1 < n ? x[i+1] : 0);
+        }
+    };
+    auto tolerance = zlab::evaluate_safe_tolerance(1e6);
+    auto [largest, largestVectors] = zlab::lanczos(apply, n, 3);
+    for(auto k=0; k < 3; ++k){
+        EXPECT_NEAR(largest[k], laplacian_eigenvalue(n - k, n), tolerance);
+    }
+    auto [smallest, smallestVectors] = zlab::lanczos(apply, n, 2, zlab::SpectrumEnd::Smallest);
+    for(auto k=0; k < 2; ++k){
+        EXPECT_NEAR(smallest[k], laplacian_eigenvalue(k + 1, n), tolerance);
+        zlab::ZVector x(n), y(n);
+        for(auto i=0; i < n; ++i) x[i] = smallestVectors(i,k);
+        apply(x, y);
+        axpy(-smallest[k], x, y);
+        EXPECT_NEAR(zlab::norm(x), 1, tolerance);
+        EXPECT_LT(zlab::norm(y), 1e-5);
+    }
+}
+
+TEST(Eigensolvers, LanczosMatchesDenseSolver){
+    auto n = 60;
+    auto A = symmetric_test_matrix(n);
+    auto dense = zlab::symmetric_eigendecomposition(A);
+    auto sparse = zlab::lanczos(A, 4, zlab::SpectrumEnd::Largest);
+    for(auto k=0; k < 4; ++k){
+        EXPECT_NEAR(sparse.eigenvalues[k], dense.eigenvalues[n - 1 - k], zlab::evaluate_safe_tolerance(1e4));
+    }
+}
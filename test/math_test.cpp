@@ -1,8 +1,16 @@
 
+#include <sstream>
+#include <limits>
+#include <vector>
+#include <cmath>
+
 #include "gtest/gtest.h"
 
 #include "core.hpp"
 #include "math.hpp"
+#include "test_utilities.hpp"
+
+using zlab::tests::test_matrix;
 
 TEST(FastPowerFunction, PositiveExponent) {
     auto expectedValue = zlab::pow(2.0,2);
@@ -17,3 +25,105 @@ TEST(FastPowerFunction, NegativeExponent) {
     auto tolerance = zlab::evaluate_safe_tolerance();
     EXPECT_NEAR(expectedValue, actualValue, tolerance); 
 }
+
+TEST(ThreadPool, ParallelForCoversRangeOnce) {
+    std::vector<int> visits(1000, 0);
+    {
+        zlab::ThreadScope threads(4);
+        zlab::parallel_for(0, visits.size(), [&](zlab::positiveIntegerType first, zlab::positiveIntegerType last){
+            for(auto i=first; i < last; ++i) visits[i] += 1;
+        });
+    }
+    for(auto visit : visits){
+        EXPECT_EQ(visit, 1);
+    }
+}
+
+TEST(ThreadPool, ParallelLUMatchesSerial) {
+    zlab::integerType order = 40;
+    auto A = test_matrix(order,order);
+    zlab::ThreadScope serialThreads(1);
+    auto serial = zlab::partial_pivoting_lu(A, std::nullopt, 8);
+    zlab::ThreadScope parallelThreads(4);
+    auto parallel = zlab::partial_pivoting_lu(A, std::nullopt, 8);
+    for(auto i=0; i < order; ++i){
+        EXPECT_EQ(serial.pivots[i], parallel.pivots[i]);
+        for(auto j=0; j < order; ++j) EXPECT_EQ(serial.LU(i,j), parallel.LU(i,j));
+    }
+}
+
+TEST(Reductions, ReproducibleAcrossThreadCounts) {
+    zlab::ScopedSummationMode mode(zlab::SummationMode::Reproducible);
+    zlab::integerType size = 50000;
+    zlab::ZVector x(size), y(size);
+    for(auto i=0; i < size; ++i){
+        x[i] = std::sin(0.7 * i) * std::pow(10.0, i % 13 - 6);
+        y[i] = std::cos(1.3 * i);
+    }
+    std::vector<zlab::scalarType> dots, norms, infinityNorms;
+    for(zlab::positiveIntegerType numberOfThreads : {1, 2, 3, 4}){
+        zlab::ThreadScope threads(numberOfThreads);
+        dots.push_back(zlab::dot(x, y));
+        norms.push_back(zlab::norm(x, 3));
+        infinityNorms.push_back(zlab::norm(x, std::numeric_limits<zlab::scalarType>::infinity()));
+    }
+    for(auto k=1; k < dots.size(); ++k){
+        EXPECT_EQ(dots[k], dots[0]);
+        EXPECT_EQ(norms[k], norms[0]);
+        EXPECT_EQ(infinityNorms[k], infinityNorms[0]);
+    }
+    zlab::ScopedSummationMode fast(zlab::SummationMode::Fast);
+    EXPECT_NEAR(zlab::dot(x, y), dots[0], zlab::evaluate_safe_tolerance(1e4) * std::abs(dots[0]) + 1e-12);
+}
+
+TEST(Reductions, CompensatedSum) {
+    zlab::positiveIntegerType size = 20000;
+    auto term = [](zlab::positiveIntegerType i){ return i == 0 ? 1.0 : 1e-16; };
+    auto exactSum = 1.0 + (size - 1) * 1e-16;
+    zlab::ScopedSummationMode mode(zlab::SummationMode::Reproducible);
+    EXPECT_NEAR(zlab::parallel_sum<zlab::scalarType>(size, term), exactSum, 1e-16);
+    EXPECT_EQ(zlab::parallel_sum<zlab::scalarType>(0, term), 0);
+}
+
+TEST(Instrumentation, ScopedRegionAggregatesAndTraces) {
+    zlab::instrumentation::reset();
+    zlab::instrumentation::enable_tracing(true);
+    for(auto i=0; i < 3; ++i){
+        zlab::instrumentation::ScopedRegion region("test_region", 10, 16);
+    }
+    zlab::instrumentation::enable_tracing(false);
+    auto regions = zlab::instrumentation::collect();
+    ASSERT_EQ(regions.count("test_region"), 1);
+    EXPECT_EQ(regions["test_region"].calls, 3);
+    EXPECT_EQ(regions["test_region"].flops, 30);
+    EXPECT_EQ(regions["test_region"].bytes, 48);
+    std::ostringstream report, trace;
+    zlab::instrumentation::write_report(report);
+    zlab::instrumentation::write_chrome_trace(trace);
+    EXPECT_NE(report.str().find("test_region"), std::string::npos);
+    EXPECT_NE(trace.str().find("\"name\":\"test_region\""), std::string::npos);
+    zlab::instrumentation::reset();
+    EXPECT_TRUE(zlab::instrumentation::collect().empty());
+}
+
+TEST(Instrumentation, LibraryRegions) {
+    zlab::instrumentation::reset();
+    auto evaluations = 0;
+    auto count_evaluation = [&evaluations]{ return ++evaluations; };
+    {
+        ZLAB_INSTRUMENT("macro_region", count_evaluation(), 0);
+    }
+    zlab::ZMatrix A(4,3), B(3,5), C(4,5);
+    zlab::gemm(A, B, C);
+    auto regions = zlab::instrumentation::collect();
+#if defined(ZLAB_ENABLE_INSTRUMENTATION)
+    EXPECT_EQ(evaluations, 1);
+    EXPECT_EQ(regions["gemm"].calls, 1);
+    EXPECT_EQ(regions["gemm"].flops, 2 * 4 * 5 * 3);
+#else
+    // Disabled instrumentation must not even evaluate the work expressions.
+    EXPECT_EQ(evaluations, 0);
+    EXPECT_TRUE(regions.empty());
+#endif
+    zlab::instrumentation::reset();
+}
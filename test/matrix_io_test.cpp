@@ -0,0 +1,142 @@
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <cstring>
+#include <vector>
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "core.hpp"
+#include "math.hpp"
+#include "test_utilities.hpp"
+
+using zlab::tests::test_matrix;
+
+namespace {
+    std::string temporary_path(const std::string& name){
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+}
+
+TEST(MatrixIO, SaveAndLoad){
+    auto path = temporary_path("zlab_matrix_io_save_load.zmat");
+    auto A = test_matrix(7,4);
+    zlab::save_matrix(path, A);
+    auto B = zlab::load_matrix(path);
+    ASSERT_EQ(B.get_number_of_rows(), 7);
+    ASSERT_EQ(B.get_number_of_columns(), 4);
+    for(auto i=0; i < 7; ++i){
+        for(auto j=0; j < 4; ++j) EXPECT_EQ(B(i,j), A(i,j));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(MatrixIO, MappedMatrixInKernelsAndSolvers){
+    auto path = temporary_path("zlab_matrix_io_mapped.zmat");
+    auto A = test_matrix(9,4);
+    zlab::save_matrix(path, A);
+    zlab::MappedMatrix M(path);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(M.data()) % zlab::memoryAlignment, 0);
+
+    zlab::ZVector b(9), x(4), xMapped(4), y(9), yMapped(9);
+    for(auto i=0; i < 9; ++i) b[i] = std::sin(i + 1.0);
+    for(auto j=0; j < 4; ++j) x[j] = std::cos(j + 0.5);
+    zlab::gemv(A, x, y, 1, 0, false);
+    zlab::gemv(M, x, yMapped, 1, 0, false);
+    zlab::ZMatrix G(4,4), GMapped(4,4);
+    zlab::gemm(A, A, G, 1, 0, true);
+    zlab::gemm(M, M, GMapped, 1, 0, true);
+    zlab::linear_least_squares(A, b, x);
+    zlab::linear_least_squares(M, b, xMapped);
+    for(auto i=0; i < 9; ++i) EXPECT_EQ(y[i], yMapped[i]);
+    for(auto i=0; i < 4; ++i){
+        EXPECT_EQ(x[i], xMapped[i]);
+        for(auto j=0; j < 4; ++j) EXPECT_EQ(G(i,j), GMapped(i,j));
+    }
+    zlab::ZVector xNormal(4), xRankRevealing(4);
+    zlab::normal_equations_least_squares(M, b, xNormal);
+    zlab::rank_revealing_least_squares(M, b, xRankRevealing);
+    for(auto i=0; i < 4; ++i){
+        EXPECT_NEAR(xNormal[i], x[i], zlab::evaluate_safe_tolerance(1e4));
+        EXPECT_NEAR(xRankRevealing[i], x[i], zlab::evaluate_safe_tolerance(1e4));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(MatrixIO, RejectsInvalidFiles){
+    auto path = temporary_path("zlab_matrix_io_invalid.zmat");
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "this is not a matrix file, but it is long enough to hold a header......";
+    }
+    EXPECT_THROW(zlab::load_matrix(path), std::runtime_error);
+    EXPECT_THROW(zlab::MappedMatrix{path}, std::runtime_error);
+    auto A = test_matrix(5,5);
+    zlab::save_matrix(path, A);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_THROW(zlab::MappedMatrix{path}, std::runtime_error);
+    std::filesystem::remove(path);
+    EXPECT_THROW(zlab::load_matrix(path), std::runtime_error);
+}
+
+TEST(MatrixIO, RejectsOverflowingDimensions){
+    auto path = temporary_path("zlab_matrix_io_overflow.zmat");
+    zlab::save_matrix(path, test_matrix(8,8));
+    auto rewrite_dimensions = [&path](std::uint64_t numberOfRows, std::uint64_t numberOfColumns){
+        zlab::MatrixFileHeader header{};
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.read(reinterpret_cast<char*>(&header), sizeof(header));
+        header.numberOfRows = numberOfRows;
+        header.numberOfColumns = numberOfColumns;
+        file.seekp(0);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    };
+    // 2^61 * 8 elements of 8 bytes wrap to a size of zero.
+    rewrite_dimensions(std::uint64_t{1} << 61, 8);
+    EXPECT_THROW(zlab::load_matrix(path), std::runtime_error);
+    EXPECT_THROW(zlab::MappedMatrix{path}, std::runtime_error);
+    rewrite_dimensions(std::uint64_t{1} << 32, 1);
+    EXPECT_THROW(zlab::load_matrix(path), std::runtime_error);
+    EXPECT_THROW(zlab::MappedMatrix{path}, std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(MatrixIO, RejectsMisalignedData){
+    auto path = temporary_path("zlab_matrix_io_misaligned.zmat");
+    zlab::save_matrix(path, test_matrix(8,8));
+    // Shift the elements by 4 bytes and declare a 4-byte alignment, so that the
+    // offset is a multiple of the declared alignment but not of alignof(double).
+    std::vector<char> bytes(std::filesystem::file_size(path));
+    {
+        std::ifstream file(path, std::ios::binary);
+        file.read(bytes.data(), bytes.size());
+    }
+    zlab::MatrixFileHeader header{};
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    header.alignment = 4;
+    header.dataOffset = sizeof(header) + 4;
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write("pad!", 4);
+        file.write(bytes.data() + sizeof(header), bytes.size() - sizeof(header));
+    }
+    EXPECT_THROW(zlab::load_matrix(path), std::runtime_error);
+    EXPECT_THROW(zlab::MappedMatrix{path}, std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+TEST(MatrixIO, WriterCloseIsIdempotent){
+    auto path = temporary_path("zlab_matrix_io_close.zmat");
+    {
+        zlab::MatrixFileWriter writer(path, 1, 2);
+        zlab::scalarType row[2] = {1, 2};
+        writer.write_row(row);
+        writer.close();
+        EXPECT_NO_THROW(writer.close());
+    }
+    EXPECT_EQ(zlab::load_matrix(path)(0,1), 2);
+    std::filesystem::remove(path);
+}
@@ -260,3 +260,466 @@ TEST(ODE, OrderOfConvergenceClassicalRK4){
     EXPECT_NEAR(slope, expectedSlope, tolerance); 
 }
 
+
+TEST(ODE, ComplexState){
+    using namespace zlab;
+    using complexType = std::complex<scalarType>;
+    auto method = ClassicalRK4;
+    auto& numberOfStages = method.numberOfStages;
+    // y' = i y has the solution exp(i t).
+    auto f = [](scalarType /*t*/, const BasicZVector<complexType>& y, BasicZVector<complexType>& f) {
+        f[0] = complexType(0, 1) * y[0];
+    };
+    BasicZVector<complexType> y0(1, 1);
+    integerType numberTimeSteps{100};
+    scalarType timeStep = scalarType{1} / numberTimeSteps;
+    RKSolver<numberOfStages, decltype(f), complexType> ode(f, y0, timeStep, numberTimeSteps, method);
+    auto yn = ode.solve();
+    EXPECT_NEAR(std::abs(yn[0] - std::exp(complexType(0, 1))), 0, 1e-9);
+}
+
+namespace {
+    // Runs solve with a callback that copies every state it is given, then checks that
+    // scratch allocated later on this thread does not overwrite the copies.
+    template<typename solveType>
+    void expect_callback_copies_outlive_solve(solveType&& solve){
+        using namespace zlab;
+        std::vector<ZVector> trajectory;
+        std::vector<std::vector<scalarType>> values;
+        solve([&](integerType, const ZVector& y){
+            trajectory.push_back(y.copy());
+            values.emplace_back();
+            for(positiveIntegerType i=0; i < y.size(); ++i) values.back().push_back(y[i]);
+        });
+        ASSERT_FALSE(trajectory.empty());
+        ScopedWorkspace workspace;
+        ZVector scratch(1000, 42.0);
+        for(positiveIntegerType k=0; k < trajectory.size(); ++k){
+            for(positiveIntegerType i=0; i < values[k].size(); ++i){
+                EXPECT_EQ(trajectory[k][i], values[k][i]);
+            }
+        }
+    }
+}
+
+TEST(ODE, CallbackCopiesOutliveSolve){
+    using namespace zlab;
+    auto f = [](scalarType /*t*/, const ZVector& y, ZVector& f) {
+        f[0] = -y[0];
+    };
+    ZVector y0(1, 1);
+    integerType numberTimeSteps{10};
+    RKSolver<ClassicalRK4.numberOfStages, decltype(f)> ode(f, y0, 0.1, numberTimeSteps, ClassicalRK4);
+    expect_callback_copies_outlive_solve([&](auto callback){ ode.solve(callback); });
+}
+
+TEST(ODE, PararealConvergesToFineSolution){
+    using namespace zlab;
+    // Damped oscillator with a time-dependent forcing.
+    auto f = [](scalarType t, const ZVector& y, ZVector& f) {
+        f[0] = y[1];
+        f[1] = -4 * y[0] - 0.5 * y[1] + std::sin(t);
+    };
+    ZVector y0(2);
+    y0[0] = 1;
+    scalarType finalTime = 8;
+    positiveIntegerType numberOfSlices = 16, fineSteps = 50;
+    RKSolver<ClassicalRK4.numberOfStages, decltype(f)> sequential(f, y0, finalTime / (numberOfSlices * fineSteps),
+        numberOfSlices * fineSteps, ClassicalRK4);
+    auto expected = sequential.solve();
+    auto solution = parareal(f, y0, finalTime, numberOfSlices, RalstonsMethod2, 2, ClassicalRK4, fineSteps);
+    EXPECT_LT(solution.numberOfIterations, numberOfSlices);
+    EXPECT_EQ(solution.states.size(), numberOfSlices + 1);
+    for(auto i=0; i < 2; ++i){
+        EXPECT_NEAR(solution.states[numberOfSlices][i], expected[i], 1e-6);
+    }
+}
+
+TEST(ODE, PararealExactAfterAllSlices){
+    using namespace zlab;
+    auto f = [](scalarType t, const ZVector& y, ZVector& f) {
+        f[0] = -y[0] * y[0] + std::cos(t);
+    };
+    ZVector y0(1, 1);
+    positiveIntegerType numberOfSlices = 4, fineSteps = 20;
+    RKSolver<ClassicalRK4.numberOfStages, decltype(f)> sequential(f, y0, scalarType{2} / (numberOfSlices * fineSteps),
+        numberOfSlices * fineSteps, ClassicalRK4);
+    auto expected = sequential.solve();
+    ThreadScope threads(4);
+    // A margin of zero never accepts early, so every slice is propagated finely.
+    auto solution = parareal(f, y0, scalarType{2}, numberOfSlices, ExplicitEuler, 1, ClassicalRK4, fineSteps, 0.0);
+    EXPECT_EQ(solution.numberOfIterations, numberOfSlices);
+    EXPECT_NEAR(solution.states[numberOfSlices][0], expected[0], 1e-12);
+}
+
+namespace {
+    template <typename tableauType>
+    zlab::scalarType low_storage_order_of_convergence(const tableauType& tableau){
+        using namespace zlab;
+        // y' = -y + t has the solution t - 1 + 2 exp(-t) from y(0) = 1.
+        auto f = [](scalarType t, const ZVector& y, ZVector& f) {
+            f[0] = -y[0] + t;
+        };
+        auto exactSolution = 2 * std::exp(-1);
+        scalarType errors[2];
+        for(auto refinement=0; refinement < 2; ++refinement){
+            integerType numberTimeSteps = 10 << refinement;
+            ZVector y(1, 1);
+            LSRKSolver<tableauType, decltype(f)> ode(f, scalarType{1} / numberTimeSteps, numberTimeSteps, tableau);
+            ode.solve(y);
+            errors[refinement] = std::abs(y[0] - exactSolution);
+        }
+        return std::log2(errors[0] / errors[1]);
+    }
+}
+
+TEST(ODE, OrderOfConvergenceLowStorage){
+    using namespace zlab;
+    scalarType tolerance{1e-1};
+    EXPECT_NEAR(low_storage_order_of_convergence(LSRK3), 3, tolerance);
+    EXPECT_NEAR(low_storage_order_of_convergence(LSRK4), 4, tolerance);
+    EXPECT_NEAR(low_storage_order_of_convergence(LowStorageSSPRK3), 3, tolerance);
+    EXPECT_NEAR(low_storage_order_of_convergence(LowStorageSSPRK52), 2, tolerance);
+}
+
+TEST(ODE, LowStorageMatchesButcherTableau){
+    using namespace zlab;
+    auto f = [](scalarType t, const ZVector& y, ZVector& f) {
+        f[0] = y[1];
+        f[1] = -y[0] + std::cos(t);
+    };
+    ZVector y0(2), y(2);
+    y0[0] = 1; y[0] = 1;
+    scalarType timeStep = 0.05;
+    integerType numberTimeSteps{40};
+    RKSolver<SSPRK3.numberOfStages, decltype(f)> ode(f, y0, timeStep, numberTimeSteps, SSPRK3, 0.5);
+    auto expected = ode.solve();
+    integerType numberOfCallbacks{0};
+    LSRKSolver<LowStorageTableau2S<3>, decltype(f)> lowStorageOde(f, timeStep, numberTimeSteps, LowStorageSSPRK3, 0.5);
+    lowStorageOde.solve(y, [&](integerType, const ZVector&){ numberOfCallbacks++; });
+    EXPECT_EQ(numberOfCallbacks, numberTimeSteps);
+    auto tolerance = evaluate_safe_tolerance();
+    for(auto i=0; i < 2; ++i){
+        EXPECT_NEAR(y[i], expected[i], tolerance);
+    }
+}
+
+TEST(ODE, LowStorageCallbackCopiesOutliveSolve){
+    using namespace zlab;
+    auto f = [](scalarType /*t*/, const ZVector& y, ZVector& f) {
+        f[0] = -y[0];
+    };
+    ZVector y(1, 1);
+    LSRKSolver<LowStorageTableau2N<3>, decltype(f)> ode(f, 0.1, 10, LSRK3);
+    expect_callback_copies_outlive_solve([&](auto callback){ ode.solve(y, callback); });
+}
+
+namespace {
+    // Non-stiff nonlinear part and a linear part treated implicitly.
+    void imex_explicit_part(zlab::scalarType t, const zlab::ZVector& y, zlab::ZVector& f) {
+        f[0] = -y[0] * y[1];
+        f[1] = std::cos(t) * y[0];
+    }
+    void imex_implicit_part(zlab::scalarType, const zlab::ZVector& y, zlab::ZVector& f) {
+        f[0] = -2 * y[0] + y[1];
+        f[1] = y[0] - 3 * y[1];
+    }
+    void imex_implicit_jacobian(zlab::scalarType, const zlab::ZVector&, zlab::ZMatrix& J) {
+        J(0,0) = -2; J(0,1) = 1;
+        J(1,0) = 1; J(1,1) = -3;
+    }
+
+    template <zlab::positiveIntegerType numberOfStages>
+    zlab::scalarType imex_order_of_convergence(const zlab::AdditiveButcherTableau<numberOfStages>& tableau){
+        using namespace zlab;
+        ZVector y0(2);
+        y0[0] = 1; y0[1] = 0.5;
+        auto f = [](scalarType t, const ZVector& y, ZVector& f) {
+            ZVector g(2);
+            imex_explicit_part(t, y, f);
+            imex_implicit_part(t, y, g);
+            axpy(1, g, f);
+        };
+        RKSolver<ClassicalRK4.numberOfStages, decltype(f)> reference(f, y0, scalarType{1} / 4000, 4000, ClassicalRK4);
+        auto exactSolution = reference.solve();
+        scalarType errors[2];
+        for(auto refinement=0; refinement < 2; ++refinement){
+            integerType numberTimeSteps = 10 << refinement;
+            ARKSolver<numberOfStages, decltype(&imex_explicit_part), decltype(&imex_implicit_part), decltype(&imex_implicit_jacobian)>
+                ode(imex_explicit_part, imex_implicit_part, imex_implicit_jacobian, y0, scalarType{1} / numberTimeSteps, numberTimeSteps, tableau);
+            auto y = ode.solve();
+            errors[refinement] = std::max(std::abs(y[0] - exactSolution[0]), std::abs(y[1] - exactSolution[1]));
+        }
+        return std::log2(errors[0] / errors[1]);
+    }
+}
+
+TEST(ODE, OrderOfConvergenceAdditiveRungeKutta){
+    using namespace zlab;
+    scalarType tolerance{1.5e-1};
+    EXPECT_NEAR(imex_order_of_convergence(IMEXEuler), 1, tolerance);
+    EXPECT_NEAR(imex_order_of_convergence(ARK324L2SA), 3, tolerance);
+    EXPECT_NEAR(imex_order_of_convergence(ARK436L2SA), 4, tolerance);
+}
+
+TEST(ODE, AdditiveRungeKuttaStiffLinearPart){
+    using namespace zlab;
+    // Prothero-Robinson: y' = L * (y - sin(t)) + cos(t) has the solution y = sin(t)
+    // for any L; the stiff L would force h < 1e-6 on an explicit method.
+    ZMatrix L(2,2);
+    L(0,0) = -1e6; L(0,1) = 1e3;
+    L(1,1) = -1e4;
+    auto FE = [](scalarType t, const ZVector&, ZVector& f) {
+        f.fill(std::cos(t));
+    };
+    auto FI = [&L](scalarType t, const ZVector& y, ZVector& f) {
+        ZVector deviation(2);
+        for(auto i=0; i < 2; ++i) deviation[i] = y[i] - std::sin(t);
+        gemv(L, deviation, f, 1, 0, false);
+    };
+    auto jacobian = [&L](scalarType, const ZVector&, ZMatrix& J) {
+        J = L;
+    };
+    ZVector y0(2);
+    integerType numberTimeSteps{100};
+    ARKSolver<ARK436L2SA.numberOfStages, decltype(FE), decltype(FI), decltype(jacobian)>
+        ode(FE, FI, jacobian, y0, scalarType{0.02}, numberTimeSteps, ARK436L2SA);
+    auto y = ode.solve();
+    EXPECT_EQ(ode.get_number_of_factorizations(), 1);
+    // Stiff order reduction to the stage order (two) limits the accuracy.
+    for(auto i=0; i < 2; ++i){
+        EXPECT_NEAR(y[i], std::sin(2.0), 1e-6);
+    }
+}
+
+TEST(ODE, AdditiveRungeKuttaRejectsFullyImplicitTableau){
+    using namespace zlab;
+    AdditiveButcherTableau<2> tableau = {IMEXEuler.explicitTableau, IMEXEuler.implicitTableau};
+    tableau.implicitTableau.A[0][1] = 0.5;
+    ZVector y0(2);
+    using solverType = ARKSolver<2, decltype(&imex_explicit_part), decltype(&imex_implicit_part), decltype(&imex_implicit_jacobian)>;
+    EXPECT_THROW(solverType(imex_explicit_part, imex_implicit_part, imex_implicit_jacobian, y0, 0.1, 10, tableau),
+        std::invalid_argument);
+}
+
+namespace {
+    // One slow component coupled to a fast oscillator.
+    void multirate_slow_part(zlab::scalarType, const zlab::ZVector& y, zlab::ZVector& f) {
+        f[0] = -0.5 * y[0] + 0.1 * y[1];
+    }
+    void multirate_fast_part(zlab::scalarType t, const zlab::ZVector& y, zlab::ZVector& f) {
+        f[1] = 20 * y[2];
+        f[2] = -20 * y[1] + y[0] + std::cos(t);
+    }
+
+    template <zlab::positiveIntegerType slowStages>
+    zlab::scalarType multirate_order_of_convergence(const zlab::ButcherTableau<slowStages>& slowTableau){
+        using namespace zlab;
+        ZVector y0(3);
+        y0[0] = 1; y0[1] = 0.5;
+        auto f = [](scalarType t, const ZVector& y, ZVector& f) {
+            multirate_slow_part(t, y, f);
+            multirate_fast_part(t, y, f);
+        };
+        RKSolver<ClassicalRK4.numberOfStages, decltype(f)> reference(f, y0, scalarType{1} / 20000, 20000, ClassicalRK4);
+        auto exactSolution = reference.solve();
+        scalarType errors[2];
+        for(auto refinement=0; refinement < 2; ++refinement){
+            integerType numberTimeSteps = 40 << refinement;
+            MRKSolver<slowStages, ClassicalRK4.numberOfStages, decltype(&multirate_slow_part), decltype(&multirate_fast_part)>
+                ode(multirate_slow_part, multirate_fast_part, {1, 2}, y0, scalarType{1} / numberTimeSteps, numberTimeSteps,
+                    40, slowTableau, ClassicalRK4);
+            auto y = ode.solve();
+            errors[refinement] = 0;
+            for(auto i=0; i < 3; ++i) errors[refinement] = std::max(errors[refinement], std::abs(y[i] - exactSolution[i]));
+        }
+        return std::log2(errors[0] / errors[1]);
+    }
+}
+
+TEST(ODE, OrderOfConvergenceMultirate){
+    using namespace zlab;
+    EXPECT_NEAR(multirate_order_of_convergence(KnothWolke3), 3, 2e-1);
+    // Beyond the MIS coupling conditions, which KnothWolke3 satisfies, the order is two.
+    EXPECT_NEAR(multirate_order_of_convergence(ClassicalRK4), 2, 3e-1);
+}
+
+TEST(ODE, MultirateWithOnlyFastComponentsIsSingleRate){
+    using namespace zlab;
+    auto f = [](scalarType t, const ZVector& y, ZVector& f) {
+        f[0] = y[1];
+        f[1] = -y[0] + std::sin(t);
+    };
+    ZVector y0(2);
+    y0[0] = 1;
+    integerType numberTimeSteps{20};
+    // ClassicalRK4 spans two half-step intervals, each with one fast step.
+    MRKSolver<ClassicalRK4.numberOfStages, ClassicalRK4.numberOfStages, decltype(f), decltype(f)>
+        ode(f, f, {0, 1}, y0, scalarType{0.1}, numberTimeSteps, 2, ClassicalRK4, ClassicalRK4);
+    RKSolver<ClassicalRK4.numberOfStages, decltype(f)> singleRate(f, y0, scalarType{0.05}, 2 * numberTimeSteps, ClassicalRK4);
+    auto y = ode.solve();
+    auto expected = singleRate.solve();
+    for(auto i=0; i < 2; ++i){
+        EXPECT_NEAR(y[i], expected[i], 1e-13);
+    }
+}
+
+TEST(ODE, MultirateRejectsDecreasingNodes){
+    using namespace zlab;
+    ZVector y0(3);
+    using solverType = MRKSolver<SSPRK3.numberOfStages, ClassicalRK4.numberOfStages, decltype(&multirate_slow_part), decltype(&multirate_fast_part)>;
+    EXPECT_THROW(solverType(multirate_slow_part, multirate_fast_part, {1, 2}, y0, 0.1, 10, 4, SSPRK3, ClassicalRK4),
+        std::invalid_argument);
+    using knothWolkeSolverType = MRKSolver<KnothWolke3.numberOfStages, ClassicalRK4.numberOfStages, decltype(&multirate_slow_part), decltype(&multirate_fast_part)>;
+    EXPECT_THROW(knothWolkeSolverType(multirate_slow_part, multirate_fast_part, {1, 1}, y0, 0.1, 10, 4, KnothWolke3, ClassicalRK4),
+        std::invalid_argument);
+}
+
+TEST(ODE, MultirateCoupledComponents){
+    using namespace zlab;
+    // Component 3 is slow and never read by the fast part.
+    auto slowPart = [](scalarType t, const ZVector& y, ZVector& f) {
+        multirate_slow_part(t, y, f);
+        f[3] = -y[3] + y[0];
+    };
+    ZVector y0(4);
+    y0[0] = 1; y0[1] = 0.5; y0[3] = 2;
+    integerType numberTimeSteps{40};
+    using solverType = MRKSolver<KnothWolke3.numberOfStages, ClassicalRK4.numberOfStages, decltype(slowPart), decltype(&multirate_fast_part)>;
+    solverType allCoupled(slowPart, multirate_fast_part, {1, 2}, y0, scalarType{0.025}, numberTimeSteps, 20, KnothWolke3, ClassicalRK4);
+    solverType oneCoupled(slowPart, multirate_fast_part, {1, 2}, y0, scalarType{0.025}, numberTimeSteps, 20, KnothWolke3, ClassicalRK4,
+        0, std::vector<positiveIntegerType>{0});
+    auto expected = allCoupled.solve();
+    auto y = oneCoupled.solve();
+    for(auto i=0; i < 4; ++i){
+        EXPECT_NEAR(y[i], expected[i], 1e-13);
+    }
+    EXPECT_THROW(solverType(slowPart, multirate_fast_part, {1, 2}, y0, 0.1, 10, 4, KnothWolke3, ClassicalRK4, 0,
+        std::vector<positiveIntegerType>{1}), std::invalid_argument);
+}
+
+TEST(ODE, MultirateUncoupledComponentsKeepStageStartValues){
+    using namespace zlab;
+    // The fast part reads component 3 (y_3 = 2 + t) without listing it as coupled.
+    auto slowPart = [](scalarType t, const ZVector& y, ZVector& f) {
+        multirate_slow_part(t, y, f);
+        f[3] = 1;
+    };
+    scalarType smallestSeen = 2;
+    auto fastPart = [&smallestSeen](scalarType t, const ZVector& y, ZVector& f) {
+        multirate_fast_part(t, y, f);
+        f[2] += 0.1 * y[3];
+        smallestSeen = std::min(smallestSeen, y[3]);
+    };
+    ZVector y0(4);
+    y0[0] = 1; y0[1] = 0.5; y0[3] = 2;
+    using solverType = MRKSolver<KnothWolke3.numberOfStages, ClassicalRK4.numberOfStages, decltype(slowPart), decltype(fastPart)>;
+    solverType allCoupled(slowPart, fastPart, {1, 2}, y0, scalarType{0.025}, 40, 20, KnothWolke3, ClassicalRK4);
+    solverType oneCoupled(slowPart, fastPart, {1, 2}, y0, scalarType{0.025}, 40, 20, KnothWolke3, ClassicalRK4,
+        0, std::vector<positiveIntegerType>{0});
+    auto expected = allCoupled.solve();
+    auto y = oneCoupled.solve();
+    EXPECT_EQ(smallestSeen, 2);
+    for(auto i=0; i < 4; ++i){
+        EXPECT_NEAR(y[i], expected[i], 1e-3);
+    }
+}
+
+TEST(ODE, MultirateCallbackCopiesOutliveSolve){
+    using namespace zlab;
+    ZVector y0(3);
+    y0[0] = 1; y0[1] = 0.5;
+    using solverType = MRKSolver<KnothWolke3.numberOfStages, ClassicalRK4.numberOfStages, decltype(&multirate_slow_part), decltype(&multirate_fast_part)>;
+    solverType ode(multirate_slow_part, multirate_fast_part, {1, 2}, y0, scalarType{0.1}, 10, 4, KnothWolke3, ClassicalRK4);
+    expect_callback_copies_outlive_solve([&](auto callback){ ode.solve(callback); });
+}
+
+namespace {
+    // Damped pendulum with the parameters p = (stiffness, damping).
+    struct Pendulum {
+        zlab::scalarType stiffness, damping;
+        void operator()(zlab::scalarType t, const zlab::ZVector& y, zlab::ZVector& f) const {
+            f[0] = y[1];
+            f[1] = -stiffness * std::sin(y[0]) - damping * y[1] + 0.1 * std::cos(t);
+        }
+    };
+
+    zlab::scalarType pendulum_objective(const zlab::ZVector& y0, zlab::scalarType stiffness, zlab::scalarType damping,
+                                        zlab::integerType numberTimeSteps){
+        using namespace zlab;
+        RKSolver<ClassicalRK4.numberOfStages, Pendulum> ode(Pendulum{stiffness, damping}, y0,
+            scalarType{2} / numberTimeSteps, numberTimeSteps, ClassicalRK4);
+        auto y = ode.solve();
+        return (y[0] * y[0] + y[1] * y[1]) / 2;
+    }
+}
+
+TEST(ODE, AdjointGradientMatchesFiniteDifferences){
+    using namespace zlab;
+    scalarType stiffness = 3, damping = 0.2;
+    integerType numberTimeSteps{20};
+    auto vectorJacobianProduct = [&](scalarType, const ZVector& y, const ZVector& w, ZVector& wy, ZVector& wp){
+        wy[0] = -stiffness * std::cos(y[0]) * w[1];
+        wy[1] = w[0] - damping * w[1];
+        wp[0] = -std::sin(y[0]) * w[1];
+        wp[1] = -y[1] * w[1];
+    };
+    ZVector y0(2);
+    y0[0] = 1; y0[1] = -0.5;
+    AdjointRKSolver<ClassicalRK4.numberOfStages, Pendulum, decltype(vectorJacobianProduct)>
+        adjoint(Pendulum{stiffness, damping}, vectorJacobianProduct, y0, scalarType{2} / numberTimeSteps, numberTimeSteps,
+                ClassicalRK4, 2, 3);
+    auto result = adjoint.gradient([](const ZVector& y, ZVector& lambda){ lambda = y; });
+
+    scalarType step = 1e-6, tolerance = 1e-8;
+    for(auto i=0; i < 2; ++i){
+        auto plus = y0.copy(), minus = y0.copy();
+        plus[i] += step; minus[i] -= step;
+        auto difference = (pendulum_objective(plus, stiffness, damping, numberTimeSteps)
+                         - pendulum_objective(minus, stiffness, damping, numberTimeSteps)) / (2 * step);
+        EXPECT_NEAR(result.stateGradient[i], difference, tolerance);
+    }
+    auto stiffnessDifference = (pendulum_objective(y0, stiffness + step, damping, numberTimeSteps)
+                              - pendulum_objective(y0, stiffness - step, damping, numberTimeSteps)) / (2 * step);
+    auto dampingDifference = (pendulum_objective(y0, stiffness, damping + step, numberTimeSteps)
+                            - pendulum_objective(y0, stiffness, damping - step, numberTimeSteps)) / (2 * step);
+    EXPECT_NEAR(result.parameterGradient[0], stiffnessDifference, tolerance);
+    EXPECT_NEAR(result.parameterGradient[1], dampingDifference, tolerance);
+
+    RKSolver<ClassicalRK4.numberOfStages, Pendulum> ode(Pendulum{stiffness, damping}, y0,
+        scalarType{2} / numberTimeSteps, numberTimeSteps, ClassicalRK4);
+    auto finalState = ode.solve();
+    for(auto i=0; i < 2; ++i){
+        EXPECT_NEAR(result.finalState[i], finalState[i], 1e-14);
+    }
+}
+
+TEST(ODE, AdjointCheckpointingTradesMemoryForRecomputation){
+    using namespace zlab;
+    scalarType forcing = 1;
+    auto f = [&](scalarType t, const ZVector& y, ZVector& f) {
+        f[0] = -y[0] * y[0] + forcing * std::sin(t);
+    };
+    auto vectorJacobianProduct = [](scalarType t, const ZVector& y, const ZVector& w, ZVector& wy, ZVector& wp){
+        wy[0] = -2 * y[0] * w[0];
+        wp[0] = std::sin(t) * w[0];
+    };
+    ZVector y0(1, 1);
+    integerType numberTimeSteps{20};
+    // Optimal binomial schedules advance 190, 45 and 19 steps before the 20 reversed ones.
+    std::vector<std::pair<integerType, positiveIntegerType>> budgets = {{1, 210}, {3, 65}, {20, 39}, {50, 39}};
+    scalarType expectedGradient{0}, expectedParameterGradient{0};
+    for(auto [numberOfCheckpoints, numberOfForwardSteps] : budgets){
+        AdjointRKSolver<SSPRK3.numberOfStages, decltype(f), decltype(vectorJacobianProduct)>
+            adjoint(f, vectorJacobianProduct, y0, scalarType{0.05}, numberTimeSteps, SSPRK3, 1, numberOfCheckpoints);
+        auto result = adjoint.gradient([](const ZVector&, ZVector& lambda){ lambda.fill(1); });
+        EXPECT_EQ(result.numberOfForwardSteps, numberOfForwardSteps);
+        if (numberOfCheckpoints == 1) {
+            expectedGradient = result.stateGradient[0];
+            expectedParameterGradient = result.parameterGradient[0];
+        }
+        EXPECT_EQ(result.stateGradient[0], expectedGradient);
+        EXPECT_EQ(result.parameterGradient[0], expectedParameterGradient);
+    }
+    EXPECT_EQ(checkpoint_binomial(2, 3), 10);
+}
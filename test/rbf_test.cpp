@@ -75,3 +75,15 @@ TEST(WendlandC2RBF, OutsideSupport) {
     auto tolerance = zlab::evaluate_safe_tolerance();
     EXPECT_NEAR(rbfExpectedValue, rbfActualValue, tolerance);
 }
+
+TEST(WendlandC2RBF, ComplexRadius) {
+    using complexType = std::complex<zlab::scalarType>;
+    zlab::WendlandC2 rbf{2};
+    zlab::BasicWendlandC2<complexType> complexRbf{complexType(2, 0)};
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for(auto r : {0.0, 0.5, 1.3, 2.5}){
+        EXPECT_NEAR(std::abs(complexRbf.evaluate(r) - rbf.evaluate(r)), 0, tolerance);
+    }
+    zlab::BasicWendlandC2<complexType> shiftedRbf{complexType(2, 1)};
+    EXPECT_GT(std::abs(shiftedRbf.evaluate(1).imag()), 0);
+}
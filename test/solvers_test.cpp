@@ -3,6 +3,10 @@
 
 #include "core.hpp"
 #include "math.hpp"
+#include "test_utilities.hpp"
+
+using zlab::tests::test_entry;
+using zlab::tests::test_matrix;
 
 TEST(Solver, BackwardSubstitution){
     zlab::ZMatrix A(3,3);
@@ -48,6 +52,86 @@ TEST(Solver, ModifiedGramSchmidtIllPosedMatrix){
     }
 }
 
+namespace {
+    // Largest entry of |Q^T * Q - I|.
+    zlab::scalarType loss_of_orthogonality(const zlab::ZMatrix& Q){
+        auto n = Q.get_number_of_columns();
+        zlab::ZMatrix QtQ(n,n);
+        gemm(Q, Q, QtQ, 1, 0, true, false);
+        zlab::scalarType loss{0};
+        for(auto i=0; i < n; ++i){
+            for(auto j=0; j < n; ++j) loss = std::max(loss, std::abs(QtQ(i,j) - (i == j)));
+        }
+        return loss;
+    }
+}
+
+TEST(Solver, BlockGramSchmidt){
+    auto m = 120, n = 50;
+    auto A = test_matrix(m,n);
+    auto [Q, R] = zlab::block_gram_schmidt(A, std::nullopt, 16);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    EXPECT_LT(loss_of_orthogonality(Q), tolerance);
+    zlab::ZMatrix QR(m,n);
+    gemm(Q, R, QR, 1, 0);
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j){
+            EXPECT_NEAR(QR(i,j), A(i,j), tolerance);
+            if (i < n && j < i) { EXPECT_EQ(R(i,j), 0); }
+        }
+    }
+}
+
+TEST(Solver, BlockGramSchmidtIllConditionedMatrix){
+    // A = U * diag(sigma) * V^T with singular values from 1 down to 1e-8.
+    auto m = 80, n = 30;
+    zlab::ZMatrix X(m,n), Y(n,n);
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j) X(i,j) = test_entry(i,j);
+    }
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < n; ++j) Y(i,j) = std::sin(0.71*i*i + 0.9*i*j + 2*j);
+    }
+    auto U = zlab::gram_schmidt(X, zlab::GramSchmidtMethod::Modified).Q;
+    auto V = zlab::gram_schmidt(Y, zlab::GramSchmidtMethod::Modified).Q;
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j) U(i,j) *= std::pow(10.0, -8.0 * j / (n - 1));
+    }
+    zlab::ZMatrix A(m,n);
+    gemm(U, V, A, 1, 0, false, true);
+    auto modified = zlab::gram_schmidt(A, zlab::GramSchmidtMethod::Modified);
+    auto block = zlab::gram_schmidt(A, zlab::GramSchmidtMethod::BlockClassicalTwice);
+    EXPECT_GT(loss_of_orthogonality(modified.Q), 1e-12);
+    EXPECT_LT(loss_of_orthogonality(block.Q), zlab::evaluate_safe_tolerance(1e3));
+}
+
+TEST(Solver, BlockGramSchmidtArnoldiBasis){
+    // The panel kernel extends a Krylov basis one vector at a time: A * Q_k = Q_{k+1} * H.
+    auto n = 60, k = 12;
+    zlab::ZMatrix A(n,n), Q(n,k+1), H(k+1,k);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < n; ++j) A(i,j) = test_entry(i,j);
+        Q(i,0) = 1 / std::sqrt(n);
+    }
+    for(auto j=0; j < k; ++j){
+        auto next = Q.column_view(j+1);
+        gemv(A, Q.column_view(j), next, 1, 0, false);
+        auto basis = Q.block_view(0, 0, n, j+1);
+        auto panel = Q.block_view(0, j+1, n, 1);
+        auto S = H.block_view(0, j, j+1, 1);
+        auto T = H.block_view(j+1, j, 1, 1);
+        zlab::block_classical_gram_schmidt_twice(basis, panel, S, T);
+    }
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    EXPECT_LT(loss_of_orthogonality(Q), tolerance);
+    zlab::ZMatrix AQ(n,k), QH(n,k);
+    gemm(A, Q.block_view(0, 0, n, k), AQ, 1, 0);
+    gemm(Q, H, QH, 1, 0);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < k; ++j) EXPECT_NEAR(AQ(i,j), QH(i,j), 1e2 * tolerance);
+    }
+}
+
 TEST(Solver, LinearLeastSquares){
     zlab::ZMatrix A(3,2,1);
     A(1,1) = 2; A(2,1) = 3;
@@ -60,3 +144,624 @@ TEST(Solver, LinearLeastSquares){
         EXPECT_NEAR(x[i], exactSolution[i], tolerance);
     }
 }
+
+TEST(Solver, Cholesky){
+    zlab::integerType order = 7;
+    zlab::ZMatrix A(order,order,1);
+    for(auto i=0; i < order; ++i) A(i,i) = order + i;
+    zlab::positiveIntegerType blockSize = 3;
+    auto [L] = zlab::cholesky(A, std::nullopt, blockSize);
+    zlab::ZMatrix product(order,order);
+    gemm(L,L,product,1,0,false,true);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for(auto i=0; i < order; ++i){
+        for(auto j=0; j < order; ++j){
+            EXPECT_NEAR(product(i,j), A(i,j), tolerance);
+            if (j > i) { EXPECT_EQ(L(i,j), 0); }
+        }
+    }
+}
+
+TEST(Solver, CholeskyIndefiniteMatrix){
+    zlab::ZMatrix A(2,2,2);
+    A(1,1) = 1;
+    EXPECT_THROW(zlab::cholesky(A), std::runtime_error);
+}
+
+TEST(Solver, LDLT){
+    zlab::integerType order = 6;
+    zlab::ZMatrix A(order,order,1);
+    for(auto i=0; i < order; ++i) A(i,i) = (i % 2 == 0) ? order : -order;
+    zlab::positiveIntegerType blockSize = 4;
+    auto [L, D] = zlab::ldlt(A, std::nullopt, blockSize);
+    zlab::ZMatrix scaledL = L.copy(), product(order,order);
+    for(auto i=0; i < order; ++i){
+        for(auto j=0; j < order; ++j) scaledL(i,j) *= D[j];
+    }
+    gemm(scaledL,L,product,1,0,false,true);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for(auto i=0; i < order; ++i){
+        EXPECT_NEAR(L(i,i), 1, tolerance);
+        for(auto j=0; j < order; ++j){
+            EXPECT_NEAR(product(i,j), A(i,j), tolerance);
+        }
+    }
+}
+
+TEST(Solver, NormalEquationsLeastSquares){
+    zlab::ZMatrix A(3,2,1);
+    A(1,1) = 2; A(2,1) = 3;
+    zlab::ZVector b(3), x(2), exactSolution(2);
+    b[0] = 6;
+    exactSolution[0] = 8; exactSolution[1] = -3;
+    zlab::normal_equations_least_squares(A,b,x);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    for(auto i=0; i<x.size(); ++i){
+        EXPECT_NEAR(x[i], exactSolution[i], tolerance);
+    }
+}
+
+TEST(Solver, LinearSolverNormalEquationsFallback){
+    zlab::ZMatrix A(3,2,1);
+    A(2,0) = 1 + 1e-4;
+    zlab::ZVector b(3), x(2), exactSolution(2);
+    exactSolution[0] = 1; exactSolution[1] = 2;
+    gemv(A,exactSolution,b,1,0,false);
+    EXPECT_THROW(zlab::normal_equations_least_squares(A,b,x), std::runtime_error);
+    zlab::linear_solver(A,b,x,std::nullopt,zlab::LinearSolverMethod::NormalEquations);
+    for(auto i=0; i<x.size(); ++i){
+        EXPECT_NEAR(x[i], exactSolution[i], 1e-6);
+    }
+}
+
+TEST(Solver, PartialPivotingLU){
+    zlab::integerType order = 7;
+    zlab::ZMatrix A(order,order);
+    for(auto i=0; i < order; ++i){
+        for(auto j=0; j < order; ++j) A(i,j) = ((3*i + 5*j) % 11) - 4;
+    }
+    zlab::positiveIntegerType blockSize = 3;
+    auto [LU, pivots] = zlab::partial_pivoting_lu(A, std::nullopt, blockSize);
+    zlab::ZMatrix L(order,order), U(order,order), product(order,order);
+    for(auto i=0; i < order; ++i){
+        for(auto j=0; j < order; ++j){
+            if (j < i) L(i,j) = LU(i,j); else U(i,j) = LU(i,j);
+        }
+        L(i,i) = 1;
+    }
+    gemm(L,U,product,1,0);
+    auto permutedA = A.copy();
+    for(auto i=0; i < order; ++i){
+        for(auto j=0; j < order; ++j) std::swap(permutedA(i,j), permutedA(pivots[i],j));
+    }
+    auto tolerance = zlab::evaluate_safe_tolerance(1e2);
+    for(auto i=0; i < order; ++i){
+        for(auto j=0; j < order; ++j){
+            EXPECT_NEAR(product(i,j), permutedA(i,j), tolerance);
+            if (j < i) { EXPECT_LE(std::abs(LU(i,j)), 1); }
+        }
+    }
+}
+
+TEST(Solver, FactorizationReuse){
+    zlab::integerType order = 5;
+    zlab::ZMatrix A(order,order,1), X(order,3), B(order,3);
+    for(auto i=0; i < order; ++i) A(i,(i+2) % order) = 10;
+    for(auto i=0; i < order; ++i){
+        for(auto c=0; c < 3; ++c) X(i,c) = i - c;
+    }
+    gemm(A,X,B,1,0);
+    zlab::Factorization<zlab::ZMatrix> factorization(A);
+    zlab::ZMatrix solution(order,3);
+    factorization.solve(B,solution);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e2);
+    for(auto c=0; c < 3; ++c){
+        zlab::ZVector b(order), x(order);
+        for(auto i=0; i < order; ++i) b[i] = B(i,c);
+        factorization.solve(b,x);
+        for(auto i=0; i < order; ++i){
+            EXPECT_NEAR(x[i], X(i,c), tolerance);
+            EXPECT_NEAR(solution(i,c), X(i,c), tolerance);
+        }
+    }
+}
+
+TEST(Solver, FactorizationCholesky){
+    zlab::integerType order = 4;
+    zlab::ZMatrix A(order,order,1);
+    for(auto i=0; i < order; ++i) A(i,i) = 5;
+    zlab::ZVector b(order,8), x(order);
+    zlab::Factorization<zlab::ZMatrix> factorization(A, zlab::FactorizationMethod::Cholesky);
+    factorization.solve(b,x);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for(auto i=0; i < order; ++i){
+        EXPECT_NEAR(x[i], 1, tolerance);
+    }
+}
+
+TEST(Solver, LinearSolverSquareSystem){
+    zlab::ZMatrix A(3,3);
+    A(0,1) = 2; A(1,0) = 1; A(2,2) = 4;
+    zlab::ZVector b(3), x(3);
+    b[0] = 4; b[1] = 3; b[2] = 8;
+    zlab::linear_solver(A,b,x);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    EXPECT_NEAR(x[0], 3, tolerance);
+    EXPECT_NEAR(x[1], 2, tolerance);
+    EXPECT_NEAR(x[2], 2, tolerance);
+}
+
+TEST(Solver, BackwardSubstitutionMultipleRightHandSides){
+    zlab::ZMatrix A(3,3), B(3,2), X(3,2);
+    A(0,0) = 2; A(0,1) = -1; A(0,2) = 3;
+    A(1,1) = 4; A(1,2) = 1;
+    A(2,2) = 5;
+    B(0,0) = 9; B(1,0) = 11; B(2,0) = 15;
+    B(0,1) = 18; B(1,1) = 22; B(2,1) = 30;
+    zlab::backward_substitution(A,B,X);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for(auto i=0; i<3; ++i){
+        EXPECT_NEAR(X(i,0), i+1, tolerance);
+        EXPECT_NEAR(X(i,1), 2*(i+1), tolerance);
+    }
+}
+
+TEST(Solver, LinearLeastSquaresMultipleRightHandSides){
+    zlab::ZMatrix A(3,2,1), B(3,2), X(2,2);
+    A(1,1) = 2; A(2,1) = 3;
+    B(0,0) = 6; B(0,1) = -6;
+    zlab::linear_least_squares(A,B,X);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    EXPECT_NEAR(X(0,0), 8, tolerance);
+    EXPECT_NEAR(X(1,0), -3, tolerance);
+    EXPECT_NEAR(X(0,1), -8, tolerance);
+    EXPECT_NEAR(X(1,1), 3, tolerance);
+    zlab::ZMatrix Y(2,2);
+    zlab::linear_solver(A,B,Y,std::nullopt,zlab::LinearSolverMethod::NormalEquations);
+    for(auto i=0; i<2; ++i){
+        for(auto j=0; j<2; ++j) EXPECT_NEAR(Y(i,j), X(i,j), tolerance);
+    }
+}
+
+TEST(Solver, ColumnPivotingQR){
+    zlab::integerType numberOfRows = 9, numberOfColumns = 7;
+    zlab::ZMatrix A(numberOfRows, numberOfColumns);
+    for(auto i=0; i < numberOfRows; ++i){
+        for(auto j=0; j < 5; ++j) A(i,j) = test_entry(i,j);
+        A(i,5) = A(i,0) - 2 * A(i,3);
+        A(i,6) = 3 * A(i,1);
+    }
+    zlab::positiveIntegerType blockSize = 2;
+    auto [QR, tau, permutation, rank] = zlab::column_pivoting_qr(A, std::nullopt, blockSize);
+    EXPECT_EQ(rank, 5);
+    // Rebuild Q * R column by column by applying the reflectors in reverse order.
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    for(auto j=0; j < numberOfColumns; ++j){
+        zlab::ZVector column(numberOfRows);
+        for(auto i=0; i <= std::min(j, numberOfColumns - 1); ++i) column[i] = QR(i,j);
+        auto k = static_cast<zlab::integerType>(tau.size());
+        while (k > 0) {
+            --k;
+            auto sum = column[k];
+            for(auto i=k+1; i < numberOfRows; ++i) sum += QR(i,k) * column[i];
+            sum *= tau[k];
+            column[k] -= sum;
+            for(auto i=k+1; i < numberOfRows; ++i) column[i] -= sum * QR(i,k);
+        }
+        for(auto i=0; i < numberOfRows; ++i){
+            EXPECT_NEAR(column[i], A(i,permutation[j]), tolerance);
+        }
+    }
+    for(auto k=1; k < numberOfColumns; ++k){
+        EXPECT_LE(std::abs(QR(k,k)), std::abs(QR(k-1,k-1)) * (1 + tolerance));
+    }
+}
+
+TEST(Solver, RankRevealingLeastSquares){
+    zlab::ZMatrix A(4,3);
+    for(auto i=0; i < 4; ++i){
+        A(i,0) = i + 1;
+        A(i,1) = (i - 1) * (i - 1);
+        A(i,2) = A(i,0) + A(i,1);
+    }
+    zlab::ZVector ones(3,1), b(4), x(3), basic(3);
+    gemv(A,ones,b,1,0,false);
+    EXPECT_THROW(zlab::linear_least_squares(A,b,x), std::runtime_error);
+    auto rank = zlab::rank_revealing_least_squares(A,b,x);
+    EXPECT_EQ(rank, 2);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    EXPECT_NEAR(x[0], 2.0/3.0, tolerance);
+    EXPECT_NEAR(x[1], 2.0/3.0, tolerance);
+    EXPECT_NEAR(x[2], 4.0/3.0, tolerance);
+    zlab::rank_revealing_least_squares(A,b,basic,std::nullopt,zlab::RankDeficientSolution::Basic);
+    zlab::ZVector residual = b.copy();
+    gemv(A,basic,residual,1,-1,false);
+    EXPECT_NEAR(zlab::norm(residual), 0, tolerance);
+    auto numberOfZeros = 0;
+    for(auto i=0; i < 3; ++i) numberOfZeros += basic[i] == 0;
+    EXPECT_EQ(numberOfZeros, 1);
+}
+
+TEST(Solver, MixedPrecisionRefinement){
+    auto n = 40;
+    zlab::ZMatrix A(n,n);
+    zlab::ZVector xExact(n), b(n), x(n), residual(n);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < n; ++j) A(i,j) = test_entry(i,j);
+        A(i,i) += n;
+        xExact[i] = std::sin(i + 1.0);
+    }
+    gemv(A,xExact,b,1,0,false);
+    auto numberOfSteps = zlab::mixed_precision_refinement(A,b,x);
+    EXPECT_GT(numberOfSteps, 0);
+    for(auto i=0; i < n; ++i){
+        EXPECT_NEAR(x[i], xExact[i], zlab::evaluate_safe_tolerance(1e3));
+    }
+    zlab::ZVector y(n);
+    zlab::linear_solver(A,b,y,std::nullopt,zlab::LinearSolverMethod::MixedPrecisionLU);
+    for(auto i=0; i < n; ++i){
+        EXPECT_NEAR(y[i], xExact[i], zlab::evaluate_safe_tolerance(1e3));
+    }
+}
+
+TEST(Solver, MixedPrecisionFallsBackOnIllConditionedMatrix){
+    // The Hilbert matrix of order 10 has a condition number near 1e13, far
+    // beyond what a single precision factorization can refine.
+    auto n = 10;
+    zlab::ZMatrix H(n,n);
+    zlab::ZVector ones(n,1), b(n), x(n);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < n; ++j) H(i,j) = 1.0 / (i + j + 1);
+    }
+    gemv(H,ones,b,1,0,false);
+    EXPECT_THROW(zlab::mixed_precision_refinement(H,b,x), std::runtime_error);
+    zlab::linear_solver(H,b,x,std::nullopt,zlab::LinearSolverMethod::MixedPrecisionLU);
+    zlab::ZVector residual = b.copy();
+    gemv(H,x,residual,1,-1,false);
+    EXPECT_LT(zlab::norm(residual), zlab::evaluate_safe_tolerance(1e3));
+}
+
+TEST(Solver, ComplexLinearSolver){
+    using complexType = std::complex<zlab::scalarType>;
+    auto n = 12;
+    zlab::BasicZMatrix<complexType> A(n,n);
+    zlab::BasicZVector<complexType> xExact(n), b(n), x(n);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < n; ++j) A(i,j) = complexType(std::cos(1.3*i + j), std::sin(0.7*i*j));
+        A(i,i) += complexType(0, n);
+        xExact[i] = complexType(i, 1 - i);
+    }
+    gemv(A,xExact,b,1,0,false);
+    zlab::linear_solver(A,b,x);
+    for(auto i=0; i < n; ++i){
+        EXPECT_NEAR(std::abs(x[i] - xExact[i]), 0, zlab::evaluate_safe_tolerance(1e4));
+    }
+    EXPECT_THROW(zlab::linear_solver(A,b,x,std::nullopt,zlab::LinearSolverMethod::QR), std::invalid_argument);
+    zlab::linear_solver(A,b,x,std::nullopt,zlab::LinearSolverMethod::MixedPrecisionLU);
+    for(auto i=0; i < n; ++i){
+        EXPECT_NEAR(std::abs(x[i] - xExact[i]), 0, zlab::evaluate_safe_tolerance(1e4));
+    }
+}
+
+TEST(Solver, ComplexNonSquareLinearSolverThrows){
+    using complexType = std::complex<zlab::scalarType>;
+    zlab::BasicZMatrix<complexType> A(3,2), B(3,2), X(2,2);
+    zlab::BasicZVector<complexType> b(3), x(2);
+    for(auto i=0; i < 3; ++i){
+        for(auto j=0; j < 2; ++j) A(i,j) = complexType(test_entry(i,j), 1);
+        b[i] = complexType(i, 1);
+    }
+    EXPECT_THROW(zlab::linear_solver(A,b,x), std::invalid_argument);
+    EXPECT_THROW(zlab::linear_solver(A,B,X), std::invalid_argument);
+}
+
+TEST(Solver, QRLeastSquaresFactorsWithoutQ){
+    auto m = 200, n = 5;
+    zlab::ZMatrix A(m,n), B(m,2);
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j) A(i,j) = test_entry(i,j);
+        B(i,0) = std::sin(0.1*i);
+        B(i,1) = 1;
+    }
+    auto [R, QtB, residualNorms] = zlab::qr_least_squares_factors(A, B);
+    zlab::ZMatrix X(n,2);
+    zlab::backward_substitution(R, QtB, X);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e4);
+    // The factors agree with an explicit MGS Q up to the signs of the columns.
+    auto [Q, RMGS] = zlab::modified_gram_schmidt(A);
+    for(auto j=0; j < n; ++j){
+        auto sign = (R(j,j) > 0) == (RMGS(j,j) > 0) ? 1 : -1;
+        for(auto c=0; c < 2; ++c){
+            zlab::scalarType qb{0};
+            for(auto i=0; i < m; ++i) qb += Q(i,j) * B(i,c);
+            EXPECT_NEAR(QtB(j,c), sign * qb, tolerance);
+        }
+    }
+    for(auto c=0; c < 2; ++c){
+        zlab::ZVector x(n), residual(m);
+        for(auto j=0; j < n; ++j) x[j] = X(j,c);
+        for(auto i=0; i < m; ++i) residual[i] = B(i,c);
+        gemv(A, x, residual, -1, 1, false);
+        EXPECT_NEAR(residualNorms[c], zlab::norm(residual), tolerance);
+        zlab::ZVector gradient(n);
+        gemv(A, residual, gradient, 1, 0, true);
+        EXPECT_LT(zlab::norm(gradient), tolerance);
+    }
+}
+
+TEST(Solver, BlockedTriangularSolves){
+    auto n = 70;
+    zlab::ZMatrix A(n,n);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < n; ++j) A(i,j) = test_entry(i,j) / n;
+        A(i,i) = 2;
+    }
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    for(auto part : {zlab::TriangularPart::Lower, zlab::TriangularPart::Upper}){
+        for(auto isTranspose : {false, true}){
+            for(auto isUnitDiagonal : {false, true}){
+                // op(T) * expected is formed entry by entry, reading only the given triangle.
+                auto opT = [&](zlab::integerType i, zlab::integerType j) -> zlab::scalarType {
+                    auto r = isTranspose ? j : i;
+                    auto c = isTranspose ? i : j;
+                    if (r == c) return isUnitDiagonal ? 1 : A(r,c);
+                    return (part == zlab::TriangularPart::Lower) == (r > c) ? A(r,c) : 0;
+                };
+                zlab::ZVector x(n);
+                zlab::ZMatrix X(n,3);
+                for(auto i=0; i < n; ++i){
+                    for(auto j=0; j < n; ++j){
+                        x[i] += opT(i,j) * std::sin(j);
+                        for(auto c=0; c < 3; ++c) X(i,c) += opT(i,j) * (c + j);
+                    }
+                }
+                zlab::trsv(A, x, part, isTranspose, isUnitDiagonal, std::nullopt, 16);
+                zlab::trsm(A, X, part, isTranspose, isUnitDiagonal, std::nullopt, 16);
+                for(auto i=0; i < n; ++i){
+                    EXPECT_NEAR(x[i], std::sin(i), tolerance);
+                    for(auto c=0; c < 3; ++c) EXPECT_NEAR(X(i,c), c + i, tolerance);
+                }
+            }
+        }
+    }
+    A(n-5,n-5) = 0;
+    zlab::ZVector x(n);
+    EXPECT_THROW(zlab::trsv(A, x, zlab::TriangularPart::Upper), std::runtime_error);
+    EXPECT_NO_THROW(zlab::trsv(A, x, zlab::TriangularPart::Upper, false, true));
+}
+
+TEST(Solver, TriangularSolveThreadCountIndependent){
+    auto n = 90;
+    zlab::ZMatrix L(n,n), B(n,40), X1(n,40), X4(n,40);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < i; ++j) L(i,j) = test_entry(i,j) / n;
+        L(i,i) = 1 + 0.1 * i;
+        for(auto c=0; c < 40; ++c) B(i,c) = std::sin(0.3*i + c);
+    }
+    zlab::ThreadScope serialThreads(1);
+    zlab::forward_substitution(L, B, X1);
+    zlab::ThreadScope parallelThreads(4);
+    zlab::forward_substitution(L, B, X4);
+    for(auto i=0; i < n; ++i){
+        for(auto c=0; c < 40; ++c) EXPECT_EQ(X1(i,c), X4(i,c));
+    }
+}
+
+TEST(Solver, QRFactorizationSlidingWindow){
+    auto windowSize = 40, n = 5, numberOfSteps = 60;
+    zlab::ZMatrix A(windowSize, n);
+    zlab::ZVector b(windowSize);
+    for(auto i=0; i < windowSize; ++i){
+        for(auto j=0; j < n; ++j) A(i,j) = test_entry(i,j);
+        b[i] = std::sin(0.1*i);
+    }
+    zlab::QRFactorization qr(A, b);
+    zlab::ZVector row(n), x(n), expected(n), residual(windowSize);
+    for(auto step=0; step < numberOfSteps; ++step){
+        // Row step leaves the window through slot step % windowSize and row step + windowSize enters it.
+        auto slot = step % windowSize;
+        for(auto j=0; j < n; ++j) row[j] = A(slot,j);
+        qr.remove_row(row, b[slot]);
+        for(auto j=0; j < n; ++j) A(slot,j) = row[j] = test_entry(step + windowSize, j);
+        b[slot] = std::sin(0.1*(step + windowSize));
+        qr.insert_row(row, b[slot]);
+    }
+    EXPECT_EQ(qr.get_number_of_rows(), windowSize);
+    qr.solve(x);
+    zlab::linear_least_squares(A, b, expected);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e4);
+    for(auto j=0; j < n; ++j) EXPECT_NEAR(x[j], expected[j], tolerance);
+    for(auto i=0; i < windowSize; ++i) residual[i] = b[i];
+    gemv(A, x, residual, -1, 1, false);
+    EXPECT_NEAR(qr.get_residual_norm(), zlab::norm(residual), tolerance);
+}
+
+TEST(Solver, QRFactorizationColumnUpdates){
+    auto m = 30, n = 6;
+    zlab::ZMatrix A(m,n), reduced(m,n-1), extended(m,n);
+    zlab::ZVector b(m), column(m);
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j) A(i,j) = test_entry(i,j);
+        for(auto j=0; j < n-1; ++j) reduced(i,j) = extended(i,j) = A(i, j < 2 ? j : j + 1);
+        column[i] = extended(i,n-1) = std::exp(-0.1*i);
+        b[i] = std::sin(0.1*i);
+    }
+    zlab::QRFactorization qr(A, b);
+    qr.remove_column(2);
+    zlab::ZVector x(n-1), expected(n-1);
+    qr.solve(x);
+    zlab::linear_least_squares(reduced, b, expected);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e4);
+    for(auto j=0; j < n-1; ++j) EXPECT_NEAR(x[j], expected[j], tolerance);
+    qr.append_column(reduced, b, column);
+    zlab::ZVector y(n), expectedY(n);
+    qr.solve(y);
+    zlab::linear_least_squares(extended, b, expectedY);
+    for(auto j=0; j < n; ++j) EXPECT_NEAR(y[j], expectedY[j], tolerance);
+    EXPECT_THROW(qr.append_column(extended, b, column), std::runtime_error);
+}
+
+TEST(Solver, QRFactorizationRankDeficientDowndate){
+    zlab::QRFactorization<zlab::scalarType> qr(2);
+    zlab::ZVector first(2), second(2), x(2);
+    first[0] = 1; second[1] = 2;
+    qr.insert_row(first, 3);
+    qr.insert_row(second, 4);
+    qr.solve(x);
+    EXPECT_NEAR(x[0], 3, zlab::evaluate_safe_tolerance());
+    EXPECT_NEAR(x[1], 2, zlab::evaluate_safe_tolerance());
+    EXPECT_THROW(qr.remove_row(second, 4), std::runtime_error);
+    EXPECT_EQ(qr.get_number_of_rows(), 2);
+    qr.solve(x);
+    EXPECT_NEAR(x[1], 2, zlab::evaluate_safe_tolerance());
+}
+
+namespace {
+    // Noise-free samples of y(t) = 2.5 exp(-1.3 t) + 0.5.
+    struct ExponentialResidual {
+        void operator()(const zlab::ZVector& p, zlab::ZVector& f) const {
+            for(auto i=0; i < f.size(); ++i){
+                auto t = 0.1 * i;
+                f[i] = p[0] * std::exp(p[1] * t) + p[2] - (2.5 * std::exp(-1.3 * t) + 0.5);
+            }
+        }
+    };
+}
+
+TEST(Solver, LevenbergMarquardtExponentialFit){
+    auto m = 30;
+    ExponentialResidual residual;
+    auto jacobian = [](const zlab::ZVector& p, zlab::ZMatrix& J){
+        for(auto i=0; i < J.get_number_of_rows(); ++i){
+            auto t = 0.1 * i;
+            J(i,0) = std::exp(p[1] * t);
+            J(i,1) = p[0] * t * std::exp(p[1] * t);
+            J(i,2) = 1;
+        }
+    };
+    zlab::ZVector p(3), q(3);
+    p[0] = 1; p[1] = 0; p[2] = 0;
+    q = p;
+    auto result = zlab::levenberg_marquardt(residual, jacobian, m, p);
+    auto numericalResult = zlab::levenberg_marquardt(residual, zlab::FiniteDifferenceJacobian(residual), m, q);
+    EXPECT_LT(result.residualNorm, 1e-8);
+    EXPECT_LT(numericalResult.residualNorm, 1e-8);
+    EXPECT_NEAR(p[0], 2.5, 1e-6); EXPECT_NEAR(p[1], -1.3, 1e-6); EXPECT_NEAR(p[2], 0.5, 1e-6);
+    EXPECT_NEAR(q[0], 2.5, 1e-6); EXPECT_NEAR(q[1], -1.3, 1e-6); EXPECT_NEAR(q[2], 0.5, 1e-6);
+}
+
+TEST(Solver, LevenbergMarquardtRosenbrock){
+    auto residual = [](const zlab::ZVector& x, zlab::ZVector& f){
+        f[0] = 10 * (x[1] - x[0] * x[0]);
+        f[1] = 1 - x[0];
+    };
+    auto jacobian = [](const zlab::ZVector& x, zlab::ZMatrix& J){
+        J(0,0) = -20 * x[0]; J(0,1) = 10;
+        J(1,0) = -1; J(1,1) = 0;
+    };
+    zlab::ZVector x(2);
+    x[0] = -1.2; x[1] = 1;
+    auto result = zlab::levenberg_marquardt(residual, jacobian, 2, x);
+    EXPECT_NEAR(x[0], 1, 1e-6);
+    EXPECT_NEAR(x[1], 1, 1e-6);
+    EXPECT_GT(result.numberOfIterations, 0);
+    x[0] = -1.2; x[1] = 1;
+    EXPECT_THROW(zlab::levenberg_marquardt(residual, jacobian, 2, x, std::nullopt, 2), std::runtime_error);
+}
+
+TEST(Solver, DampedLSQR){
+    auto m = 40, n = 12;
+    zlab::scalarType damping = 0.3;
+    zlab::ZMatrix A(m,n), stacked(m+n,n);
+    zlab::ZVector b(m), stackedB(m+n), x(n), expected(n);
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j) stacked(i,j) = A(i,j) = test_entry(i,j);
+        stackedB[i] = b[i] = std::sin(0.2*i);
+    }
+    for(auto j=0; j < n; ++j) stacked(m+j,j) = damping;
+    auto apply = [&](const zlab::ZVector& v, zlab::ZVector& w){ zlab::gemv(A, v, w, 1, 0, false); };
+    auto applyTranspose = [&](const zlab::ZVector& u, zlab::ZVector& w){ zlab::gemv(A, u, w, 1, 0, true); };
+    auto iterations = zlab::lsqr(apply, applyTranspose, b, x, damping, std::nullopt, 10 * n);
+    EXPECT_LT(iterations, 10 * n);
+    zlab::linear_least_squares(stacked, stackedB, expected);
+    for(auto j=0; j < n; ++j) EXPECT_NEAR(x[j], expected[j], 1e-10);
+}
+
+TEST(Solver, MatrixFreeLevenbergMarquardt){
+    auto m = 30;
+    ExponentialResidual residual;
+    auto jacobianProduct = [](const zlab::ZVector& p, const zlab::ZVector& v, zlab::ZVector& w, bool isTranspose){
+        w.fill(0);
+        for(auto i=0; i < (isTranspose ? v.size() : w.size()); ++i){
+            auto t = 0.1 * i;
+            zlab::scalarType row[3] = {std::exp(p[1] * t), p[0] * t * std::exp(p[1] * t), 1};
+            for(auto j=0; j < 3; ++j){
+                if (isTranspose) w[j] += row[j] * v[i];
+                else w[i] += row[j] * v[j];
+            }
+        }
+    };
+    zlab::ZVector p(3);
+    p[0] = 1; p[1] = 0; p[2] = 0;
+    auto result = zlab::matrix_free_levenberg_marquardt(residual, jacobianProduct, m, p);
+    EXPECT_LT(result.residualNorm, 1e-8);
+    EXPECT_NEAR(p[0], 2.5, 1e-6); EXPECT_NEAR(p[1], -1.3, 1e-6); EXPECT_NEAR(p[2], 0.5, 1e-6);
+}
+
+TEST(Solver, FiniteDifferenceJacobianThreadCountIndependent){
+    auto m = 25, n = 17;
+    auto residual = [n](const zlab::ZVector& x, zlab::ZVector& f){
+        for(auto i=0; i < f.size(); ++i){
+            f[i] = 0;
+            for(auto j=0; j < n; ++j) f[i] += std::sin(test_entry(i,j) * x[j]);
+        }
+    };
+    zlab::ZVector x(n);
+    for(auto j=0; j < n; ++j) x[j] = 0.1 * j - 0.5;
+    zlab::ZMatrix J1(m,n), J4(m,n);
+    zlab::FiniteDifferenceJacobian jacobian(residual);
+    zlab::ThreadScope serialThreads(1);
+    jacobian(x, J1);
+    zlab::ThreadScope parallelThreads(4);
+    jacobian(x, J4);
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j){
+            EXPECT_EQ(J1(i,j), J4(i,j));
+            EXPECT_NEAR(J1(i,j), test_entry(i,j) * std::cos(test_entry(i,j) * x[j]), 1e-6);
+        }
+    }
+}
+
+TEST(Solver, FiniteDifferenceJacobianReusesResidual){
+    auto m = 6, n = 4;
+    // The residual records its calls without synchronization.
+    zlab::ThreadScope threads(1);
+    std::vector<zlab::ZVector> evaluatedPoints;
+    std::vector<zlab::scalarType> firstEntries;
+    auto residual = [&](const zlab::ZVector& x, zlab::ZVector& f){
+        evaluatedPoints.push_back(x.copy());
+        firstEntries.push_back(x[0]);
+        for(auto i=0; i < f.size(); ++i){
+            f[i] = 0;
+            for(auto j=0; j < n; ++j) f[i] += test_entry(i,j) * x[j] * x[j];
+        }
+    };
+    zlab::ZVector x(n), r(m);
+    for(auto j=0; j < n; ++j) x[j] = 0.3 * j + 0.2;
+    zlab::ZMatrix J1(m,n), J2(m,n);
+    zlab::FiniteDifferenceJacobian jacobian(residual);
+    jacobian(x, J1);
+    EXPECT_EQ(evaluatedPoints.size(), n + 1);
+    residual(x, r);
+    evaluatedPoints.clear();
+    firstEntries.clear();
+    jacobian(x, r, J2);
+    EXPECT_EQ(evaluatedPoints.size(), n);
+    for(auto i=0; i < m; ++i){
+        for(auto j=0; j < n; ++j) EXPECT_EQ(J1(i,j), J2(i,j));
+    }
+    // Vectors the residual kept must survive later scratch allocations.
+    zlab::ScopedWorkspace workspace;
+    zlab::ZVector scratch(1000, 42.0);
+    for(auto k=0; k < evaluatedPoints.size(); ++k) EXPECT_EQ(evaluatedPoints[k][0], firstEntries[k]);
+}
@@ -0,0 +1,155 @@
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+
+#include "core.hpp"
+#include "math.hpp"
+#include "test_utilities.hpp"
+
+using zlab::tests::test_matrix;
+
+namespace {
+    void expect_reconstruction(const zlab::ZMatrix& A, const zlab::ZMatrix& U, const zlab::ZVector& S, const zlab::ZMatrix& V, zlab::scalarType tolerance){
+        for(auto i=0; i < A.get_number_of_rows(); ++i){
+            for(auto j=0; j < A.get_number_of_columns(); ++j){
+                zlab::scalarType value{0};
+                for(auto k=0; k < S.size(); ++k) value += U(i,k) * S[k] * V(j,k);
+                EXPECT_NEAR(value, A(i,j), tolerance);
+            }
+        }
+    }
+}
+
+TEST(SVD, TallMatrix){
+    auto A = test_matrix(8,5);
+    auto [U, S, V] = zlab::singular_value_decomposition(A);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e3);
+    expect_reconstruction(A, U, S, V, tolerance);
+    for(auto k=0; k < S.size(); ++k){
+        if (k > 0) { EXPECT_GE(S[k-1], S[k]); }
+        for(auto l=0; l < S.size(); ++l){
+            zlab::scalarType uu{0}, vv{0};
+            for(auto i=0; i < 8; ++i) uu += U(i,k) * U(i,l);
+            for(auto i=0; i < 5; ++i) vv += V(i,k) * V(i,l);
+            EXPECT_NEAR(uu, k == l, tolerance);
+            EXPECT_NEAR(vv, k == l, tolerance);
+        }
+    }
+}
+
+TEST(SVD, WideMatrixKnownSingularValues){
+    zlab::ZMatrix A(2,3);
+    A(0,0) = 3; A(0,1) = 2; A(0,2) = 2;
+    A(1,0) = 2; A(1,1) = 3; A(1,2) = -2;
+    auto [U, S, V] = zlab::singular_value_decomposition(A);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e2);
+    ASSERT_EQ(S.size(), 2);
+    EXPECT_NEAR(S[0], 5, tolerance);
+    EXPECT_NEAR(S[1], 3, tolerance);
+    expect_reconstruction(A, U, S, V, tolerance);
+}
+
+TEST(SVD, RandomizedLowRank){
+    auto left = test_matrix(60,4), right = test_matrix(4,40);
+    zlab::ZMatrix A(60,40);
+    gemm(left,right,A,1,0);
+    auto exact = zlab::singular_value_decomposition(A);
+    auto [U, S, V] = zlab::randomized_svd(A, 4);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e4);
+    for(auto k=0; k < 4; ++k){
+        EXPECT_NEAR(S[k], exact.S[k], tolerance * exact.S[0]);
+    }
+    expect_reconstruction(A, U, S, V, tolerance * exact.S[0]);
+}
+
+namespace {
+    // Solves min ||A x - b||^2 + lambda^2 ||L x||^2 through the stacked least-squares problem.
+    zlab::ZVector stacked_tikhonov_solution(const zlab::ZMatrix& A, const zlab::ZMatrix& L, const zlab::ZVector& b, zlab::scalarType lambda){
+        auto m = A.get_number_of_rows(), n = A.get_number_of_columns(), p = L.get_number_of_rows();
+        zlab::ZMatrix stacked(m + p, n);
+        zlab::ZVector rhs(m + p), x(n);
+        for(auto i=0; i < m; ++i){
+            for(auto j=0; j < n; ++j) stacked(i,j) = A(i,j);
+            rhs[i] = b[i];
+        }
+        for(auto i=0; i < p; ++i){
+            for(auto j=0; j < n; ++j) stacked(m + i, j) = lambda * L(i,j);
+        }
+        zlab::linear_least_squares(stacked, rhs, x);
+        return x;
+    }
+}
+
+TEST(Regularization, RidgePathMatchesStackedLeastSquares){
+    auto m = 30, n = 12;
+    auto A = test_matrix(m,n);
+    zlab::ZVector b(m), lambdas(4), residual(m), x(n);
+    for(auto i=0; i < m; ++i) b[i] = std::sin(0.2*i);
+    lambdas[0] = 1e-3; lambdas[1] = 0.1; lambdas[2] = 1; lambdas[3] = 10;
+    auto path = zlab::ridge_regression(A, b, lambdas);
+    auto identity = zlab::identity_matrix(n);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e4);
+    for(auto l=0; l < lambdas.size(); ++l){
+        auto expected = stacked_tikhonov_solution(A, identity, b, lambdas[l]);
+        for(auto j=0; j < n; ++j){
+            x[j] = path.X(j,l);
+            EXPECT_NEAR(x[j], expected[j], tolerance);
+        }
+        for(auto i=0; i < m; ++i) residual[i] = b[i];
+        gemv(A, x, residual, -1, 1, false);
+        EXPECT_NEAR(path.residualNorms[l], zlab::norm(residual), tolerance);
+        EXPECT_NEAR(path.regularizationNorms[l], zlab::norm(x), tolerance);
+        EXPECT_GE(path.gcv[l], path.gcv[path.gcvIndex]);
+    }
+}
+
+TEST(Regularization, GeneralOperatorPathAndGCV){
+    auto m = 25, n = 10;
+    auto A = test_matrix(m,n);
+    // First differences: L has the constant vector in its null space.
+    zlab::ZMatrix L(n-1,n);
+    for(auto i=0; i < n-1; ++i){
+        L(i,i) = -1;
+        L(i,i+1) = 1;
+    }
+    zlab::ZVector b(m), lambdas(3), x(n), Lx(n-1);
+    for(auto i=0; i < m; ++i) b[i] = std::sin(0.2*i) + 0.5;
+    lambdas[0] = 0.05; lambdas[1] = 0.5; lambdas[2] = 5;
+    auto path = zlab::tikhonov_regression(A, L, b, lambdas);
+    auto tolerance = zlab::evaluate_safe_tolerance(1e5);
+    for(auto l=0; l < lambdas.size(); ++l){
+        auto expected = stacked_tikhonov_solution(A, L, b, lambdas[l]);
+        for(auto j=0; j < n; ++j){
+            x[j] = path.X(j,l);
+            EXPECT_NEAR(x[j], expected[j], tolerance);
+        }
+        gemv(L, x, Lx, 1, 0, false);
+        EXPECT_NEAR(path.regularizationNorms[l], zlab::norm(Lx), tolerance);
+
+        // GCV against the explicit influence matrix A (A^T A + lambda^2 L^T L)^-1 A^T.
+        zlab::ZMatrix normal(n,n), AT(n,m), solved(n,m);
+        gemm(A, A, normal, 1, 0, true);
+        gemm(L, L, normal, lambdas[l] * lambdas[l], 1, true);
+        for(auto i=0; i < m; ++i){
+            for(auto j=0; j < n; ++j) AT(j,i) = A(i,j);
+        }
+        zlab::Factorization factorization(normal, zlab::FactorizationMethod::Cholesky);
+        factorization.solve(AT, solved);
+        zlab::scalarType trace{0};
+        for(auto i=0; i < m; ++i){
+            for(auto j=0; j < n; ++j) trace += A(i,j) * solved(j,i);
+        }
+        auto residualNorm = path.residualNorms[l];
+        EXPECT_NEAR(path.gcv[l], residualNorm * residualNorm / ((m - trace) * (m - trace)), tolerance);
+    }
+    // A tall operator [L; I] is reduced to its triangular factor first.
+    zlab::ZMatrix tallL(2*n-1,n);
+    for(auto i=0; i < n-1; ++i){
+        for(auto j=0; j < n; ++j) tallL(i,j) = L(i,j);
+    }
+    for(auto j=0; j < n; ++j) tallL(n-1+j,j) = 1;
+    auto tallPath = zlab::tikhonov_regression(A, tallL, b, lambdas);
+    auto expected = stacked_tikhonov_solution(A, tallL, b, lambdas[1]);
+    for(auto j=0; j < n; ++j) EXPECT_NEAR(tallPath.X(j,1), expected[j], tolerance);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cmath>
+
+#include "core.hpp"
+#include "math.hpp"
+
+namespace zlab::tests{
+
+// TEST ENTRY
+// This function returns a deterministic entry without structure, so that the
+// matrices built from it are dense and generically full rank.
+inline scalarType test_entry(integerType i, integerType j){
+    return std::cos(0.37*i*i + 1.3*i*j + j);
+}
+
+// TEST MATRIX
+// This function returns the numberOfRows x numberOfColumns matrix of test entries.
+inline ZMatrix test_matrix(integerType numberOfRows, integerType numberOfColumns){
+    ZMatrix A(numberOfRows, numberOfColumns);
+    for(auto i=0; i < numberOfRows; ++i){
+        for(auto j=0; j < numberOfColumns; ++j) A(i,j) = test_entry(i,j);
+    }
+    return A;
+}
+
+// SYMMETRIC TEST MATRIX
+// This function returns the n x n symmetric matrix whose lower triangle holds the
+// test entries.
+inline ZMatrix symmetric_test_matrix(integerType n){
+    ZMatrix A(n, n);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j <= i; ++j) A(i,j) = A(j,i) = test_entry(i,j);
+    }
+    return A;
+}
+
+} // end namespace zlab::tests
@@ -1,11 +1,19 @@
 
 #include <type_traits>
+#include <cstdint>
 #include <limits>
+#include <vector>
 #include <cmath>
 
 #include "gtest/gtest.h"
 
 #include "matrix.hpp"
+#include "solvers.hpp"
+#include "matrix_decomposition.hpp"
+#include "test_utilities.hpp"
+
+using zlab::tests::test_entry;
+using zlab::tests::test_matrix;
 
 namespace {
     using zmat = zlab::ZMatrix;
@@ -150,6 +158,36 @@ TEST(ZVector, Linf_norm){
     EXPECT_NEAR(actualNorm, expectedNorm, tolerance); 
 }
 
+TEST(ZVector, L2_norm_without_overflow_or_underflow){
+    zlab::ZVector large(3), small(3);
+    for(auto i=0; i < 3; ++i){
+        large[i] = (i + 1) * 1e200;
+        small[i] = (i + 1) * 1e-200;
+    }
+    auto expected = std::sqrt(14.0);
+    EXPECT_NEAR(zlab::norm(large) / 1e200, expected, zlab::evaluate_safe_tolerance());
+    EXPECT_NEAR(zlab::norm2(small) / 1e-200, expected, zlab::evaluate_safe_tolerance());
+    zlab::ZVector zeros(3, 0);
+    EXPECT_EQ(zlab::norm2(zeros), 0);
+}
+
+TEST(ZVector, integer_and_fractional_norm_orders){
+    zlab::integerType size = 100;
+    zlab::ZVector v(size);
+    for(auto i=0; i < size; ++i) v[i] = std::sin(0.3 * i) - 0.2;
+    for(auto p : {3.0, 5.0, 2.5}){
+        zlab::scalarType sumOfPowers{0};
+        for(auto i=0; i < size; ++i) sumOfPowers += std::pow(std::abs(v[i]), p);
+        EXPECT_NEAR(zlab::norm(v, p), std::pow(sumOfPowers, 1 / p), zlab::evaluate_safe_tolerance());
+    }
+    zlab::BasicZVector<std::complex<zlab::scalarType>> c(2);
+    c[0] = {3, 4};
+    c[1] = {0, 12};
+    EXPECT_NEAR(zlab::norm2(c), 13, zlab::evaluate_safe_tolerance());
+    EXPECT_NEAR(zlab::norm1(c), 17, zlab::evaluate_safe_tolerance());
+    EXPECT_NEAR(zlab::norm_infinity(c), 12, zlab::evaluate_safe_tolerance());
+}
+
 TEST(ZMatrix, deepCopy){
     zlab::ZMatrix matrix(3,3,2.5);
     auto newMatrix = matrix.copy();
@@ -271,3 +309,177 @@ TEST(ZVector, axpby){
         EXPECT_NEAR(y[i], expectedValue, tolerance); 
     }
 }
+
+TEST(ZMatrix, gemmTranspose){
+    zlab::ZMatrix A(4,3), B(2,4), C(3,2);
+    for (auto i=0; i<A.get_number_of_rows(); ++i){
+        for (auto j=0; j<A.get_number_of_columns(); ++j){
+            A(i,j) = i + 2*j;
+            B(j % 2, i) = i - j;
+        }
+    }
+    zlab::gemm(A,B,C,1,0,true,true);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for (auto i=0; i < C.get_number_of_rows(); i++){
+        for (auto k=0; k < C.get_number_of_columns(); k++){
+            zlab::scalarType expectedValue{0};
+            for (auto j=0; j < A.get_number_of_rows(); j++) expectedValue += A(j,i) * B(k,j);
+            EXPECT_NEAR(C(i,k), expectedValue, tolerance); 
+        }
+    }
+}
+
+TEST(ZMatrix, gramMatrixFromRowChunks){
+    zlab::ZMatrix A(5,3);
+    for (auto i=0; i<A.get_number_of_rows(); ++i){
+        for (auto j=0; j<A.get_number_of_columns(); ++j){
+            A(i,j) = (i+1) * (j+2) % 7;
+        }
+    }
+    auto G = zlab::gram_matrix(A);
+    zlab::ZMatrix accumulated(3,3);
+    auto firstChunk = A.block_view(0,0,2,3);
+    auto secondChunk = A.block_view(2,0,3,3);
+    zlab::syrk(firstChunk, accumulated, 1, 0, true);
+    zlab::syrk(secondChunk, accumulated, 1, 1, true);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for (auto i=0; i < 3; i++){
+        for (auto k=0; k < 3; k++){
+            zlab::scalarType expectedValue{0};
+            for (auto j=0; j < A.get_number_of_rows(); j++) expectedValue += A(j,i) * A(j,k);
+            EXPECT_NEAR(G(i,k), expectedValue, tolerance);
+            if (k <= i) { EXPECT_NEAR(accumulated(i,k), expectedValue, tolerance); }
+        }
+    }
+}
+
+TEST(ZMatrix, AlignedStorage){
+    zmat A(3,5);
+    auto address = reinterpret_cast<std::uintptr_t>(A.row_view(0).data());
+    EXPECT_EQ(address % zlab::memoryAlignment, 0);
+    EXPECT_EQ(A.get_memory_resource(), zlab::aligned_memory_resource());
+}
+
+TEST(ZMatrix, ScopedWorkspaceRecyclesMemory){
+    zmat result(4,4);
+    std::size_t capacityAfterFirstPass{0};
+    for(auto pass=0; pass < 3; ++pass){
+        zlab::ScopedWorkspace workspace;
+        zmat scratch(4,4,1), other(50,50);
+        EXPECT_EQ(scratch.get_memory_resource(), &zlab::workspace_arena());
+        auto address = reinterpret_cast<std::uintptr_t>(other.row_view(0).data());
+        EXPECT_EQ(address % zlab::memoryAlignment, 0);
+        {
+            zlab::ScopedWorkspace nested;
+            zmat inner(100,100);
+        }
+        // Move assignment copies into the resource of the destination.
+        result = std::move(scratch);
+        if (pass == 0) capacityAfterFirstPass = zlab::workspace_arena().get_capacity();
+        EXPECT_EQ(zlab::workspace_arena().get_capacity(), capacityAfterFirstPass);
+    }
+    EXPECT_EQ(result.get_memory_resource(), zlab::aligned_memory_resource());
+    EXPECT_EQ(zlab::get_matrix_memory_resource(), zlab::aligned_memory_resource());
+    EXPECT_EQ(result(3,3), 1);
+}
+
+TEST(ZMatrix, LinearLeastSquaresInsideWorkspace){
+    auto A = test_matrix(6,3);
+    zlab::ZVector b(6,1), x(3), xWorkspace(3);
+    zlab::linear_least_squares(A,b,x);
+    {
+        zlab::ScopedWorkspace workspace;
+        zlab::linear_least_squares(A,b,xWorkspace);
+    }
+    for(auto i=0; i < 3; ++i){
+        EXPECT_EQ(x[i], xWorkspace[i]);
+    }
+}
+
+TEST(ZMatrixView, ExternalColumnMajorBuffer){
+    // A 4 x 3 matrix stored column by column, as NumPy does with order='F'.
+    std::vector<zlab::scalarType> buffer(12);
+    auto A = test_matrix(4,3);
+    for(auto i=0; i < 4; ++i){
+        for(auto j=0; j < 3; ++j) buffer[j * 4 + i] = A(i,j);
+    }
+    zlab::ConstZMatrixView view(buffer.data(), 4, 3, 1, 4);
+    EXPECT_TRUE(zlab::MatrixConcept<zlab::ConstZMatrixView>);
+    EXPECT_TRUE(zlab::VectorConcept<zlab::ZVectorView>);
+    zmat G(3,3), GView(3,3);
+    zlab::gemm(A, A, G, 1, 0, true);
+    zlab::gemm(view.transpose(), view, GView, 1, 0);
+    zlab::ZVector b(4,1), x(3);
+    std::vector<zlab::scalarType> xBuffer(3);
+    zlab::ZVectorView xView(xBuffer.data(), 3);
+    zlab::linear_least_squares(A, b, x);
+    zlab::linear_least_squares(view, b, xView);
+    auto tolerance = zlab::evaluate_safe_tolerance();
+    for(auto i=0; i < 3; ++i){
+        EXPECT_NEAR(xView[i], x[i], tolerance);
+        for(auto j=0; j < 3; ++j) EXPECT_NEAR(GView(i,j), G(i,j), tolerance);
+    }
+}
+
+TEST(ZMatrixView, BlocksRowsAndColumns){
+    zmat A(4,5);
+    for(auto i=0; i < 4; ++i){
+        for(auto j=0; j < 5; ++j) A(i,j) = 10 * i + j;
+    }
+    auto block = A.block_view(1,2,3,2);
+    auto inner = block.block_view(1,1,2,1);
+    EXPECT_EQ(block(0,0), 12);
+    EXPECT_EQ(inner(1,0), 33);
+    inner(0,0) = -1;
+    EXPECT_EQ(A(2,3), -1);
+    zlab::ConstZMatrixView readOnly = block;
+    EXPECT_EQ(readOnly(1,1), -1);
+    // Columns of a wide matrix beyond the number of rows.
+    auto lastColumn = A.column_view(4);
+    auto row = A.view().row_view(3);
+    EXPECT_EQ(lastColumn.size(), 4);
+    EXPECT_EQ(lastColumn[3], 34);
+    EXPECT_EQ(zlab::dot(row, row), 30*30 + 31*31 + 32*32 + 33*33 + 34*34);
+    zlab::ZVector column(4);
+    column = A.column_view(4);
+    EXPECT_EQ(column[2], 24);
+}
+
+TEST(ZMatrixView, InPlaceFactorizationOfBlock){
+    zmat A(6,6);
+    for(auto i=0; i < 6; ++i){
+        for(auto j=0; j < 6; ++j) A(i,j) = test_entry(i,j) + (i == j ? 3 : 0);
+    }
+    auto leading = A.block_view(1,1,4,4);
+    auto expected = zlab::partial_pivoting_lu(leading);
+    auto pivots = zlab::partial_pivoting_lu_in_place(leading);
+    EXPECT_EQ(pivots, expected.pivots);
+    for(auto i=0; i < 4; ++i){
+        for(auto j=0; j < 4; ++j) EXPECT_EQ(A(i+1,j+1), expected.LU(i,j));
+    }
+}
+
+TEST(ZMatrix, SinglePrecisionStorage){
+    auto n = 16;
+    zlab::BasicZMatrix<float> A(n,n), B(n,n), C(n,n);
+    for(auto i=0; i < n; ++i){
+        for(auto j=0; j < n; ++j){
+            A(i,j) = std::cos(0.3f*i + j);
+            B(i,j) = std::sin(0.5f*i - j);
+        }
+    }
+    EXPECT_EQ(sizeof(A(0,0)), sizeof(float));
+    gemm(A,B,C,1,0);
+    auto tolerance = zlab::evaluate_safe_tolerance<float>(1e2);
+    for(auto i=0; i < n; ++i){
+        for(auto k=0; k < n; ++k){
+            zlab::scalarType sum{0};
+            for(auto j=0; j < n; ++j) sum += zlab::scalarType{A(i,j)} * B(j,k);
+            EXPECT_NEAR(C(i,k), sum, tolerance * n);
+        }
+    }
+    auto G = zlab::gram_matrix(A);
+    for(auto i=0; i < n; ++i) G(i,i) += n;
+    auto [L] = zlab::cholesky(G);
+    EXPECT_EQ(sizeof(L(0,0)), sizeof(float));
+}